@@ -29,6 +29,15 @@
 %   to the diagonal elements of H to avoid failures on semidefinite problems,
 %   by default regularization factor is equal to 1e-12.
 %
+% Persistent solver instances, which avoid repeated factorization of the
+% Hessian and use warm start, are available through qpmad_interface:
+%
+%   handle = qpmad_interface('create', H, lb, ub, Ain, lbin, ubin, regularization_factor)
+%   [x, info] = qpmad_interface('solve', handle, g, lb, ub, lbin, ubin)
+%   qpmad_interface('destroy', handle)
+%
+%   Empty vectors passed to 'solve' are not changed since the previous call.
+%
 % Output:
 %
 %   x -- the solution
@@ -173,9 +182,16 @@ function [x, info] = qpmad(varargin)
 
 
 % Solve
-    Ain_tmp = [eye(numel(lb)); A; Ain];
-    lbin_tmp = [lb; b; lbin];
-    ubin_tmp = [ub; b; ubin];
+    if (~isempty(Ain))
+        if (isempty(lbin))
+            lbin = -Inf(size(Ain, 1), 1);
+        end
+        if (isempty(ubin))
+            ubin = Inf(size(Ain, 1), 1);
+        end
+    end
 
-    [x, info] = qpmad_interface(H + eye(size(H))*regularization_factor, g, Ain_tmp, lbin_tmp, ubin_tmp);
+    % simple bounds are passed directly, regularization is performed in the
+    % interface on a copy of the Hessian
+    [x, info] = qpmad_interface(H, g, lb, ub, [A; Ain], [b; lbin], [b; ubin], regularization_factor);
 end
@@ -6,6 +6,26 @@
     Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
 
     @brief
+
+    Usage:
+        [x, info] = qpmad_interface(H, g, lb, ub, A, Alb, Aub, regularization_factor)
+            solve a single problem;
+
+        handle = qpmad_interface('create', H, lb, ub, A, Alb, Aub, regularization_factor)
+            create a persistent solver instance, H is regularized and
+            factorized only once;
+
+        [x, info] = qpmad_interface('solve', handle, g, lb, ub, Alb, Aub)
+            solve a problem using a persistent solver instance, empty
+            vectors are not updated, i.e., only the vectors which changed
+            since the previous call must be passed. The active set of the
+            previous call is used for warm start;
+
+        qpmad_interface('destroy', handle)
+            destroy a persistent solver instance.
+
+    Any of the bounds can be empty, in which case they are assumed to be
+    infinite.
 */
 
 
@@ -13,6 +33,8 @@
 #include <fstream>
 #include <math.h>
 #include <limits>
+#include <set>
+#include <cstring>
 
 #include "solver.h"
 #include "mex.h"
@@ -28,73 +50,351 @@ enum qpStatus
 
 
 
-void mexFunction( int num_output, mxArray *output[], int num_input, const mxArray *input[] )
+class SolverHandle
 {
-    const mxArray *H = input[0];
-    const mxArray *g = input[1];
-    const mxArray *A = input[2];
-    const mxArray *Alb = input[3];
-    const mxArray *Aub = input[4];
+    public:
+        qpmad::Solver               solver_;
+        qpmad::SolverParameters     parameters_;
 
+        Eigen::MatrixXd             H_;
+        Eigen::VectorXd             h_;
+        Eigen::VectorXd             lb_;
+        Eigen::VectorXd             ub_;
+        qpmad::QPRowMajorMatrix     A_;
+        Eigen::VectorXd             Alb_;
+        Eigen::VectorXd             Aub_;
 
-    mxArray *x = NULL;
 
+    public:
+        SolverHandle()
+        {
+            parameters_.hessian_type_ = qpmad::SolverParameters::HESSIAN_CHOLESKY_FACTOR;
+            parameters_.warm_start_ = true;
+        }
+};
 
-    int num_var = mxGetM(H);
-    int num_ctr = mxGetM(A);
-    x = mxCreateDoubleMatrix(num_var, 1, mxREAL);
 
+static std::set<SolverHandle *>     g_solver_handles;
 
-    Eigen::MatrixXd eH     = Eigen::Map<Eigen::MatrixXd>  ((double*) mxGetPr(H),   num_var, num_var);
-    Eigen::VectorXd eg     = Eigen::Map<Eigen::VectorXd>  ((double*) mxGetPr(g),   num_var);
-    Eigen::MatrixXd eA     = Eigen::Map<Eigen::MatrixXd>  ((double*) mxGetPr(A),   num_ctr, num_var);
-    Eigen::VectorXd eAlb   = Eigen::Map<Eigen::VectorXd>  ((double*) mxGetPr(Alb), num_ctr);
-    Eigen::VectorXd eAub   = Eigen::Map<Eigen::VectorXd>  ((double*) mxGetPr(Aub), num_ctr);
-    Eigen::VectorXd ex     = Eigen::Map<Eigen::VectorXd>  ((double*) mxGetPr(x),   num_var);
 
-// solve the problem
-    qpmad::Solver   solver;
-    qpStatus                qp_status;
+static void destroyAllHandles()
+{
+    for (std::set<SolverHandle *>::iterator it = g_solver_handles.begin(); it != g_solver_handles.end(); ++it)
+    {
+        delete *it;
+    }
+    g_solver_handles.clear();
+}
+
+
+static SolverHandle * getHandle(const mxArray *handle)
+{
+    if ((NULL == handle) || (false == mxIsUint64(handle)) || (1 != mxGetNumberOfElements(handle)))
+    {
+        mexErrMsgTxt("qpmad: invalid solver handle.");
+    }
+
+    SolverHandle *solver_handle = reinterpret_cast<SolverHandle *>(
+            static_cast<std::size_t>(reinterpret_cast<UINT64_T *>(mxGetData(handle))[0]));
+
+    if (g_solver_handles.end() == g_solver_handles.find(solver_handle))
+    {
+        mexErrMsgTxt("qpmad: unknown or destroyed solver handle.");
+    }
+
+    return (solver_handle);
+}
+
+
+/**
+ * @brief Copy a vector, empty input is replaced with a vector of the given
+ * value if 'keep_if_empty' is false, otherwise the vector is not changed.
+ */
+static void copyVector( Eigen::VectorXd     & vector,
+                        const mxArray       * input,
+                        const std::size_t   size,
+                        const double        default_value,
+                        const bool          keep_if_empty)
+{
+    if ((NULL == input) || mxIsEmpty(input))
+    {
+        if (false == keep_if_empty)
+        {
+            vector.setConstant(size, default_value);
+        }
+    }
+    else
+    {
+        if (size != mxGetNumberOfElements(input))
+        {
+            mexErrMsgTxt("qpmad: wrong size of a vector.");
+        }
+        vector = Eigen::Map<const Eigen::VectorXd>(mxGetPr(input), size);
+    }
+}
+
+
+static const mxArray * getInput(const int num_input, const mxArray *input[], const int index)
+{
+    if (index < num_input)
+    {
+        return (input[index]);
+    }
+    else
+    {
+        return (NULL);
+    }
+}
+
+
+static void setOutput(  int             num_output,
+                        mxArray         *output[],
+                        mxArray         *x,
+                        const qpStatus  qp_status)
+{
+    // solution
+    output[0] = x;
+
+
+    // info
+    if (num_output > 1)
+    {
+        int num_info_fields = 1;
+        const char *info_field_names[] = {
+            "status"
+        };
+
+        output[1] = mxCreateStructMatrix(1, 1, num_info_fields, info_field_names);
+
+        mxArray *info_status = mxCreateNumericMatrix(1, 1, mxINT32_CLASS, mxREAL);
+        ((INT32_T *) mxGetData (info_status))[0] = static_cast <int> (qp_status);
+        mxSetField (output[1], 0, "status", info_status);
+    }
+}
+
+
+template<class t_H, class t_h, class t_A>
+static qpStatus solve(  qpmad::Solver                   & solver,
+                        Eigen::Map<Eigen::VectorXd>     & x,
+                        t_H                             & H,
+                        const t_h                       & h,
+                        const Eigen::VectorXd           & lb,
+                        const Eigen::VectorXd           & ub,
+                        const t_A                       & A,
+                        const Eigen::VectorXd           & Alb,
+                        const Eigen::VectorXd           & Aub,
+                        const qpmad::SolverParameters   & parameters)
+{
+    qpStatus    qp_status;
 
     try
     {
-        qpmad::Solver::ReturnStatus return_value = solver.solve(ex, eH, eg, eA, eAlb, eAub);
+        qpmad::Solver::ReturnStatus return_value = solver.solve(x, H, h, lb, ub, A, Alb, Aub, parameters);
         if (return_value == qpmad::Solver::OK)
         {
             qp_status = QP_OK;
-            for(std::size_t i = 0; i < num_var; ++i)
-            {
-                ((double*) mxGetPr(x))[i] = ex[i];
-            }
         }
         else
         {
             qp_status = QP_INFEASIBLE;
+            x.setZero();
         }
     }
     catch(std::exception &e)
     {
         std::cout << e.what() << std::endl;
         qp_status = QP_FAILURE;
+        x.setZero();
     }
 
+    return (qp_status);
+}
 
-// process results
-    // solution
-    output[0] = mxDuplicateArray(x);
 
+static void solveOnce(int num_output, mxArray *output[], int num_input, const mxArray *input[])
+{
+    if (num_input < 7)
+    {
+        mexErrMsgTxt("qpmad: wrong number of input parameters.");
+    }
 
-    // info
-    int num_info_fields = 1;
-    const char *info_field_names[] = {
-        "status"
-    };
+    const mxArray *H = input[0];
+    const mxArray *g = input[1];
+    const mxArray *A = input[4];
+
+    const std::size_t num_var = mxGetM(H);
+    const std::size_t num_ctr = mxGetM(A);
 
-    output[1] = mxCreateStructMatrix(1, 1, num_info_fields, info_field_names);
+    mxArray *x = mxCreateDoubleMatrix(num_var, 1, mxREAL);
 
-    mxArray *info_status = mxCreateNumericMatrix(1, 1, mxINT32_CLASS, mxREAL);
-    ((INT32_T *) mxGetData (info_status))[0] = static_cast <int> (qp_status);
-    mxSetField (output[1], 0, "status", info_status);
+
+    // H is overwritten with its Cholesky factor and must be copied, all
+    // other inputs are used in place, missing bounds are filled in.
+    Eigen::MatrixXd                     eH     = Eigen::Map<const Eigen::MatrixXd>  (mxGetPr(H),   num_var, num_var);
+    Eigen::Map<const Eigen::VectorXd>   eg     (mxGetPr(g),   mxGetNumberOfElements(g));
+    Eigen::Map<const Eigen::MatrixXd>   eA     (mxGetPr(A),   num_ctr, (0 == num_ctr) ? 0 : num_var);
+    Eigen::Map<Eigen::VectorXd>         ex     (mxGetPr(x),   num_var);
+
+    Eigen::VectorXd elb, eub, eAlb, eAub;
+    copyVector(elb,  input[2], num_var, -std::numeric_limits<double>::infinity(), false);
+    copyVector(eub,  input[3], num_var,  std::numeric_limits<double>::infinity(), false);
+    copyVector(eAlb, input[5], num_ctr, -std::numeric_limits<double>::infinity(), false);
+    copyVector(eAub, input[6], num_ctr,  std::numeric_limits<double>::infinity(), false);
+
+    const mxArray *regularization_factor = getInput(num_input, input, 7);
+    if ((NULL != regularization_factor) && (false == mxIsEmpty(regularization_factor)))
+    {
+        eH.diagonal().array() += mxGetScalar(regularization_factor);
+    }
+
+
+    qpmad::Solver   solver;
+    qpStatus        qp_status = solve(solver, ex, eH, eg, elb, eub, eA, eAlb, eAub, qpmad::SolverParameters());
+
+    setOutput(num_output, output, x, qp_status);
+}
+
+
+static void createHandle(int num_output, mxArray *output[], int num_input, const mxArray *input[])
+{
+    if ((num_input < 7) || (num_output != 1))
+    {
+        mexErrMsgTxt("qpmad: wrong number of parameters, expected: handle = qpmad_interface('create', H, lb, ub, A, Alb, Aub [, regularization_factor]).");
+    }
+
+    const mxArray *H = input[1];
+    const mxArray *A = input[4];
+
+    const std::size_t num_var = mxGetM(H);
+    const std::size_t num_ctr = mxGetM(A);
+
+    if ((0 == num_var) || (num_var != mxGetN(H)))
+    {
+        mexErrMsgTxt("qpmad: Hessian must be a nonempty square matrix.");
+    }
+    if ((num_ctr > 0) && (num_var != mxGetN(A)))
+    {
+        mexErrMsgTxt("qpmad: wrong size of the constraint matrix.");
+    }
+
+
+    SolverHandle *solver_handle = new SolverHandle;
+
+    solver_handle->H_ = Eigen::Map<const Eigen::MatrixXd>(mxGetPr(H), num_var, num_var);
+    const mxArray *regularization_factor = getInput(num_input, input, 7);
+    if ((NULL != regularization_factor) && (false == mxIsEmpty(regularization_factor)))
+    {
+        solver_handle->H_.diagonal().array() += mxGetScalar(regularization_factor);
+    }
+    qpmad::CholeskyFactorization::compute(solver_handle->H_);
+
+    solver_handle->h_.setZero(num_var);
+
+    copyVector(solver_handle->lb_,  input[2], num_var, -std::numeric_limits<double>::infinity(), false);
+    copyVector(solver_handle->ub_,  input[3], num_var,  std::numeric_limits<double>::infinity(), false);
+
+    if (num_ctr > 0)
+    {
+        solver_handle->A_ = Eigen::Map<const Eigen::MatrixXd>(mxGetPr(A), num_ctr, num_var);
+    }
+    copyVector(solver_handle->Alb_, input[5], num_ctr, -std::numeric_limits<double>::infinity(), false);
+    copyVector(solver_handle->Aub_, input[6], num_ctr,  std::numeric_limits<double>::infinity(), false);
+
+
+    if (g_solver_handles.empty())
+    {
+        mexAtExit(destroyAllHandles);
+    }
+    g_solver_handles.insert(solver_handle);
+
+    output[0] = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+    reinterpret_cast<UINT64_T *>(mxGetData(output[0]))[0] =
+        static_cast<UINT64_T>(reinterpret_cast<std::size_t>(solver_handle));
+}
+
+
+static void solveWithHandle(int num_output, mxArray *output[], int num_input, const mxArray *input[])
+{
+    if ((num_input < 2) || (num_input > 7))
+    {
+        mexErrMsgTxt("qpmad: wrong number of parameters, expected: [x, info] = qpmad_interface('solve', handle [, g, lb, ub, Alb, Aub]).");
+    }
+
+    SolverHandle *solver_handle = getHandle(input[1]);
+
+    const std::size_t num_var = solver_handle->H_.rows();
+    const std::size_t num_ctr = solver_handle->A_.rows();
+
+    copyVector(solver_handle->h_,   getInput(num_input, input, 2), num_var, 0.0, true);
+    copyVector(solver_handle->lb_,  getInput(num_input, input, 3), num_var, 0.0, true);
+    copyVector(solver_handle->ub_,  getInput(num_input, input, 4), num_var, 0.0, true);
+    copyVector(solver_handle->Alb_, getInput(num_input, input, 5), num_ctr, 0.0, true);
+    copyVector(solver_handle->Aub_, getInput(num_input, input, 6), num_ctr, 0.0, true);
+
+
+    mxArray *x = mxCreateDoubleMatrix(num_var, 1, mxREAL);
+    Eigen::Map<Eigen::VectorXd>     ex(mxGetPr(x), num_var);
+
+    qpStatus qp_status = solve( solver_handle->solver_,
+                                ex,
+                                solver_handle->H_,
+                                solver_handle->h_,
+                                solver_handle->lb_,
+                                solver_handle->ub_,
+                                solver_handle->A_,
+                                solver_handle->Alb_,
+                                solver_handle->Aub_,
+                                solver_handle->parameters_);
+
+    setOutput(num_output, output, x, qp_status);
+}
+
+
+static void destroyHandle(int num_output, mxArray *[], int num_input, const mxArray *input[])
+{
+    if ((num_input != 2) || (num_output != 0))
+    {
+        mexErrMsgTxt("qpmad: wrong number of parameters, expected: qpmad_interface('destroy', handle).");
+    }
+
+    SolverHandle *solver_handle = getHandle(input[1]);
+    g_solver_handles.erase(solver_handle);
+    delete solver_handle;
+}
+
+
+
+void mexFunction( int num_output, mxArray *output[], int num_input, const mxArray *input[] )
+{
+    if ((num_input > 0) && mxIsChar(input[0]))
+    {
+        char command[16];
+        if (0 != mxGetString(input[0], command, sizeof(command)))
+        {
+            mexErrMsgTxt("qpmad: unknown command.");
+        }
+
+        if (0 == std::strcmp(command, "create"))
+        {
+            createHandle(num_output, output, num_input, input);
+        }
+        else if (0 == std::strcmp(command, "solve"))
+        {
+            solveWithHandle(num_output, output, num_input, input);
+        }
+        else if (0 == std::strcmp(command, "destroy"))
+        {
+            destroyHandle(num_output, output, num_input, input);
+        }
+        else
+        {
+            mexErrMsgTxt("qpmad: unknown command.");
+        }
+    }
+    else
+    {
+        solveOnce(num_output, output, num_input, input);
+    }
 
     return;
 }
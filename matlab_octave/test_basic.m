@@ -99,3 +99,28 @@ xref = [1.0   2.0   3.0   4.0  -0.71875  -0.71875 -0.71875  -0.71875  -0.71875
 check_result(TEST_ID, (abs(sum(x-xref)) < tolerance) && (info.status == 0))
 TEST_ID = TEST_ID + 1;
 %-------------------------------------------------
+
+
+%-------------------------------------------------
+% persistent solver instance
+
+N = 20;
+handle = qpmad_interface('create', eye(N),
+                        [-100*ones(4,1); -5*ones(N-4, 1)],
+                        [100*ones(4,1); 0.5*ones(N-4, 1)],
+                        [eye(4), zeros(4, N-4); ones(1,N)],
+                        [1; 2; 3; 4; -1.5],
+                        [1; 2; 3; 4; 1.5]);
+[x, info] = qpmad_interface('solve', handle, ones(N, 1));
+xref = [1.0   2.0   3.0   4.0  -0.71875  -0.71875 -0.71875  -0.71875  -0.71875  -0.71875  -0.71875  -0.71875 -0.71875  -0.71875  -0.71875  -0.71875  -0.71875  -0.71875 -0.71875  -0.71875]';
+check_result(TEST_ID, (abs(sum(x-xref)) < tolerance) && (info.status == 0))
+TEST_ID = TEST_ID + 1;
+
+% only the upper bounds change
+[x, info] = qpmad_interface('solve', handle, [], [], [100*ones(4,1); -0.5*ones(N-4, 1)]);
+xref = [1.0   2.0   3.0   4.0  -0.5  -0.5 -0.5  -0.5  -0.5  -0.5  -0.5  -0.5 -0.5  -0.5  -0.5  -0.5  -0.5  -0.5 -0.5  -0.5]';
+check_result(TEST_ID, (abs(sum(x-xref)) < tolerance) && (info.status == 0))
+TEST_ID = TEST_ID + 1;
+
+qpmad_interface('destroy', handle);
+%-------------------------------------------------
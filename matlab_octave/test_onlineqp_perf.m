@@ -44,14 +44,21 @@ for i = 1:numel(dir_list)
     obj_ref = load([dir_list{i}, '/obj_opt.oqp']);
 
 
+    % persistent solver instance: the Hessian is factorized once
+    if (number_general_ctr > 0)
+        qpmad_handle = qpmad_interface('create', H, lb(1, :)', ub(1, :)', Ain, lbin(1,:)', ubin(1,:)');
+    else
+        qpmad_handle = qpmad_interface('create', H, lb(1, :)', ub(1, :)', [], [], []);
+    end
+
     for j = 1:number_qp
         printf('Problem [%s] (%d) // [%d/%d]\n', dir_list{i}, i, j, number_qp);
 
         tic()
         if (number_general_ctr > 0)
-            [x, info] = qpmad(H, g(j,:)', [], [], lb(j, :)', ub(j, :)', Ain, lbin(j,:)', ubin(j,:)');
+            [x, info] = qpmad_interface('solve', qpmad_handle, g(j,:)', lb(j, :)', ub(j, :)', lbin(j,:)', ubin(j,:)');
         else
-            [x, info] = qpmad(H, g(j,:)', [], [], lb(j, :)', ub(j, :)');
+            [x, info] = qpmad_interface('solve', qpmad_handle, g(j,:)', lb(j, :)', ub(j, :)');
         end
         qpmad_time = [qpmad_time, toc()];
 
@@ -77,6 +84,8 @@ for i = 1:numel(dir_list)
         end
         quadprogpp_time = [quadprogpp_time, toc()];
     end
+
+    qpmad_interface('destroy', qpmad_handle);
 end
 
 figure
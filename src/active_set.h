@@ -16,16 +16,38 @@ namespace qpmad
     class ActiveSet
     {
         public:
-            std::vector<MatrixIndex>                active_constraints_indices_;
+            MatrixIndex                             *active_constraints_indices_;
+            MatrixIndex                             max_size_;
             MatrixIndex                             size_;
             MatrixIndex                             num_equalities_;
             MatrixIndex                             num_inequalities_;
 
 
         public:
-            void initialize(const MatrixIndex max_size)
+            ActiveSet()
+            {
+                active_constraints_indices_ = NULL;
+                max_size_ = 0;
+                initialize();
+            }
+
+
+            static std::size_t getWorkspaceSize(const MatrixIndex max_size)
+            {
+                return (Workspace::getChunkSize<MatrixIndex>(max_size));
+            }
+
+
+            void mapWorkspace(  Workspace           & workspace,
+                                const MatrixIndex   max_size)
+            {
+                active_constraints_indices_ = workspace.allocate<MatrixIndex>(max_size);
+                max_size_ = max_size;
+            }
+
+
+            void initialize()
             {
-                active_constraints_indices_.resize(max_size);
                 size_ = 0;
                 num_equalities_ = 0;
                 num_inequalities_ = 0;
@@ -40,7 +62,7 @@ namespace qpmad
 
             bool hasEmptySpace() const
             {
-                return(static_cast<std::size_t>(size_) < active_constraints_indices_.size());
+                return(size_ < max_size_);
             }
 
 
@@ -61,16 +83,39 @@ namespace qpmad
 
 
             void removeInequality(const MatrixIndex index)
+            {
+                removeElement(index);
+                --num_inequalities_;
+            }
+
+
+            void removeEquality(const MatrixIndex index)
+            {
+                removeElement(index);
+                --num_equalities_;
+            }
+
+
+            /// Deactivate the last inequalities, so that 'size' constraints
+            /// remain active.
+            void truncate(const MatrixIndex size)
+            {
+                num_inequalities_ -= size_ - size;
+                size_ = size;
+            }
+
+
+        private:
+            void removeElement(const MatrixIndex index)
             {
                 if (size_ - index > 1)
                 {
                     // deactivated constraint is not the last one added
-                    std::copy(  active_constraints_indices_.begin() + index + 1,
-                                active_constraints_indices_.begin() + size_,
-                                active_constraints_indices_.begin() + index);
+                    std::copy(  active_constraints_indices_ + index + 1,
+                                active_constraints_indices_ + size_,
+                                active_constraints_indices_ + index);
                 }
                 --size_;
-                --num_inequalities_;
             }
     };
 }
@@ -0,0 +1,823 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#pragma once
+
+#include <vector>
+#include <limits>
+
+#include "common.h"
+#include "solver_parameters.h"
+#include "solver.h"
+
+
+namespace qpmad
+{
+    /**
+     * @brief Batched solver for many small QPs of the same size
+     *
+     *  min 0.5 * x^T * H * x + h^T * x
+     *  s.t. Alb <= A * x <= Aub
+     *
+     * Problems are processed in t_num_lanes lanes, the data of a lane is
+     * stored in structure-of-arrays layout: each element is an array of
+     * t_num_lanes values belonging to different problems, so that all
+     * operations of the dual algorithm are vectorized across problems.
+     * The iterations are performed in lockstep with masking of the
+     * lanes, which take a different branch of the algorithm, e.g.,
+     * addition vs removal of a constraint. A lane is refilled from the
+     * queue of pending problems as soon as its problem is finished.
+     *
+     * Differences from Solver:
+     *  - only dense Hessians are supported
+     *    (SolverParameters::HESSIAN_LOWER_TRIANGULAR);
+     *  - simple bounds are not handled separately, they must be added to
+     *    A;
+     *  - equality constraints (Alb == Aub) are treated as double sided
+     *    inequalities;
+     *  - warm start and active set size limits are not supported.
+     *
+     * The solver is intended for problems with up to a few dozens of
+     * variables and constraints, where the overhead of a scalar
+     * implementation dominates. The speedup over Solver is limited by
+     * masking: the loops over columns of R and J cover the largest active
+     * set among the lanes, which differs more when the lanes are refilled
+     * at different times; and by transposition of the problems to the
+     * lanes. batch_time* tests in tests/batch_solver.cpp report about
+     * 1.5-2 times for 10 variables and 20 constraints, and 1.1-1.8 times
+     * for 20 variables and 40 constraints with AVX-512; with SSE2 the
+     * solver is not faster than Solver.
+     */
+    template<int t_num_lanes = 8>
+        class BatchSolver
+    {
+        public:
+            typedef Eigen::Array<double, t_num_lanes, 1>                LaneVector;
+            typedef Eigen::Array<bool, t_num_lanes, 1>                  LaneMask;
+            typedef Eigen::Array<MatrixIndex, t_num_lanes, 1>           LaneIndex;
+            typedef Eigen::Array<double, t_num_lanes, Eigen::Dynamic>   LaneMatrix;
+
+
+        public:
+            BatchSolver()
+            {
+                num_problems_ = 0;
+                primal_size_ = 0;
+                num_constraints_ = 0;
+            }
+
+
+            /**
+             * @brief Allocate memory for a batch of problems, no memory is
+             * allocated by the other methods.
+             *
+             * @param[in] num_problems number of problems in the batch
+             * @param[in] primal_size number of variables
+             * @param[in] num_constraints number of general constraints
+             *
+             * @return Solver::INVALID_INPUT if the sizes are wrong.
+             */
+            Solver::ReturnStatus initialize(const MatrixIndex num_problems,
+                                            const MatrixIndex primal_size,
+                                            const MatrixIndex num_constraints)
+            {
+                QPMAD_CHECK(    (num_problems >= 0) && (primal_size > 0) && (num_constraints >= 0),
+                                Solver::INVALID_INPUT, "Wrong size of the batch.");
+
+                num_problems_ = num_problems;
+                primal_size_ = primal_size;
+                num_constraints_ = num_constraints;
+
+                problems_.initialize(num_problems_, primal_size_, num_constraints_);
+
+                H_.resize(t_num_lanes, primal_size_ * primal_size_);
+                h_.resize(t_num_lanes, primal_size_);
+                A_.resize(t_num_lanes, num_constraints_ * primal_size_);
+                Alb_.resize(t_num_lanes, num_constraints_);
+                Aub_.resize(t_num_lanes, num_constraints_);
+                primal_.resize(t_num_lanes, primal_size_);
+
+                J_.resize(t_num_lanes, primal_size_ * primal_size_);
+                R_.resize(t_num_lanes, primal_size_ * primal_size_);
+                d_.resize(t_num_lanes, primal_size_);
+                z_.resize(t_num_lanes, primal_size_);
+                r_.resize(t_num_lanes, primal_size_);
+                normal_.resize(t_num_lanes, primal_size_);
+                dual_.resize(t_num_lanes, primal_size_);
+                active_index_.resize(t_num_lanes, primal_size_);
+                active_ctr_offset_.resize(t_num_lanes, num_constraints_);
+                ctr_violation_.resize(t_num_lanes, num_constraints_);
+
+                // entries of R and dual variables beyond the active set
+                // are not reset between problems, they are finite and are
+                // multiplied by zeros
+                R_.setZero();
+                dual_.setZero();
+                active_index_.setZero();
+
+                // unused lanes of the last group of problems in
+                // factorizeHessians() contain trivial problems
+                H_.setZero();
+                for (MatrixIndex i = 0; i < primal_size_; ++i)
+                {
+                    H_.col(index(i, i)).setOnes();
+                }
+                h_.setZero();
+
+                return (Solver::OK);
+            }
+
+
+            /**
+             * @brief Copy a problem to the batch.
+             *
+             * @param[in] problem_index index of the problem in the batch
+             * @param[in] H Hessian, only the lower triangular part is used
+             *
+             * @return Solver::INVALID_INPUT if the index or the sizes are
+             * wrong.
+             */
+            template<   class t_H,
+                        class t_h,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                Solver::ReturnStatus setProblem(const MatrixIndex               problem_index,
+                                                const Eigen::MatrixBase<t_H>    & H,
+                                                const Eigen::MatrixBase<t_h>    & h,
+                                                const Eigen::MatrixBase<t_A>    & A,
+                                                const Eigen::MatrixBase<t_Alb>  & Alb,
+                                                const Eigen::MatrixBase<t_Aub>  & Aub)
+            {
+                QPMAD_CHECK(    (problem_index >= 0) && (problem_index < num_problems_),
+                                Solver::INVALID_INPUT, "Wrong problem index.");
+                QPMAD_CHECK(    (H.rows() == primal_size_) && (H.cols() == primal_size_),
+                                Solver::INVALID_INPUT, "Wrong size of H.");
+                QPMAD_CHECK(    h.rows() == primal_size_,
+                                Solver::INVALID_INPUT, "Wrong size of h.");
+                QPMAD_CHECK(    (A.rows() == num_constraints_) && (A.cols() == primal_size_),
+                                Solver::INVALID_INPUT, "Wrong size of A.");
+                QPMAD_CHECK(    (Alb.rows() == num_constraints_) && (Aub.rows() == num_constraints_),
+                                Solver::INVALID_INPUT, "Wrong size of bounds.");
+
+                for (MatrixIndex j = 0; j < primal_size_; ++j)
+                {
+                    for (MatrixIndex i = j; i < primal_size_; ++i)
+                    {
+                        problems_.H_(index(i, j), problem_index) = H(i, j);
+                    }
+                    problems_.h_(j, problem_index) = h(j);
+                }
+
+                for (MatrixIndex i = 0; i < num_constraints_; ++i)
+                {
+                    for (MatrixIndex j = 0; j < primal_size_; ++j)
+                    {
+                        problems_.A_(i * primal_size_ + j, problem_index) = A(i, j);
+                    }
+                    problems_.Alb_(i, problem_index) = Alb(i);
+                    problems_.Aub_(i, problem_index) = Aub(i);
+                }
+
+                return (Solver::OK);
+            }
+
+
+            /**
+             * @brief Solve all problems of the batch.
+             *
+             * Only tolerance_ and max_iter_ are used, hessian_type_ must be
+             * HESSIAN_LOWER_TRIANGULAR.
+             *
+             * @return Solver::INVALID_INPUT if the parameters are not
+             * supported, statuses of the problems are reported by
+             * getStatus().
+             */
+            Solver::ReturnStatus solve(const SolverParameters & param)
+            {
+                QPMAD_CHECK(    SolverParameters::HESSIAN_LOWER_TRIANGULAR == param.hessian_type_,
+                                Solver::INVALID_INPUT, "Batch solver supports only dense Hessians.");
+
+                const MatrixIndex   n = primal_size_;
+                const double        inf = std::numeric_limits<double>::infinity();
+
+                factorizeHessians();
+
+                MatrixIndex next_problem = 0;
+                lane_problem_.setConstant(-1);
+
+                LaneVector  active_set_size = LaneVector::Zero();
+                LaneVector  chosen_index = LaneVector::Constant(-1);
+                LaneVector  chosen_sign = LaneVector::Zero();
+                LaneVector  chosen_dual = LaneVector::Zero();
+                LaneVector  bound = LaneVector::Zero();
+                LaneIndex   num_iter = LaneIndex::Zero();
+                LaneMask    choose = LaneMask::Constant(false);
+
+
+                for (;;)
+                {
+                    // refill idle lanes from the queue of pending problems
+                    if (next_problem < num_problems_)
+                    {
+                        LaneMask refill = LaneMask::Constant(false);
+                        for (MatrixIndex lane = 0; (lane < t_num_lanes) && (next_problem < num_problems_); ++lane)
+                        {
+                            if (lane_problem_(lane) < 0)
+                            {
+                                loadProblem(lane, next_problem);
+                                refill(lane) = true;
+                                ++next_problem;
+                            }
+                        }
+
+                        if (refill.any())
+                        {
+                            active_set_size = refill.select(LaneVector::Zero(), active_set_size);
+                            num_iter = refill.select(LaneIndex::Zero(), num_iter);
+                            choose = choose || refill;
+                        }
+                    }
+
+                    LaneMask running = (lane_problem_ >= 0);
+                    if (false == running.any())
+                    {
+                        break;
+                    }
+
+
+                    // choose the most violated constraint: violations are
+                    // computed in all lanes, the index of the maximal
+                    // violation is searched only in the lanes, which need it
+                    LaneMask solved = LaneMask::Constant(false);
+                    if ((choose && running).any())
+                    {
+                        LaneVector max_violation = LaneVector::Constant(param.tolerance_);
+                        for (MatrixIndex c = 0; c < num_constraints_; ++c)
+                        {
+                            LaneVector dot = LaneVector::Zero();
+                            for (MatrixIndex j = 0; j < n; ++j)
+                            {
+                                dot += A_.col(c * n + j) * primal_.col(j);
+                            }
+                            ctr_violation_.col(c) = (Alb_.col(c) - dot).max(dot - Aub_.col(c))
+                                                    + active_ctr_offset_.col(c);
+                            max_violation = max_violation.max(ctr_violation_.col(c));
+                        }
+
+                        for (MatrixIndex lane = 0; lane < t_num_lanes; ++lane)
+                        {
+                            if (choose(lane) && running(lane))
+                            {
+                                if (max_violation(lane) > param.tolerance_)
+                                {
+                                    MatrixIndex c = 0;
+                                    while (ctr_violation_(lane, c) != max_violation(lane))
+                                    {
+                                        ++c;
+                                    }
+
+                                    const double dot = (A_.row(lane).segment(c * n, n) * primal_.row(lane)).sum();
+
+                                    chosen_index(lane) = c;
+                                    chosen_sign(lane) = (Alb_(lane, c) - dot > dot - Aub_(lane, c)) ? 1.0 : -1.0;
+                                    chosen_dual(lane) = 0.0;
+
+                                    // normal^T * x >= bound
+                                    normal_.row(lane) = chosen_sign(lane) * A_.row(lane).segment(c * n, n);
+                                    bound(lane) = chosen_sign(lane) > 0.0 ? Alb_(lane, c) : -Aub_(lane, c);
+                                }
+                                else
+                                {
+                                    solved(lane) = true;
+                                }
+
+                                choose(lane) = false;
+                            }
+                        }
+                    }
+
+                    // the lanes are refilled at the next iteration
+                    if (solved.any())
+                    {
+                        storeSolutions(solved, Solver::OK);
+                        running = running && (!solved);
+                    }
+
+                    if (param.max_iter_ >= 0)
+                    {
+                        const LaneMask exceeded = running && (num_iter >= param.max_iter_);
+                        if (exceeded.any())
+                        {
+                            storeSolutions(exceeded, Solver::MAXIMAL_NUMBER_OF_ITERATIONS);
+                            running = running && (!exceeded);
+                        }
+                    }
+
+                    if (false == running.any())
+                    {
+                        continue;
+                    }
+
+
+                    LaneVector slack = - bound;
+                    for (MatrixIndex j = 0; j < n; ++j)
+                    {
+                        slack += normal_.col(j) * primal_.col(j);
+                    }
+
+
+                    // d = J^T * normal
+                    for (MatrixIndex i = 0; i < n; ++i)
+                    {
+                        LaneVector element = LaneVector::Zero();
+                        for (MatrixIndex k = 0; k < n; ++k)
+                        {
+                            element += J_.col(index(k, i)) * normal_.col(k);
+                        }
+                        d_.col(i) = element;
+                    }
+
+                    // loops are restricted to the columns, which are used
+                    // by at least one running lane
+                    const MatrixIndex min_active_set_size = static_cast<MatrixIndex>(
+                            running.select(active_set_size, LaneVector::Constant(n)).minCoeff());
+                    const MatrixIndex max_active_set_size = static_cast<MatrixIndex>(
+                            running.select(active_set_size, LaneVector::Zero()).maxCoeff());
+
+                    // primal step direction z = J2 * J2^T * normal
+                    LaneVector z_dot_normal = LaneVector::Zero();
+                    z_.setZero();
+                    for (MatrixIndex i = min_active_set_size; i < n; ++i)
+                    {
+                        const LaneVector d_i = (active_set_size <= static_cast<double>(i)).select(d_.col(i), 0.0);
+                        z_dot_normal += d_i.square();
+                        for (MatrixIndex k = 0; k < n; ++k)
+                        {
+                            z_.col(k) += J_.col(index(k, i)) * d_i;
+                        }
+                    }
+
+                    // dual step direction r = R^-1 * J1^T * normal
+                    for (MatrixIndex i = max_active_set_size - 1; i >= 0; --i)
+                    {
+                        LaneVector element = d_.col(i);
+                        for (MatrixIndex k = i + 1; k < max_active_set_size; ++k)
+                        {
+                            element -= R_.col(index(i, k)) * r_.col(k);
+                        }
+
+                        const LaneMask mask = (active_set_size > static_cast<double>(i));
+                        r_.col(i) = mask.select(element / mask.select(R_.col(index(i, i)), 1.0), 0.0);
+                    }
+
+
+                    // step lengths
+                    LaneVector  dual_step_length = LaneVector::Constant(inf);
+                    LaneVector  blocking_index = LaneVector::Constant(-1);
+                    for (MatrixIndex i = 0; i < max_active_set_size; ++i)
+                    {
+                        const LaneMask      mask = (active_set_size > static_cast<double>(i)) && (r_.col(i) > param.tolerance_);
+                        const LaneVector    step = dual_.col(i) / mask.select(r_.col(i), 1.0);
+                        const LaneMask      shorter = mask && (step < dual_step_length);
+
+                        dual_step_length = shorter.select(step, dual_step_length);
+                        blocking_index = shorter.select(LaneVector::Constant(i), blocking_index);
+                    }
+
+                    const LaneMask      primal_step_mask = (z_dot_normal > param.tolerance_);
+                    const LaneVector    primal_step_length = primal_step_mask.select(
+                                                                    -slack / primal_step_mask.select(z_dot_normal, 1.0),
+                                                                    inf);
+                    const LaneMask      full_step = running && primal_step_mask && (primal_step_length <= dual_step_length);
+                    const LaneMask      partial_step = running && (!full_step) && (dual_step_length < inf);
+                    const LaneMask      infeasible = running && (!full_step) && (!partial_step);
+
+                    const LaneVector step_length = full_step.select(
+                                                        primal_step_length,
+                                                        partial_step.select(dual_step_length, 0.0));
+
+
+                    // take the step
+                    const LaneVector primal_step_length_masked = primal_step_mask.select(step_length, 0.0);
+                    for (MatrixIndex k = 0; k < n; ++k)
+                    {
+                        primal_.col(k) += primal_step_length_masked * z_.col(k);
+                    }
+                    for (MatrixIndex i = 0; i < max_active_set_size; ++i)
+                    {
+                        dual_.col(i) -= step_length * r_.col(i);
+                    }
+                    chosen_dual += step_length;
+                    num_iter += running.select(LaneIndex::Ones(), LaneIndex::Zero());
+
+
+                    // add the chosen constraint: rotate J2 to reduce d2 to a
+                    // single element
+                    if (full_step.any())
+                    {
+                        LaneVector cos;
+                        LaneVector sin;
+                        for (MatrixIndex i = n - 1; i > min_active_set_size; --i)
+                        {
+                            const LaneMask mask = full_step && (active_set_size < static_cast<double>(i));
+                            const LaneVector a = d_.col(i - 1);
+                            const LaneVector b = d_.col(i);
+
+                            computeRotation(cos, sin, a, b, mask);
+                            d_.col(i - 1) = cos * a + sin * b;
+                            d_.col(i) = cos * b - sin * a;
+                            rotateJ(i - 1, cos, sin);
+                        }
+
+                        // the new column of R is the active set size, which
+                        // differs between lanes: columns are blended with
+                        // 0 / 1 weights, since select() is not vectorized
+                        for (MatrixIndex j = min_active_set_size; j <= std::min(max_active_set_size, n - 1); ++j)
+                        {
+                            const LaneMask mask = full_step && (active_set_size == static_cast<double>(j));
+                            if (false == mask.any())
+                            {
+                                continue;
+                            }
+
+                            const LaneVector weight = mask.select(LaneVector::Ones(), LaneVector::Zero());
+                            const LaneVector keep = 1.0 - weight;
+                            for (MatrixIndex i = 0; i <= j; ++i)
+                            {
+                                R_.col(index(i, j)) = weight * d_.col(i) + keep * R_.col(index(i, j));
+                            }
+                            dual_.col(j) = weight * chosen_dual + keep * dual_.col(j);
+                            active_index_.col(j) = weight * chosen_sign * (chosen_index + 1.0) + keep * active_index_.col(j);
+                        }
+
+                        for (MatrixIndex lane = 0; lane < t_num_lanes; ++lane)
+                        {
+                            if (full_step(lane))
+                            {
+                                active_ctr_offset_(lane, static_cast<MatrixIndex>(chosen_index(lane))) = -inf;
+                            }
+                        }
+
+                        active_set_size += full_step.select(LaneVector::Ones(), LaneVector::Zero());
+                    }
+
+
+                    // remove the blocking constraint: shift columns of R
+                    // and restore its triangular form
+                    if (partial_step.any())
+                    {
+                        for (MatrixIndex lane = 0; lane < t_num_lanes; ++lane)
+                        {
+                            if (partial_step(lane))
+                            {
+                                const MatrixIndex blocking = static_cast<MatrixIndex>(blocking_index(lane));
+                                active_ctr_offset_(lane, static_cast<MatrixIndex>(std::abs(active_index_(lane, blocking))) - 1) = 0.0;
+                            }
+                        }
+
+                        const MatrixIndex min_blocking_index = static_cast<MatrixIndex>(
+                                partial_step.select(blocking_index, LaneVector::Constant(n)).minCoeff());
+
+                        for (MatrixIndex j = min_blocking_index; j < max_active_set_size - 1; ++j)
+                        {
+                            const LaneMask mask = partial_step
+                                                    && (blocking_index <= static_cast<double>(j))
+                                                    && (active_set_size - 1.0 > static_cast<double>(j));
+                            if (false == mask.any())
+                            {
+                                continue;
+                            }
+
+                            const LaneVector weight = mask.select(LaneVector::Ones(), LaneVector::Zero());
+                            const LaneVector keep = 1.0 - weight;
+                            for (MatrixIndex i = 0; i <= j + 1; ++i)
+                            {
+                                R_.col(index(i, j)) = weight * R_.col(index(i, j + 1)) + keep * R_.col(index(i, j));
+                            }
+                            dual_.col(j) = weight * dual_.col(j + 1) + keep * dual_.col(j);
+                            active_index_.col(j) = weight * active_index_.col(j + 1) + keep * active_index_.col(j);
+                        }
+
+                        LaneVector cos;
+                        LaneVector sin;
+                        for (MatrixIndex i = min_blocking_index; i < max_active_set_size - 1; ++i)
+                        {
+                            const LaneMask mask = partial_step && (blocking_index <= static_cast<double>(i)) && (active_set_size - 1.0 > static_cast<double>(i));
+                            if (false == mask.any())
+                            {
+                                // identity in all lanes
+                                continue;
+                            }
+
+                            computeRotation(cos, sin, R_.col(index(i, i)), R_.col(index(i + 1, i)), mask);
+                            for (MatrixIndex j = i; j < max_active_set_size; ++j)
+                            {
+                                const LaneVector a = R_.col(index(i, j));
+                                const LaneVector b = R_.col(index(i + 1, j));
+                                R_.col(index(i, j)) = cos * a + sin * b;
+                                R_.col(index(i + 1, j)) = cos * b - sin * a;
+                            }
+                            rotateJ(i, cos, sin);
+                        }
+
+                        active_set_size -= partial_step.select(LaneVector::Ones(), LaneVector::Zero());
+                    }
+
+
+                    if (infeasible.any())
+                    {
+                        storeSolutions(infeasible, Solver::INFEASIBLE_INEQUALITY);
+                    }
+
+                    choose = full_step;
+                }
+
+                return (Solver::OK);
+            }
+
+
+            Solver::ReturnStatus solve()
+            {
+                return (solve(SolverParameters()));
+            }
+
+
+            /// @return Solver::INVALID_INPUT if the index is wrong.
+            Solver::ReturnStatus getStatus(const MatrixIndex problem_index) const
+            {
+                QPMAD_CHECK(    (problem_index >= 0) && (problem_index < num_problems_),
+                                Solver::INVALID_INPUT, "Wrong problem index.");
+
+                return (static_cast<Solver::ReturnStatus>(problems_.status_(problem_index)));
+            }
+
+
+            /// @return Solver::INVALID_INPUT if the index is wrong.
+            template<class t_primal>
+                Solver::ReturnStatus getPrimal( const MatrixIndex               problem_index,
+                                                Eigen::MatrixBase<t_primal>     & primal) const
+            {
+                QPMAD_CHECK(    (problem_index >= 0) && (problem_index < num_problems_),
+                                Solver::INVALID_INPUT, "Wrong problem index.");
+
+                primal.derived().resize(primal_size_);
+                primal = problems_.primal_.col(problem_index).matrix();
+
+                return (Solver::OK);
+            }
+
+
+        private:
+            /// Data and solutions of all problems, one column per problem
+            class Problems
+            {
+                public:
+                    Eigen::ArrayXXd H_;
+                    Eigen::ArrayXXd h_;
+                    Eigen::ArrayXXd A_;
+                    Eigen::ArrayXXd Alb_;
+                    Eigen::ArrayXXd Aub_;
+
+                    /// J = L^-T, where H = L * L^T, see factorizeHessians()
+                    Eigen::ArrayXXd J_;
+
+                    /// unconstrained optimum before solution
+                    Eigen::ArrayXXd primal_;
+                    Eigen::ArrayXi  status_;
+
+                public:
+                    /// Problems, which are not set, are trivial.
+                    void initialize(const MatrixIndex num_problems,
+                                    const MatrixIndex primal_size,
+                                    const MatrixIndex num_constraints)
+                    {
+                        H_.setZero(primal_size * primal_size, num_problems);
+                        for (MatrixIndex i = 0; i < primal_size; ++i)
+                        {
+                            H_.row(i * primal_size + i).setOnes();
+                        }
+                        h_.setZero(primal_size, num_problems);
+                        A_.setZero(num_constraints * primal_size, num_problems);
+                        Alb_.setConstant(num_constraints, num_problems, -std::numeric_limits<double>::infinity());
+                        Aub_.setConstant(num_constraints, num_problems, std::numeric_limits<double>::infinity());
+
+                        J_.resize(primal_size * primal_size, num_problems);
+                        primal_.setZero(primal_size, num_problems);
+                        status_.setConstant(num_problems, Solver::OK);
+                    }
+            };
+
+
+        private:
+            MatrixIndex num_problems_;
+            MatrixIndex primal_size_;
+            MatrixIndex num_constraints_;
+
+            Problems    problems_;
+
+            /// problems in the lanes, -1 for idle lanes
+            LaneIndex   lane_problem_;
+
+            /// data of the problems in the lanes, see Problems
+            LaneMatrix  H_;
+            LaneMatrix  h_;
+            LaneMatrix  A_;
+            LaneMatrix  Alb_;
+            LaneMatrix  Aub_;
+            LaneMatrix  primal_;
+
+            /// J * J^T = H^-1, J^T * N = [R; 0], matrices are stored
+            /// column-wise: element (i, j) is in column j * n + i.
+            LaneMatrix  J_;
+            LaneMatrix  R_;
+
+            LaneMatrix  d_;
+            LaneMatrix  z_;
+            LaneMatrix  r_;
+
+            /// normal of the chosen constraint 'normal^T * x >= bound'
+            LaneMatrix  normal_;
+
+            LaneMatrix  dual_;
+            /// active constraints: sign * (index + 1), where the sign is
+            /// positive for lower bounds
+            LaneMatrix  active_index_;
+            /// 0 for inactive constraints, -infinity for active
+            LaneMatrix  active_ctr_offset_;
+            LaneMatrix  ctr_violation_;
+
+
+        private:
+            MatrixIndex index(const MatrixIndex row, const MatrixIndex col) const
+            {
+                return (col * primal_size_ + row);
+            }
+
+
+            /// Copy a pending problem to an idle lane.
+            void loadProblem(const MatrixIndex lane, const MatrixIndex problem_index)
+            {
+                lane_problem_(lane) = problem_index;
+
+                J_.row(lane) = problems_.J_.col(problem_index).transpose();
+                primal_.row(lane) = problems_.primal_.col(problem_index).transpose();
+                A_.row(lane) = problems_.A_.col(problem_index).transpose();
+                Alb_.row(lane) = problems_.Alb_.col(problem_index).transpose();
+                Aub_.row(lane) = problems_.Aub_.col(problem_index).transpose();
+
+                active_ctr_offset_.row(lane).setZero();
+            }
+
+
+            /// Copy solutions from the lanes and mark the lanes idle.
+            void storeSolutions(const LaneMask & mask, const Solver::ReturnStatus status)
+            {
+                for (MatrixIndex lane = 0; lane < t_num_lanes; ++lane)
+                {
+                    if (mask(lane))
+                    {
+                        problems_.primal_.col(lane_problem_(lane)) = primal_.row(lane).transpose();
+                        problems_.status_(lane_problem_(lane)) = status;
+                        lane_problem_(lane) = -1;
+                    }
+                }
+            }
+
+
+            /**
+             * @brief Compute J = L^-T, where H = L * L^T, and the
+             * unconstrained optimum of all problems.
+             *
+             * Problems are processed in groups of t_num_lanes before
+             * solution, so that the factorization is vectorized even
+             * though the lanes are refilled one by one. L is stored in R_,
+             * which is not used at this point.
+             */
+            void factorizeHessians()
+            {
+                const MatrixIndex n = primal_size_;
+
+                for (MatrixIndex first = 0; first < num_problems_; first += t_num_lanes)
+                {
+                    // the last group may be incomplete, the remaining
+                    // lanes keep the previous problems
+                    const MatrixIndex num_lanes = std::min(static_cast<MatrixIndex>(t_num_lanes), num_problems_ - first);
+
+                    for (MatrixIndex lane = 0; lane < num_lanes; ++lane)
+                    {
+                        H_.row(lane) = problems_.H_.col(first + lane).transpose();
+                        h_.row(lane) = problems_.h_.col(first + lane).transpose();
+                    }
+
+
+                    for (MatrixIndex j = 0; j < n; ++j)
+                    {
+                        LaneVector diag = H_.col(index(j, j));
+                        for (MatrixIndex k = 0; k < j; ++k)
+                        {
+                            diag -= R_.col(index(j, k)).square();
+                        }
+                        diag = diag.sqrt();
+                        R_.col(index(j, j)) = diag;
+
+                        for (MatrixIndex i = j + 1; i < n; ++i)
+                        {
+                            LaneVector element = H_.col(index(i, j));
+                            for (MatrixIndex k = 0; k < j; ++k)
+                            {
+                                element -= R_.col(index(i, k)) * R_.col(index(j, k));
+                            }
+                            R_.col(index(i, j)) = element / diag;
+                        }
+                    }
+
+
+                    // J^T = L^-1, lower triangular
+                    J_.setZero();
+                    for (MatrixIndex j = 0; j < n; ++j)
+                    {
+                        J_.col(index(j, j)) = 1.0 / R_.col(index(j, j));
+                        for (MatrixIndex i = j + 1; i < n; ++i)
+                        {
+                            LaneVector element = LaneVector::Zero();
+                            for (MatrixIndex k = j; k < i; ++k)
+                            {
+                                element -= R_.col(index(i, k)) * J_.col(index(j, k));
+                            }
+                            J_.col(index(j, i)) = element / R_.col(index(i, i));
+                        }
+                    }
+
+
+                    // unconstrained optimum, x = - J * J^T * h
+                    for (MatrixIndex i = 0; i < n; ++i)
+                    {
+                        LaneVector element = LaneVector::Zero();
+                        for (MatrixIndex k = 0; k <= i; ++k)
+                        {
+                            element += J_.col(index(k, i)) * h_.col(k);
+                        }
+                        d_.col(i) = element;
+                    }
+                    for (MatrixIndex k = 0; k < n; ++k)
+                    {
+                        LaneVector element = LaneVector::Zero();
+                        for (MatrixIndex i = k; i < n; ++i)
+                        {
+                            element -= J_.col(index(k, i)) * d_.col(i);
+                        }
+                        primal_.col(k) = element;
+                    }
+
+
+                    for (MatrixIndex lane = 0; lane < num_lanes; ++lane)
+                    {
+                        problems_.J_.col(first + lane) = J_.row(lane).transpose();
+                        problems_.primal_.col(first + lane) = primal_.row(lane).transpose();
+                    }
+                }
+            }
+
+
+            /// Givens rotation of columns i and i+1 of J
+            void rotateJ(   const MatrixIndex   i,
+                            const LaneVector    & cos,
+                            const LaneVector    & sin)
+            {
+                for (MatrixIndex k = 0; k < primal_size_; ++k)
+                {
+                    const LaneVector ja = J_.col(index(k, i));
+                    const LaneVector jb = J_.col(index(k, i + 1));
+                    J_.col(index(k, i)) = cos * ja + sin * jb;
+                    J_.col(index(k, i + 1)) = cos * jb - sin * ja;
+                }
+            }
+
+
+            /**
+             * @brief Rotation, which transforms [a; b] to [sqrt(a^2 + b^2);
+             * 0], identity in the lanes where mask is false.
+             */
+            static void computeRotation(LaneVector          & cos,
+                                        LaneVector          & sin,
+                                        const LaneVector    & a,
+                                        const LaneVector    & b,
+                                        const LaneMask      & mask)
+            {
+                const LaneVector    norm = (a.square() + b.square()).sqrt();
+                const LaneMask      valid = mask && (norm > 0.0);
+                const LaneVector    safe_norm = valid.select(norm, LaneVector::Ones());
+
+                cos = valid.select(a / safe_norm, LaneVector::Ones());
+                sin = valid.select(b / safe_norm, LaneVector::Zero());
+            }
+    };
+}
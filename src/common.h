@@ -10,16 +10,45 @@
 
 #pragma once
 
+#include "config.h"
+
+#ifdef QPMAD_NO_EXCEPTIONS
+#include <cassert>
+#else
 #include <stdexcept>
+#endif
 #include <cmath>
 #include <Eigen/Core>
 
-#include "config.h"
-
 
+#ifdef QPMAD_NO_EXCEPTIONS
+// Failures of the solver are reported with return codes, see
+// Solver::ReturnStatus and Solver::getStatusMessage(); messages are not
+// formatted. Remaining assertions check internal invariants.
+#define QPMAD_ASSERT(condition, message)    assert((condition) && (message));
+#define QPMAD_THROW(message)                assert(false && (message));
+#define QPMAD_FAIL(status, message)         return (status);
+#else
 #define QPMAD_ASSERT(condition, message)    if (!(condition)) \
                                             {throw std::runtime_error(std::string("In ") + __func__ + "() // " + (message));}
 #define QPMAD_THROW(message)                throw std::runtime_error(std::string("In ") + __func__ + "() // " + (message));
+#define QPMAD_FAIL(status, message)         QPMAD_THROW(message)
+#endif
+/// Throws an exception or returns the status if the condition does not hold.
+#define QPMAD_CHECK(condition, status, message) if (!(condition)) \
+                                                {QPMAD_FAIL(status, message)}
+
+
+#ifndef QPMAD_WORKSPACE_ALIGNMENT
+#define QPMAD_WORKSPACE_ALIGNMENT           64
+#endif
+
+// Size of blocks of columns of the factorization in bytes, which are
+// reused by fused matrix-vector products, see
+// FactorizationData::computeProjectionAndPrimalStep()
+#ifndef QPMAD_CACHE_BLOCK_SIZE
+#define QPMAD_CACHE_BLOCK_SIZE              65536
+#endif
 
 
 #ifdef QPMAD_ENABLE_TRACING
@@ -28,6 +57,12 @@
 #define QPMAD_TRACE(info)
 #endif
 
+#ifdef QPMAD_ENABLE_EVENT_TRACE
+#define QPMAD_TRACE_EVENT(type, index, value)   qpmad::EventTrace::record(qpmad::EventTrace::type, index, value);
+#else
+#define QPMAD_TRACE_EVENT(type, index, value)
+#endif
+
 
 namespace qpmad
 {
@@ -36,6 +71,14 @@ namespace qpmad
     typedef     Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic>     QPMatrix;
     typedef     Eigen::Matrix<double, Eigen::Dynamic, 1>                  QPVector;
 
+    // the solver accesses constraints row-wise, so row-major storage
+    // (or a transposed column-major matrix) is preferable
+    typedef     Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>   QPRowMajorMatrix;
+
+    // views of the solver workspace, see Workspace
+    typedef     Eigen::Map<QPMatrix, Eigen::AlignedMax>                   QPMatrixMap;
+    typedef     Eigen::Map<QPVector, Eigen::AlignedMax>                   QPVectorMap;
+
 
     template <class t_VectorType>
         inline  void dropElementWithoutResize(  t_VectorType &vector,
@@ -0,0 +1,62 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#pragma once
+
+#include "common.h"
+
+
+namespace qpmad
+{
+    /**
+     * @brief Source of general constraints for the cutting-plane mode of
+     * the solver.
+     *
+     * Instead of scanning a constraint matrix, the solver asks the oracle
+     * for the most violated constraint 'lb <= row^T * primal <= ub' at the
+     * current primal point. This allows to solve problems with a very large
+     * or implicitly defined set of constraints: only the rows of active
+     * constraints are stored by the solver.
+     */
+    class ConstraintOracle
+    {
+        public:
+            virtual ~ConstraintOracle()
+            {
+            }
+
+
+            /**
+             * @brief Find the most violated constraint.
+             *
+             * The oracle is called once per iteration of the solver, the
+             * violation of the returned constraint is compared with the
+             * violation of simple bounds, which are checked by the solver.
+             * Constraints active at the current point must not be returned,
+             * which is automatically the case if only violated constraints
+             * are reported.
+             *
+             * @param[in] primal current primal point
+             * @param[in] tolerance constraints violated by less than this
+             * value are considered satisfied
+             * @param[out] row constraint vector, preallocated to the size
+             * of primal
+             * @param[out] lb lower bound, may be -infinity
+             * @param[out] ub upper bound, may be +infinity
+             *
+             * @return false if all constraints are satisfied.
+             */
+            virtual bool getMostViolatedConstraint( const Eigen::Ref<const QPVector>   & primal,
+                                                    const double                        tolerance,
+                                                    Eigen::Ref<QPVector>                row,
+                                                    double                              & lb,
+                                                    double                              & ub) = 0;
+    };
+}
@@ -23,7 +23,11 @@ namespace qpmad
                 INACTIVE            = 3,
                 ACTIVE_LOWER_BOUND  = 4,
                 ACTIVE_UPPER_BOUND  = 5,
-                VIOLATED            = 6
+                VIOLATED            = 6,
+                /// soft constraints, whose Lagrange multipliers are equal
+                /// to their weights, see Solver::solve()
+                SATURATED_LOWER_BOUND = 7,
+                SATURATED_UPPER_BOUND = 8
             };
     };
 }
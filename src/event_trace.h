@@ -0,0 +1,441 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#pragma once
+
+#include <time.h>
+
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <cstring>
+#include <cmath>
+
+
+namespace qpmad
+{
+    /**
+     * @brief Low-overhead trace of solver events.
+     *
+     * Events are stored in binary form in per-thread ring buffers, i.e.,
+     * recording an event does not allocate memory, format text or
+     * synchronize threads, only the newest events are kept when a buffer
+     * is full. The buffers can be written in a binary format and
+     * converted to the Chrome trace JSON format (chrome://tracing,
+     * Perfetto).
+     *
+     * Events are recorded by the solver if it is compiled with
+     * QPMAD_ENABLE_EVENT_TRACE (cmake -DQPMAD_ENABLE_EVENT_TRACE=ON). The
+     * implementation relies on POSIX clock_gettime() and GCC-compatible
+     * thread-local storage and atomic builtins.
+     *
+     * A buffer is allocated by the first event of each thread and is kept
+     * until the program exits, also after the thread is finished, i.e.,
+     * memory grows by capacity * sizeof(Event) bytes (1.5MB by default)
+     * per thread. Programs, which start many short-lived threads, should
+     * reduce the capacity before the threads record events.
+     */
+    class EventTrace
+    {
+        public:
+            enum EventType
+            {
+                SOLVE_BEGIN = 0,
+                ITERATION_START = 1,
+                CONSTRAINT_CHOSEN = 2,
+                PARTIAL_STEP = 3,
+                FULL_STEP = 4,
+                DOWNDATE = 5,
+                STATUS = 6,
+                NUMBER_OF_EVENT_TYPES = 7
+            };
+
+
+            class Event
+            {
+                public:
+                    /// microseconds, monotonic clock
+                    double  time_;
+                    /// e.g., violation, step length, return status
+                    double  value_;
+                    /// e.g., constraint index, iteration
+                    int     index_;
+                    int     type_;
+            };
+
+
+        public:
+            /**
+             * @brief Record an event in the buffer of the calling thread,
+             * the buffer is created on the first call.
+             */
+            static void record( const EventType     type,
+                                const int           index,
+                                const double        value)
+            {
+                Buffer *buffer = getThreadBuffer();
+                if (NULL == buffer)
+                {
+                    buffer = registerThreadBuffer();
+                }
+                buffer->record(type, index, value);
+            }
+
+
+            /**
+             * @brief Set the number of events in each ring buffer.
+             *
+             * The capacity is used by buffers created afterwards, existing
+             * buffers are resized by clear(), since they may be in use by
+             * other threads.
+             */
+            static void setCapacity(const std::size_t capacity)
+            {
+                Registry & registry = getRegistry();
+
+                registry.lock();
+                registry.capacity_ = capacity > 0 ? capacity : 1;
+                registry.unlock();
+            }
+
+
+            /// Discard recorded events and resize the buffers to the
+            /// current capacity, should not be called while events are
+            /// being recorded.
+            static void clear()
+            {
+                Registry & registry = getRegistry();
+
+                registry.lock();
+                for (std::size_t i = 0; i < registry.buffers_.size(); ++i)
+                {
+                    registry.buffers_[i]->initialize(registry.capacity_);
+                }
+                registry.unlock();
+            }
+
+
+            /// Number of recorded events in all buffers.
+            static std::size_t getNumEvents()
+            {
+                Registry & registry = getRegistry();
+                std::size_t num_events = 0;
+
+                registry.lock();
+                for (std::size_t i = 0; i < registry.buffers_.size(); ++i)
+                {
+                    num_events += registry.buffers_[i]->size_;
+                }
+                registry.unlock();
+
+                return (num_events);
+            }
+
+
+            /**
+             * @brief Write all buffers in binary format: a header (magic
+             * string, number of buffers), then for each buffer its thread
+             * id, the number of events and the events in chronological
+             * order.
+             */
+            static void writeBinary(std::ostream & out)
+            {
+                Registry & registry = getRegistry();
+
+                registry.lock();
+
+                out.write(getMagic(), getMagicSize());
+                writeValue(out, static_cast<int>(registry.buffers_.size()));
+
+                for (std::size_t i = 0; i < registry.buffers_.size(); ++i)
+                {
+                    const Buffer & buffer = *registry.buffers_[i];
+                    const std::size_t first = (buffer.next_ + buffer.events_.size() - buffer.size_) % buffer.events_.size();
+
+                    writeValue(out, buffer.thread_id_);
+                    writeValue(out, static_cast<int>(buffer.size_));
+                    for (std::size_t j = 0; j < buffer.size_; ++j)
+                    {
+                        writeValue(out, buffer.events_[(first + j) % buffer.events_.size()]);
+                    }
+                }
+
+                registry.unlock();
+            }
+
+
+            /**
+             * @brief Convert a binary trace produced by writeBinary() to the
+             * Chrome trace JSON format.
+             *
+             * Solver calls are represented by duration events, other events
+             * are instant events with their index and value as arguments.
+             *
+             * @return false if the input is malformed.
+             */
+            static bool convertToChromeTrace(std::istream & in, std::ostream & out)
+            {
+                char magic[8];
+                in.read(magic, getMagicSize());
+                if ((false == in.good()) || (0 != std::memcmp(magic, getMagic(), getMagicSize())))
+                {
+                    return (false);
+                }
+
+                int num_buffers = 0;
+                if (false == readValue(in, num_buffers))
+                {
+                    return (false);
+                }
+
+                out << std::setprecision(std::numeric_limits<double>::digits10);
+                out << "{\"traceEvents\":[";
+
+                bool first_event = true;
+                for (int i = 0; i < num_buffers; ++i)
+                {
+                    int thread_id = 0;
+                    int num_events = 0;
+                    if ((false == readValue(in, thread_id)) || (false == readValue(in, num_events)))
+                    {
+                        return (false);
+                    }
+
+                    for (int j = 0; j < num_events; ++j)
+                    {
+                        Event event;
+                        if ((false == readValue(in, event))
+                                || (event.type_ < 0) || (event.type_ >= NUMBER_OF_EVENT_TYPES))
+                        {
+                            return (false);
+                        }
+
+                        out << (first_event ? "\n" : ",\n");
+                        first_event = false;
+
+                        out << "{\"name\":\"" << getEventName(event.type_) << "\""
+                            << ",\"cat\":\"qpmad\""
+                            << ",\"pid\":0"
+                            << ",\"tid\":" << thread_id
+                            << ",\"ts\":" << event.time_;
+
+                        switch (event.type_)
+                        {
+                            case SOLVE_BEGIN:
+                                out << ",\"ph\":\"B\"";
+                                break;
+                            case STATUS:
+                                out << ",\"ph\":\"E\"";
+                                break;
+                            default:
+                                out << ",\"ph\":\"i\",\"s\":\"t\"";
+                                break;
+                        }
+
+                        out << ",\"args\":{\"index\":" << event.index_ << ",\"value\":";
+                        if (event.value_ == event.value_)
+                        {
+                            // JSON does not support infinity
+                            if (std::abs(event.value_) <= std::numeric_limits<double>::max())
+                            {
+                                out << event.value_;
+                            }
+                            else
+                            {
+                                out << (event.value_ > 0 ? "\"inf\"" : "\"-inf\"");
+                            }
+                        }
+                        else
+                        {
+                            out << "\"nan\"";
+                        }
+                        out << "}}";
+                    }
+                }
+
+                out << "\n]}\n";
+
+                return (true);
+            }
+
+
+            /// Write recorded events in the Chrome trace JSON format.
+            static void writeChromeTrace(std::ostream & out)
+            {
+                std::stringstream binary;
+                writeBinary(binary);
+                convertToChromeTrace(binary, out);
+            }
+
+
+        private:
+            class Buffer
+            {
+                public:
+                    std::vector<Event>  events_;
+                    std::size_t         next_;
+                    std::size_t         size_;
+                    int                 thread_id_;
+
+
+                public:
+                    void initialize(const std::size_t capacity)
+                    {
+                        events_.resize(capacity);
+                        next_ = 0;
+                        size_ = 0;
+                    }
+
+
+                    void record(const EventType     type,
+                                const int           index,
+                                const double        value)
+                    {
+                        struct timespec time;
+                        clock_gettime(CLOCK_MONOTONIC, &time);
+
+                        Event & event = events_[next_];
+                        event.time_ = static_cast<double>(time.tv_sec) * 1e6 + static_cast<double>(time.tv_nsec) * 1e-3;
+                        event.value_ = value;
+                        event.index_ = index;
+                        event.type_ = type;
+
+                        next_ = (next_ + 1) % events_.size();
+                        if (size_ < events_.size())
+                        {
+                            ++size_;
+                        }
+                    }
+            };
+
+
+            class Registry
+            {
+                public:
+                    std::vector<Buffer *>   buffers_;
+                    std::size_t             capacity_;
+                    volatile int            lock_;
+
+
+                public:
+                    Registry()
+                    {
+                        capacity_ = 65536;
+                        lock_ = 0;
+                    }
+
+
+                    ~Registry()
+                    {
+                        for (std::size_t i = 0; i < buffers_.size(); ++i)
+                        {
+                            delete buffers_[i];
+                        }
+                    }
+
+
+                    void lock()
+                    {
+                        while (__sync_lock_test_and_set(&lock_, 1))
+                        {
+                        }
+                    }
+
+
+                    void unlock()
+                    {
+                        __sync_lock_release(&lock_);
+                    }
+            };
+
+
+        private:
+            static Registry & getRegistry()
+            {
+                static Registry registry;
+                return (registry);
+            }
+
+
+            static Buffer *& getThreadBuffer()
+            {
+                static __thread Buffer *buffer = NULL;
+                return (buffer);
+            }
+
+
+            static Buffer * registerThreadBuffer()
+            {
+                Registry & registry = getRegistry();
+                Buffer *buffer = new Buffer;
+
+                registry.lock();
+                buffer->initialize(registry.capacity_);
+                buffer->thread_id_ = static_cast<int>(registry.buffers_.size());
+                registry.buffers_.push_back(buffer);
+                registry.unlock();
+
+                getThreadBuffer() = buffer;
+                return (buffer);
+            }
+
+
+            static const char * getMagic()
+            {
+                return ("QPMADEVT");
+            }
+
+
+            static std::streamsize getMagicSize()
+            {
+                return (8);
+            }
+
+
+            static const char * getEventName(const int type)
+            {
+                switch (type)
+                {
+                    case SOLVE_BEGIN:
+                    case STATUS:
+                        return ("solve");
+                    case ITERATION_START:
+                        return ("iteration");
+                    case CONSTRAINT_CHOSEN:
+                        return ("constraint chosen");
+                    case PARTIAL_STEP:
+                        return ("partial step");
+                    case FULL_STEP:
+                        return ("full step");
+                    case DOWNDATE:
+                        return ("downdate");
+                    default:
+                        return ("unknown");
+                }
+            }
+
+
+            template<class t_Value>
+                static void writeValue(std::ostream & out, const t_Value & value)
+            {
+                out.write(reinterpret_cast<const char *>(&value), sizeof(t_Value));
+            }
+
+
+            template<class t_Value>
+                static bool readValue(std::istream & in, t_Value & value)
+            {
+                in.read(reinterpret_cast<char *>(&value), sizeof(t_Value));
+                return (in.good());
+            }
+    };
+}
@@ -0,0 +1,366 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "common.h"
+#include "constraint_status.h"
+#include "active_set.h"
+#include "factorization_data.h"
+
+
+namespace qpmad
+{
+    /**
+     * @brief LRU cache of factorizations (J and R) of optimal active sets.
+     *
+     * Entries are keyed by a hash of the set of (constraint index,
+     * constraint type) pairs. The solver looks up the active set selected
+     * by warm start or crash procedure and then tries a few most recently
+     * used entries, see SolverParameters::max_cache_candidates_. The
+     * minimizer subject to the active set of an entry is computed with
+     * the stored factorization and accepted if it is optimal, i.e.,
+     * primal and dual feasible; only then the factorization is copied to
+     * the solver. Otherwise the problem is solved as usual and its
+     * optimal active set is added to the cache.
+     *
+     * Each rejected entry costs O(n^2) operations for the minimizer and
+     * O(n * m) for the check of m general constraints, i.e., a miss is
+     * comparable to a few iterations of the solver.
+     *
+     * The factorizations depend on the Hessian and the constraint matrix,
+     * the cache must be cleared when they change.
+     */
+    class FactorizationCache
+    {
+        public:
+            typedef std::pair<MatrixIndex, ConstraintStatus::Status>    ConstraintKey;
+
+            class Entry
+            {
+                public:
+                    /// sorted (index, type) pairs
+                    std::vector<ConstraintKey>              key_;
+                    std::size_t                             hash_;
+
+                    /// active set in the order of columns of R
+                    std::vector<MatrixIndex>                indices_;
+                    std::vector<ConstraintStatus::Status>   types_;
+                    MatrixIndex                             num_equalities_;
+
+                    QPMatrix                                J_;
+                    QPMatrix                                R_;
+
+
+                public:
+                    MatrixIndex getPrimalSize() const
+                    {
+                        return (J_.rows());
+                    }
+
+
+                    MatrixIndex getActiveSetSize() const
+                    {
+                        return (static_cast<MatrixIndex>(indices_.size()));
+                    }
+
+
+                    /**
+                     * @brief Minimizer of the objective subject to 'N^T * x
+                     * = b' computed with the stored factorization, see
+                     * FactorizationData::computeActiveSetOptimum().
+                     */
+                    template<   class t_VectorType0,
+                                class t_VectorType1,
+                                class t_VectorType2,
+                                class t_VectorType3,
+                                class t_VectorType4>
+                        double computeActiveSetOptimum( t_VectorType0           & primal,
+                                                        t_VectorType1           & dual,
+                                                        t_VectorType2           & workspace,
+                                                        const t_VectorType3     & h,
+                                                        const t_VectorType4     & b) const
+                    {
+                        const MatrixIndex   size = getActiveSetSize();
+                        const MatrixIndex   num_free = getPrimalSize() - size;
+
+                        dual.head(size) = b.head(size);
+                        R_.transpose().triangularView<Eigen::Lower>().solveInPlace(dual.head(size));
+
+                        primal.noalias() = J_.leftCols(size) * dual.head(size);
+
+                        double objective = 0.5 * dual.head(size).squaredNorm();
+
+                        if (h.rows() > 0)
+                        {
+                            workspace.noalias() = J_.transpose() * h;
+
+                            primal.noalias() -= J_.rightCols(num_free) * workspace.tail(num_free);
+
+                            objective +=    workspace.head(size).dot(dual.head(size))
+                                            - 0.5 * workspace.tail(num_free).squaredNorm();
+
+                            dual.head(size) += workspace.head(size);
+                        }
+                        dual.head(size) = - dual.head(size);
+
+                        R_.triangularView<Eigen::Upper>().solveInPlace(dual.head(size));
+                        return (objective);
+                    }
+
+
+                    /// Approximate memory usage in bytes
+                    std::size_t getSize() const
+                    {
+                        return (sizeof(Entry)
+                                + key_.size() * sizeof(ConstraintKey)
+                                + indices_.size() * (sizeof(MatrixIndex) + sizeof(ConstraintStatus::Status))
+                                + (J_.size() + R_.size()) * sizeof(double));
+                    }
+            };
+
+            typedef std::list<Entry>::iterator  iterator;
+
+
+        public:
+            /**
+             * @param[in] max_size memory bound in bytes
+             */
+            explicit FactorizationCache(const std::size_t max_size = 1024 * 1024)
+            {
+                max_size_ = max_size;
+                size_ = 0;
+                num_hits_ = 0;
+                num_misses_ = 0;
+            }
+
+
+            /// Remove all entries, counters are preserved.
+            void clear()
+            {
+                entries_.clear();
+                index_.clear();
+                size_ = 0;
+            }
+
+
+            void resetCounters()
+            {
+                num_hits_ = 0;
+                num_misses_ = 0;
+            }
+
+
+            /// Set the memory bound in bytes, evicting entries if necessary.
+            void setMaxSize(const std::size_t max_size)
+            {
+                max_size_ = max_size;
+                evict();
+            }
+
+
+            std::size_t getMaxSize() const
+            {
+                return (max_size_);
+            }
+
+
+            /// Memory used by the entries in bytes
+            std::size_t getSize() const
+            {
+                return (size_);
+            }
+
+
+            std::size_t getNumEntries() const
+            {
+                return (index_.size());
+            }
+
+
+            std::size_t getNumHits() const
+            {
+                return (num_hits_);
+            }
+
+
+            std::size_t getNumMisses() const
+            {
+                return (num_misses_);
+            }
+
+
+            /// Entries starting with the most recently used.
+            iterator begin()
+            {
+                return (entries_.begin());
+            }
+
+
+            iterator end()
+            {
+                return (entries_.end());
+            }
+
+
+            /**
+             * @brief Find the entry of an active set.
+             *
+             * @param[in,out] key (index, type) pairs of the active set, sorted
+             * in place
+             *
+             * @return the entry or end().
+             */
+            iterator find(std::vector<ConstraintKey> & key)
+            {
+                std::sort(key.begin(), key.end());
+
+                std::pair<Index::iterator, Index::iterator> range = index_.equal_range(computeHash(key));
+                for (Index::iterator it = range.first; it != range.second; ++it)
+                {
+                    if (it->second->key_ == key)
+                    {
+                        return (it->second);
+                    }
+                }
+                return (entries_.end());
+            }
+
+
+            /// Register a hit and mark the entry as the most recently used.
+            void hit(const iterator & entry)
+            {
+                ++num_hits_;
+                entries_.splice(entries_.begin(), entries_, entry);
+            }
+
+
+            void miss()
+            {
+                ++num_misses_;
+            }
+
+
+            /**
+             * @brief Add the current active set and its factorization,
+             * an existing entry with the same key is replaced.
+             */
+            void insert(const ActiveSet                     & active_set,
+                        const ConstraintStatus::Status      * constraints_status,
+                        const FactorizationData             & factorization_data)
+            {
+                Entry entry;
+
+                entry.indices_.resize(active_set.size_);
+                entry.types_.resize(active_set.size_);
+                entry.key_.resize(active_set.size_);
+                for (MatrixIndex i = 0; i < active_set.size_; ++i)
+                {
+                    entry.indices_[i] = active_set.getIndex(i);
+                    entry.types_[i] = constraints_status[entry.indices_[i]];
+                    entry.key_[i] = ConstraintKey(entry.indices_[i], entry.types_[i]);
+                }
+                std::sort(entry.key_.begin(), entry.key_.end());
+                entry.hash_ = computeHash(entry.key_);
+                entry.num_equalities_ = active_set.num_equalities_;
+                entry.J_ = factorization_data.QLi_aka_J;
+                factorization_data.getR(entry.R_, active_set.size_);
+
+                if (entry.getSize() > max_size_)
+                {
+                    return;
+                }
+
+
+                std::pair<Index::iterator, Index::iterator> range = index_.equal_range(entry.hash_);
+                for (Index::iterator it = range.first; it != range.second; ++it)
+                {
+                    if (it->second->key_ == entry.key_)
+                    {
+                        size_ -= it->second->getSize();
+                        entries_.erase(it->second);
+                        index_.erase(it);
+                        break;
+                    }
+                }
+
+                entries_.push_front(Entry());
+                entries_.front().key_.swap(entry.key_);
+                entries_.front().hash_ = entry.hash_;
+                entries_.front().indices_.swap(entry.indices_);
+                entries_.front().types_.swap(entry.types_);
+                entries_.front().num_equalities_ = entry.num_equalities_;
+                entries_.front().J_.swap(entry.J_);
+                entries_.front().R_.swap(entry.R_);
+
+                size_ += entries_.front().getSize();
+                index_.insert(std::make_pair(entries_.front().hash_, entries_.begin()));
+
+                evict();
+            }
+
+
+        private:
+            typedef std::multimap<std::size_t, std::list<Entry>::iterator>  Index;
+
+
+        private:
+            std::list<Entry>    entries_;
+            Index               index_;
+
+            std::size_t         max_size_;
+            std::size_t         size_;
+
+            std::size_t         num_hits_;
+            std::size_t         num_misses_;
+
+
+        private:
+            static std::size_t computeHash(const std::vector<ConstraintKey> & key)
+            {
+                // FNV-1a over the pairs
+                std::size_t hash = 2166136261u;
+                for (std::size_t i = 0; i < key.size(); ++i)
+                {
+                    hash = (hash ^ static_cast<std::size_t>(key[i].first)) * 16777619u;
+                    hash = (hash ^ static_cast<std::size_t>(key[i].second)) * 16777619u;
+                }
+                return (hash);
+            }
+
+
+            void evict()
+            {
+                while ((size_ > max_size_) && (false == entries_.empty()))
+                {
+                    std::list<Entry>::iterator last = --entries_.end();
+
+                    std::pair<Index::iterator, Index::iterator> range = index_.equal_range(last->hash_);
+                    for (Index::iterator it = range.first; it != range.second; ++it)
+                    {
+                        if (it->second == last)
+                        {
+                            index_.erase(it);
+                            break;
+                        }
+                    }
+
+                    size_ -= last->getSize();
+                    entries_.erase(last);
+                }
+            }
+    };
+}
@@ -10,43 +10,102 @@
 
 #pragma once
 
+#include <Eigen/Householder>
+
 
 namespace qpmad
 {
     class FactorizationData
     {
         public:
-            QPMatrix    QLi_aka_J;
-            QPMatrix    R;
+            QPMatrixMap QLi_aka_J;
+            /// Only the leading active set block of R is stored, the
+            /// column, which is being added, is kept in 'd'.
+            QPMatrixMap R;
+            QPVectorMap d;
             MatrixIndex primal_size_;
+            /// number of updates and downdates since initialization, used
+            /// to schedule drift checks
+            int         num_updates_;
 
 
         public:
-            template <class t_MatrixType>
-                void initialize(const t_MatrixType &H,
-                                const MatrixIndex primal_size)
+            FactorizationData() : QLi_aka_J(NULL, 0, 0), R(NULL, 0, 0), d(NULL, 0)
+            {
+                primal_size_ = 0;
+                num_updates_ = 0;
+            }
+
+
+            static std::size_t getWorkspaceSize(const MatrixIndex primal_size,
+                                                const MatrixIndex max_active_set_size)
+            {
+                return (Workspace::getChunkSize<double>(primal_size * primal_size)
+                        + Workspace::getChunkSize<double>(max_active_set_size * max_active_set_size)
+                        + Workspace::getChunkSize<double>(primal_size));
+            }
+
+
+            void mapWorkspace(  Workspace           & workspace,
+                                const MatrixIndex   primal_size,
+                                const MatrixIndex   max_active_set_size)
             {
                 primal_size_ = primal_size;
 
-                QLi_aka_J.resize(primal_size_, primal_size_);
-                QLi_aka_J.triangularView<Eigen::Lower>().setZero();
-                TriangularInversion::compute(QLi_aka_J, H);
+                new (&QLi_aka_J) QPMatrixMap(workspace.allocate<double>(primal_size_ * primal_size_), primal_size_, primal_size_);
+                new (&R) QPMatrixMap(   workspace.allocate<double>(max_active_set_size * max_active_set_size),
+                                        max_active_set_size,
+                                        max_active_set_size);
+                new (&d) QPVectorMap(workspace.allocate<double>(primal_size_), primal_size_);
+            }
+
 
-                R.resize(primal_size_, primal_size_);
+            template <class t_MatrixType>
+                void initialize(const t_MatrixType                  &H,
+                                const SolverParameters::HessianType hessian_type)
+            {
+                if (SolverParameters::HESSIAN_INVERTED_CHOLESKY_FACTOR == hessian_type)
+                {
+                    QLi_aka_J = H;
+                }
+                else
+                {
+                    QLi_aka_J.triangularView<Eigen::Lower>().setZero();
+                    TriangularInversion::compute(QLi_aka_J, H);
+                }
+                num_updates_ = 0;
+            }
+
+
+            /// Copy the leading 'size' x 'size' block of R.
+            void getR(QPMatrix & R_copy, const MatrixIndex size) const
+            {
+                R_copy = R.topLeftCorner(size, size);
+            }
+
+
+            /// Set the leading block of R, see getR().
+            void setR(const QPMatrix & R_copy)
+            {
+                R.topLeftCorner(R_copy.rows(), R_copy.cols()) = R_copy;
             }
 
 
             bool update(const MatrixIndex R_col,
                         const double tolerance)
             {
+                ++num_updates_;
+
                 GivensReflection    givens;
                 for (MatrixIndex i = primal_size_-1; i > R_col; --i)
                 {
-                    givens.computeAndApply(R(i-1, R_col), R(i, R_col), 0.0);
+                    givens.computeAndApply(d(i-1), d(i), 0.0);
                     givens.applyColumnWise(QLi_aka_J, 0, primal_size_, i-1, i);
                 }
 
-                if (std::abs(R(R_col, R_col)) < tolerance)
+                R.col(R_col).head(R_col + 1) = d.head(R_col + 1);
+
+                if (std::abs(d(R_col)) < tolerance)
                 {
                     return (false);
                 }
@@ -57,18 +116,72 @@ namespace qpmad
             }
 
 
+            /**
+             * @brief Add several constraints at once, see update().
+             *
+             * Projections J^T * N of signed normals of the constraints are
+             * given in the first 'num_cols' columns of 'projections'. Their
+             * trailing rows are reduced to triangular form by Householder
+             * reflections, which are also applied to J, i.e., the
+             * factorization is updated by a single QR decomposition
+             * instead of a sweep of Givens rotations per constraint.
+             *
+             * @return number of added constraints, which is smaller than
+             * 'num_cols' if a constraint is linearly dependent on the
+             * active constraints or the preceding columns.
+             */
+            MatrixIndex updateBlock(QPMatrixMap         & projections,
+                                    const MatrixIndex   R_col,
+                                    const MatrixIndex   num_cols,
+                                    const double        tolerance)
+            {
+                double tau;
+                double beta;
+
+                ++num_updates_;
+
+                for (MatrixIndex i = 0; i < num_cols; ++i)
+                {
+                    const MatrixIndex row = R_col + i;
+                    const MatrixIndex tail_size = primal_size_ - row;
+
+                    projections.col(i).tail(tail_size).makeHouseholderInPlace(tau, beta);
+                    if (std::abs(beta) < tolerance)
+                    {
+                        return (i);
+                    }
+
+                    R.col(row).head(row) = projections.col(i).head(row);
+                    R(row, row) = beta;
+
+                    // 'd' is used as a workspace
+                    projections.block(row, i + 1, tail_size, num_cols - i - 1).applyHouseholderOnTheLeft(
+                            projections.col(i).tail(tail_size - 1), tau, d.data());
+                    QLi_aka_J.rightCols(tail_size).applyHouseholderOnTheRight(
+                            projections.col(i).tail(tail_size - 1), tau, d.data());
+                }
+
+                return (num_cols);
+            }
+
+
+            /**
+             * @brief Remove a column from the factorization.
+             *
+             * The following columns of R are restored to triangular form
+             * by Givens rotations in place, which are also applied to J,
+             * and shifted to the left, so that R stays contiguous for the
+             * triangular solves.
+             */
             void downdate(  const MatrixIndex R_col_index,
                             const MatrixIndex R_cols,
                             const double tolerance)
             {
+                ++num_updates_;
+
                 GivensReflection    givens;
                 for (MatrixIndex i = R_col_index + 1; i < R_cols; ++i)
                 {
-                    Eigen::MatrixXd tmp = R.block(0,
-                                0,
-                                R_cols,
-                                R_cols).triangularView<Eigen::Upper>();
-
                     givens.computeAndApply(R(i-1, i), R(i, i), 0.0);
                     givens.applyColumnWise(QLi_aka_J, 0, primal_size_, i-1, i);
                     givens.applyRowWise(R, i+1, R_cols, i-1, i);
@@ -86,47 +199,133 @@ namespace qpmad
                                                 const t_RowVectorType   & ctr,
                                                 const MatrixIndex       active_set_size)
             {
-                // vector 'd'
-                R.col(active_set_size).noalias() = QLi_aka_J.transpose() * ctr.transpose();
+                computeProjectionAndPrimalStep(step_direction, ctr, 1.0, active_set_size);
+            }
+
+
+            template<class t_VectorType>
+                void computeEqualityPrimalStep( t_VectorType            & step_direction,
+                                                const MatrixIndex       simple_bound_index,
+                                                const MatrixIndex       active_set_size)
+            {
+                d = QLi_aka_J.row(simple_bound_index).transpose();
 
-                step_direction.noalias() =
-                    - QLi_aka_J.rightCols(primal_size_ - active_set_size)
-                    * R.col(active_set_size).tail(primal_size_ - active_set_size);
+                computePrimalStepDirection(step_direction, active_set_size);
             }
 
 
-            template<   class t_VectorType0,
-                        class t_VectorType1,
-                        class t_RowVectorType>
-                void computeInequalitySteps(t_VectorType0           & primal_step_direction,
-                                            t_VectorType1           & dual_step_direction,
-                                            const t_RowVectorType   & ctr,
-                                            const ConstraintStatus::Status ctr_type,
-                                            const ActiveSet         &active_set)
+            /**
+             * @brief Store projection 'd' of the signed normal of an
+             * inequality constraint, the constraint is added to the
+             * factorization by a subsequent call to update().
+             */
+            template<class t_RowVectorType>
+                void projectInequality( const t_RowVectorType           & ctr,
+                                        const ConstraintStatus::Status  ctr_type)
             {
                 if (ConstraintStatus::ACTIVE_LOWER_BOUND == ctr_type)
                 {
-                    R.col(active_set.size_).noalias() =
-                        - QLi_aka_J.transpose() * ctr.transpose();
+                    d.noalias() = - QLi_aka_J.transpose() * ctr.transpose();
                 }
                 else
                 {
-                    R.col(active_set.size_).noalias() =
-                        QLi_aka_J.transpose() * ctr.transpose();
+                    d.noalias() = QLi_aka_J.transpose() * ctr.transpose();
+                }
+            }
+
+
+            void projectInequality( const MatrixIndex               simple_bound_index,
+                                    const ConstraintStatus::Status  ctr_type)
+            {
+                if (ConstraintStatus::ACTIVE_LOWER_BOUND == ctr_type)
+                {
+                    d = - QLi_aka_J.row(simple_bound_index).transpose();
+                }
+                else
+                {
+                    d = QLi_aka_J.row(simple_bound_index).transpose();
+                }
+            }
+
+
+            /**
+             * @brief Compute projection 'd = sign * J^T * ctr' and the
+             * primal step direction '-J_2 * d_2', where J_2 are the last
+             * 'primal_size_ - active_set_size' columns of J.
+             *
+             * Both products are computed in a single pass over J: columns
+             * of J_2 are processed in blocks of QPMAD_CACHE_BLOCK_SIZE
+             * bytes, which are still cached when they are used for the
+             * step direction. For large problems the products are limited
+             * by memory bandwidth, so this is faster than two separate
+             * products, see tests/factorization_data.cpp.
+             */
+            template<   class t_VectorType,
+                        class t_RowVectorType>
+                void computeProjectionAndPrimalStep(t_VectorType            & step_direction,
+                                                    const t_RowVectorType   & ctr,
+                                                    const double            sign,
+                                                    const MatrixIndex       active_set_size)
+            {
+                const MatrixIndex block_size = std::max(
+                        static_cast<MatrixIndex>(4),
+                        static_cast<MatrixIndex>(QPMAD_CACHE_BLOCK_SIZE / (sizeof(double) * primal_size_)));
+
+                d.head(active_set_size).noalias() =
+                    sign * (QLi_aka_J.leftCols(active_set_size).transpose() * ctr.transpose());
+
+                step_direction.setZero();
+                for (MatrixIndex i = active_set_size; i < primal_size_; i += block_size)
+                {
+                    const MatrixIndex cols = std::min(block_size, primal_size_ - i);
+
+                    d.segment(i, cols).noalias() = sign * (QLi_aka_J.middleCols(i, cols).transpose() * ctr.transpose());
+                    step_direction.noalias() -= QLi_aka_J.middleCols(i, cols) * d.segment(i, cols);
                 }
+            }
 
-                primal_step_direction.noalias() =
-                    - QLi_aka_J.rightCols(primal_size_ - active_set.size_)
-                    * R.col(active_set.size_).tail(primal_size_ - active_set.size_);
 
-                dual_step_direction.segment(active_set.num_equalities_, active_set.num_inequalities_).noalias() =
-                    - R.block(active_set.num_equalities_,
-                            active_set.num_equalities_,
-                            active_set.num_inequalities_,
-                            active_set.num_inequalities_).triangularView<Eigen::Upper>().solve(
-                                R.col(active_set.size_).segment(
-                                    active_set.num_equalities_,
-                                    active_set.num_inequalities_));
+            template<   class t_VectorType,
+                        class t_RowVectorType>
+                void projectInequalityAndComputePrimalStep( t_VectorType                    & step_direction,
+                                                            const t_RowVectorType           & ctr,
+                                                            const ConstraintStatus::Status  ctr_type,
+                                                            const MatrixIndex               active_set_size)
+            {
+                computeProjectionAndPrimalStep(
+                        step_direction,
+                        ctr,
+                        (ConstraintStatus::ACTIVE_LOWER_BOUND == ctr_type) ? -1.0 : 1.0,
+                        active_set_size);
+            }
+
+
+            template<class t_VectorType>
+                void projectInequalityAndComputePrimalStep( t_VectorType                    & step_direction,
+                                                            const MatrixIndex               simple_bound_index,
+                                                            const ConstraintStatus::Status  ctr_type,
+                                                            const MatrixIndex               active_set_size)
+            {
+                // the projection is a row of J, which is not streamed
+                projectInequality(simple_bound_index, ctr_type);
+                computePrimalStepDirection(step_direction, active_set_size);
+            }
+
+
+            template<   class t_VectorType0,
+                        class t_VectorType1,
+                        class t_Constraint>
+                void computeInequalitySteps(t_VectorType0           & primal_step_direction,
+                                            t_VectorType1           & dual_step_direction,
+                                            const t_Constraint      & ctr,
+                                            const ConstraintStatus::Status ctr_type,
+                                            const ActiveSet         &active_set)
+            {
+                projectInequalityAndComputePrimalStep(primal_step_direction, ctr, ctr_type, active_set.size_);
+
+                dual_step_direction.segment(active_set.num_equalities_, active_set.num_inequalities_) =
+                    - d.segment(active_set.num_equalities_, active_set.num_inequalities_);
+                solveDualStep(dual_step_direction, active_set);
             }
 
 
@@ -150,6 +349,108 @@ namespace qpmad
                         * ctr.transpose();
                 }
 
+                solveDualStep(dual_step_direction, active_set);
+            }
+
+
+            template<class t_VectorType>
+                void computeInequalityDualStep( t_VectorType            & dual_step_direction,
+                                                const MatrixIndex       simple_bound_index,
+                                                const ConstraintStatus::Status ctr_type,
+                                                const ActiveSet         & active_set)
+            {
+                if (ConstraintStatus::ACTIVE_LOWER_BOUND == ctr_type)
+                {
+                    dual_step_direction.segment(active_set.num_equalities_, active_set.num_inequalities_) =
+                        QLi_aka_J.row(simple_bound_index).tail(active_set.num_inequalities_).transpose();
+                }
+                else
+                {
+                    dual_step_direction.segment(active_set.num_equalities_, active_set.num_inequalities_) =
+                        - QLi_aka_J.row(simple_bound_index).tail(active_set.num_inequalities_).transpose();
+                }
+
+                solveDualStep(dual_step_direction, active_set);
+            }
+
+
+            /**
+             * @brief Compute minimizer of the objective subject to the
+             * active constraints treated as equalities and the
+             * corresponding Lagrange multipliers.
+             *
+             * Given signed normals N and right hand sides b of the active
+             * constraints, such that J^T * N = [R; 0], the minimizer is
+             * J1 * R^-T * b - J2 * J2^T * h and the multipliers are
+             * - R^-1 * (R^-T * b + J1^T * h). Since J^T * H * J = I, the
+             * objective is evaluated using the same vectors.
+             *
+             * @param[out] primal minimizer
+             * @param[out] dual multipliers, the first 'active_set_size' elements are set
+             * @param[out] workspace vector of size 'primal_size_'
+             * @param[in] h linear term of the objective (may be empty)
+             * @param[in] b right hand sides of the active constraints
+             * @param[in] active_set_size number of active constraints
+             *
+             * @return value of the objective at the minimizer
+             */
+            template<   class t_VectorType0,
+                        class t_VectorType1,
+                        class t_VectorType2,
+                        class t_VectorType3,
+                        class t_VectorType4>
+                double computeActiveSetOptimum( t_VectorType0           & primal,
+                                                t_VectorType1           & dual,
+                                                t_VectorType2           & workspace,
+                                                const t_VectorType3     & h,
+                                                const t_VectorType4     & b,
+                                                const MatrixIndex       active_set_size)
+            {
+                const MatrixIndex   num_free = primal_size_ - active_set_size;
+
+                dual.head(active_set_size) = b.head(active_set_size);
+                R.topLeftCorner(active_set_size, active_set_size).transpose().triangularView<Eigen::Lower>().solveInPlace(
+                        dual.head(active_set_size));
+
+                primal.noalias() = QLi_aka_J.leftCols(active_set_size) * dual.head(active_set_size);
+
+                // J^-1 * primal = [R^-T * b; - J2^T * h]
+                double objective = 0.5 * dual.head(active_set_size).squaredNorm();
+
+                if (h.rows() > 0)
+                {
+                    workspace.noalias() = QLi_aka_J.transpose() * h;
+
+                    primal.noalias() -= QLi_aka_J.rightCols(num_free) * workspace.tail(num_free);
+
+                    objective +=    workspace.head(active_set_size).dot(dual.head(active_set_size))
+                                    - 0.5 * workspace.tail(num_free).squaredNorm();
+
+                    dual.head(active_set_size) += workspace.head(active_set_size);
+                }
+                dual.head(active_set_size) = - dual.head(active_set_size);
+
+                R.topLeftCorner(active_set_size, active_set_size).triangularView<Eigen::Upper>().solveInPlace(
+                        dual.head(active_set_size));
+                return (objective);
+            }
+
+
+        private:
+            template<class t_VectorType>
+                void computePrimalStepDirection(t_VectorType            & step_direction,
+                                                const MatrixIndex       active_set_size)
+            {
+                step_direction.noalias() =
+                    - QLi_aka_J.rightCols(primal_size_ - active_set_size)
+                    * d.tail(primal_size_ - active_set_size);
+            }
+
+
+            template<class t_VectorType>
+                void solveDualStep( t_VectorType            & dual_step_direction,
+                                    const ActiveSet         & active_set)
+            {
                 R.block(active_set.num_equalities_,
                         active_set.num_equalities_,
                         active_set.num_inequalities_,
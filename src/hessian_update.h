@@ -0,0 +1,227 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#pragma once
+
+#include "common.h"
+#include "givens.h"
+
+
+namespace qpmad
+{
+    /**
+     * @brief Low-rank updates of factorizations of the Hessian
+     *
+     * Given a Hessian H = L * L^T, where L is the lower triangular Cholesky
+     * factor, and a factor J of its inverse, J * J^T = H^-1, compute the
+     * factors of
+     *
+     *  H + sum_i sigma_i * V.col(i) * V.col(i)^T
+     *
+     * in O(k * n^2) operations, which is cheaper than refactorization for
+     * a small number of columns k, e.g., BFGS updates (k = 2).
+     *
+     * L stays lower triangular with positive diagonal. J is not triangular
+     * after an update, which is fine for the solver: J is passed to it with
+     * SolverParameters::HESSIAN_INVERTED_CHOLESKY_FACTOR.
+     *
+     * Updates (sigma > 0) are applied before downdates (sigma < 0). Columns
+     * are applied one by one and a failure is detected only when it is
+     * reached, so the factors are partially updated if a downdate fails:
+     * the preceding columns are applied to both of them, and L may be
+     * downdated while J is not if the failure is due to rounding errors.
+     * The factors must be recomputed in this case.
+     */
+    class HessianUpdate
+    {
+        public:
+            /**
+             * @brief Rank-k update of both factors.
+             *
+             * @param[in,out] L Cholesky factor (lower triangular part)
+             * @param[in,out] J inverted factor
+             * @param[in] V n x k matrix of update vectors
+             * @param[in] sigma k weights of the update vectors
+             *
+             * @return false if the updated Hessian is not positive definite,
+             * the factors are partially updated in this case. Wrong sizes
+             * are reported in the same way with QPMAD_NO_EXCEPTIONS, the
+             * factors are not modified then.
+             */
+            template<   class t_L,
+                        class t_J,
+                        class t_V,
+                        class t_sigma>
+                bool update(Eigen::MatrixBase<t_L>          & L,
+                            Eigen::MatrixBase<t_J>          & J,
+                            const Eigen::MatrixBase<t_V>    & V,
+                            const Eigen::MatrixBase<t_sigma>& sigma)
+            {
+                QPMAD_CHECK(    (L.rows() == L.cols()) && (J.rows() == J.cols())
+                                && (L.rows() == J.rows()) && (L.rows() == V.rows()),
+                                false, "Wrong size of the factors or the update vectors.");
+                QPMAD_CHECK(sigma.size() == V.cols(), false, "Wrong number of update weights.");
+
+                for (MatrixIndex i = 0; i < V.cols(); ++i)
+                {
+                    if (sigma(i) > 0.0)
+                    {
+                        if ((false == updateCholeskyFactor(L, V.col(i), sigma(i)))
+                                || (false == updateInverseFactor(J, V.col(i), sigma(i))))
+                        {
+                            return (false);
+                        }
+                    }
+                }
+
+                for (MatrixIndex i = 0; i < V.cols(); ++i)
+                {
+                    if (sigma(i) < 0.0)
+                    {
+                        if ((false == updateCholeskyFactor(L, V.col(i), sigma(i)))
+                                || (false == updateInverseFactor(J, V.col(i), sigma(i))))
+                        {
+                            return (false);
+                        }
+                    }
+                }
+
+                return (true);
+            }
+
+
+            /**
+             * @brief Compute L * L^T + sigma * v * v^T using Givens
+             * reflections.
+             *
+             * An update is performed by zeroing elements of sqrt(sigma) * v
+             * against the diagonal of L. A downdate follows LINPACK: p is
+             * obtained from L * p = sqrt(-sigma) * v, then the reflections,
+             * which transform [p; sqrt(1 - p^T p)] to [0; 1], are applied
+             * to [L^T; 0].
+             *
+             * @return false if the downdated matrix is not positive
+             * definite or the sizes are wrong (with QPMAD_NO_EXCEPTIONS),
+             * L is not modified in this case.
+             */
+            template<   class t_L,
+                        class t_v>
+                bool updateCholeskyFactor(  Eigen::MatrixBase<t_L>          & L,
+                                            const Eigen::MatrixBase<t_v>    & v,
+                                            const double                    sigma)
+            {
+                const MatrixIndex   size = L.rows();
+                GivensReflection    givens;
+
+                QPMAD_CHECK((size == L.cols()) && (size == v.rows()), false, "Wrong size of the update vector.");
+
+                if (sigma > 0.0)
+                {
+                    work_.noalias() = std::sqrt(sigma) * v;
+
+                    for (MatrixIndex i = 0; i < size; ++i)
+                    {
+                        givens.computeAndApply(L(i, i), work_(i), 0.0);
+                        for (MatrixIndex k = i + 1; k < size; ++k)
+                        {
+                            givens.apply(L(k, i), work_(k));
+                        }
+                    }
+                }
+                else
+                {
+                    work_.noalias() = std::sqrt(-sigma) * v;
+                    L.template triangularView<Eigen::Lower>().solveInPlace(work_);
+
+                    double rho = 1.0 - work_.squaredNorm();
+                    if (rho <= 0.0)
+                    {
+                        return (false);
+                    }
+                    rho = std::sqrt(rho);
+
+                    // Elements of the last row of the transformed [L^T; 0]
+                    // are stored in place of the eliminated elements of p.
+                    for (MatrixIndex i = size - 1; i >= 0; --i)
+                    {
+                        givens.computeAndApply(rho, work_(i), 0.0);
+
+                        double last_row_i = 0.0;
+                        givens.apply(last_row_i, L(i, i));
+                        for (MatrixIndex k = i + 1; k < size; ++k)
+                        {
+                            givens.apply(work_(k), L(k, i));
+                        }
+                        work_(i) = last_row_i;
+                    }
+                }
+
+                // reflections may flip signs of the columns
+                for (MatrixIndex i = 0; i < size; ++i)
+                {
+                    if (L(i, i) < 0.0)
+                    {
+                        L.col(i).tail(size - i) = - L.col(i).tail(size - i);
+                    }
+                }
+
+                return (true);
+            }
+
+
+            /**
+             * @brief Compute a factor of (H + sigma * v * v^T)^-1 given
+             * J * J^T = H^-1.
+             *
+             * With w = J^T * v, (I + sigma * w * w^T)^-1 =
+             * (I + gamma * w * w^T)^2, where gamma = (1/sqrt(1 + sigma *
+             * w^T w) - 1) / (w^T w), so the new factor is J + gamma * (J *
+             * w) * w^T.
+             *
+             * @return false if the updated matrix is not positive definite
+             * or the sizes are wrong (with QPMAD_NO_EXCEPTIONS), J is not
+             * modified in this case.
+             */
+            template<   class t_J,
+                        class t_v>
+                bool updateInverseFactor(   Eigen::MatrixBase<t_J>          & J,
+                                            const Eigen::MatrixBase<t_v>    & v,
+                                            const double                    sigma)
+            {
+                QPMAD_CHECK(    (J.rows() == J.cols()) && (J.rows() == v.rows()),
+                                false, "Wrong size of the update vector.");
+
+                work_.noalias() = J.transpose() * v;
+
+                const double w_norm2 = work_.squaredNorm();
+                const double scale = 1.0 + sigma * w_norm2;
+
+                if (scale <= 0.0)
+                {
+                    return (false);
+                }
+
+                if (w_norm2 > 0.0)
+                {
+                    const double gamma = (1.0 / std::sqrt(scale) - 1.0) / w_norm2;
+
+                    Jw_.noalias() = J * work_;
+                    J.noalias() += gamma * Jw_ * work_.transpose();
+                }
+
+                return (true);
+            }
+
+
+        private:
+            QPVector    work_;
+            QPVector    Jw_;
+    };
+}
@@ -0,0 +1,215 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#pragma once
+
+#include <vector>
+
+#include "common.h"
+#include "solver.h"
+
+
+namespace qpmad
+{
+    /**
+     * @brief Solver of lexicographic hierarchies of QPs.
+     *
+     * Levels share the Hessian and the simple bounds, each level has its
+     * own linear term and adds general constraints. Constraints, which
+     * are active at the solution of a level, become equalities for all
+     * lower priority levels; inactive constraints remain inequalities.
+     *
+     * Levels are solved by Solver::resume(): the active set and the
+     * factorization are carried from one level to the next one, fixed
+     * constraints are not projected again, only the new constraints are
+     * added to the factorization.
+     */
+    class HierarchicalSolver
+    {
+        public:
+            typedef Solver::ReturnStatus    ReturnStatus;
+
+
+        public:
+            HierarchicalSolver()
+            {
+                num_levels_ = 0;
+                resumable_ = false;
+            }
+
+
+            /**
+             * @brief Solve the highest priority level, see
+             * Solver::solve(); the previous hierarchy is discarded.
+             *
+             * The input is copied, H is not modified.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    solve(  Eigen::MatrixBase<t_primal>     & primal,
+                                        const Eigen::MatrixBase<t_H>    & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_lb>   & lb,
+                                        const Eigen::MatrixBase<t_ub>   & ub,
+                                        const Eigen::MatrixBase<t_A>    & A,
+                                        const Eigen::MatrixBase<t_Alb>  & Alb,
+                                        const Eigen::MatrixBase<t_Aub>  & Aub,
+                                        const SolverParameters          & param)
+            {
+                num_levels_ = 0;
+                resumable_ = false;
+
+                H_ = H;
+                lb_ = lb;
+                ub_ = ub;
+                A_ = A;
+                Alb_ = Alb;
+                Aub_ = Aub;
+
+                const ReturnStatus status = solver_.solve(primal, H_, h, lb_, ub_, A_, Alb_, Aub_, param);
+                if (Solver::OK == status)
+                {
+                    num_levels_ = 1;
+                    resumable_ = true;
+                }
+
+                return (status);
+            }
+
+
+            /**
+             * @brief Solve the next level starting from the solution of
+             * the previous one.
+             *
+             * Constraints active at the previous solution are fixed, the
+             * general constraints 'Alb <= A * primal <= Aub' of the level
+             * are appended to the constraints of the previous levels.
+             * Constraints with equal bounds are activated as equalities.
+             * The parameters must be compatible with Solver::resume(),
+             * e.g., the maximal size of the active set must not change.
+             *
+             * If the level cannot be solved, primal is reset to the
+             * solution of the previous level and the hierarchy must be
+             * restarted with solve().
+             */
+            template<   class t_primal,
+                        class t_h,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    solveNextLevel( Eigen::MatrixBase<t_primal>     & primal,
+                                                const Eigen::MatrixBase<t_h>    & h,
+                                                const Eigen::MatrixBase<t_A>    & A,
+                                                const Eigen::MatrixBase<t_Alb>  & Alb,
+                                                const Eigen::MatrixBase<t_Aub>  & Aub,
+                                                const SolverParameters          & param)
+            {
+                QPMAD_CHECK(    resumable_,
+                                Solver::INVALID_INPUT, "The previous level is not solved.");
+                QPMAD_CHECK(    ((0 == A.rows()) || (A.cols() == H_.rows()))
+                                && (Alb.rows() == A.rows()) && (Aub.rows() == A.rows()),
+                                Solver::INVALID_INPUT, "Wrong size of constraints.");
+
+
+                solver_.fixActiveSet(lb_, ub_, Alb_, Aub_);
+
+                const MatrixIndex num_prev_constraints = A_.rows();
+                const MatrixIndex num_level_constraints = A.rows();
+
+                if (num_level_constraints > 0)
+                {
+                    A_.conservativeResize(num_prev_constraints + num_level_constraints, H_.rows());
+                    A_.bottomRows(num_level_constraints) = A;
+                    Alb_.conservativeResize(num_prev_constraints + num_level_constraints);
+                    Alb_.tail(num_level_constraints) = Alb;
+                    Aub_.conservativeResize(num_prev_constraints + num_level_constraints);
+                    Aub_.tail(num_level_constraints) = Aub;
+                }
+
+
+                primal_ = primal;
+                const ReturnStatus status = solver_.resume(
+                        primal, H_, h, lb_, ub_, A_, Alb_, Aub_, removed_constraints_, param);
+
+                if (Solver::OK == status)
+                {
+                    ++num_levels_;
+                }
+                else
+                {
+                    primal = primal_;
+                    resumable_ = false;
+                }
+
+                return (status);
+            }
+
+
+            /// Number of levels solved since the last call to solve().
+            MatrixIndex getNumLevels() const
+            {
+                return (num_levels_);
+            }
+
+
+            /**
+             * @brief Multipliers of the solution of the last level, see
+             * Solver::getDual(); general constraints of all levels are
+             * indexed in the order of levels.
+             */
+            template<class t_dual>
+                void getDual(Eigen::MatrixBase<t_dual> & dual) const
+            {
+                solver_.getDual(dual);
+            }
+
+
+            /// Value of the objective of the last solved level.
+            double getObjective() const
+            {
+                return (solver_.getObjective());
+            }
+
+
+        private:
+            Solver                      solver_;
+
+            MatrixIndex                 num_levels_;
+            bool                        resumable_;
+
+            /// Cholesky factor of the Hessian after the first level
+            QPMatrix                    H_;
+            /// bounds of fixed constraints are overwritten with their
+            /// active values
+            QPVector                    lb_;
+            QPVector                    ub_;
+            /// general constraints of all levels
+            QPRowMajorMatrix            A_;
+            QPVector                    Alb_;
+            QPVector                    Aub_;
+
+            /// primal solution of the previous level
+            QPVector                    primal_;
+
+            /// constraints are never removed, always empty
+            std::vector<MatrixIndex>    removed_constraints_;
+
+
+        private:
+            HierarchicalSolver(const HierarchicalSolver &);
+            HierarchicalSolver & operator=(const HierarchicalSolver &);
+    };
+}
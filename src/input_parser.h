@@ -12,6 +12,13 @@
 
 namespace qpmad
 {
+    /**
+     * @brief Sizes of the problem and validation of the input.
+     *
+     * Parsing functions return false if a check fails and exceptions
+     * are disabled (QPMAD_NO_EXCEPTIONS), checks are skipped if 'check'
+     * is false, see SolverParameters::check_input_.
+     */
     class InputParser
     {
         protected:
@@ -33,62 +40,78 @@ namespace qpmad
 
             template<   class t_DerivedH,
                         class t_Derivedh>
-                void    parseObjective( const Eigen::PlainObjectBase<t_DerivedH> & H,
-                                        const Eigen::PlainObjectBase<t_Derivedh> & h)
+                bool    parseObjective( const Eigen::MatrixBase<t_DerivedH> & H,
+                                        const Eigen::MatrixBase<t_Derivedh> & h,
+                                        const bool check)
             {
                 primal_size_ = H.rows();
                 h_size_ = h.rows();
 
-                QPMAD_ASSERT(   primal_size_ > 0,
-                                "Hessian must not be empty.");
-                QPMAD_ASSERT(   primal_size_ == H.cols(),
-                                "Hessian must be square.");
-                QPMAD_ASSERT(   ((primal_size_ == h_size_) && (1 == h.cols()))
-                                || (0 == h_size_),
-                                "Wrong size of h.");
+                if (check)
+                {
+                    QPMAD_CHECK(    primal_size_ > 0,
+                                    false, "Hessian must not be empty.");
+                    QPMAD_CHECK(    primal_size_ == H.cols(),
+                                    false, "Hessian must be square.");
+                    QPMAD_CHECK(    ((primal_size_ == h_size_) && (1 == h.cols()))
+                                    || (0 == h_size_),
+                                    false, "Wrong size of h.");
+                }
+                return (true);
             }
 
 
-            template<class t_Derived>
-                void    parseSimpleBounds(  const Eigen::PlainObjectBase<t_Derived> & lb,
-                                            const Eigen::PlainObjectBase<t_Derived> & ub)
+            template<   class t_Derivedlb,
+                        class t_Derivedub>
+                bool    parseSimpleBounds(  const Eigen::MatrixBase<t_Derivedlb> & lb,
+                                            const Eigen::MatrixBase<t_Derivedub> & ub,
+                                            const bool check)
             {
-                num_simple_bounds_ == lb.rows();
-
-                QPMAD_ASSERT(   (0 == num_simple_bounds_) || (primal_size_ == num_simple_bounds_),
-                                "Vector of lower simple bounds has wrong size.");
-                QPMAD_ASSERT(   ub.rows() == num_simple_bounds_,
-                                "Vector of upper simple bounds has wrong size.");
-
-                QPMAD_ASSERT(   ((num_simple_bounds_ > 0) && (1 == lb.cols())) || (0 == lb.cols()),
-                                "Vector of lower simple bounds has wrong size.");
-                QPMAD_ASSERT(   ((num_simple_bounds_ > 0) && (1 == ub.cols())) || (0 == ub.cols()),
-                                "Vector of upper simple bounds has wrong size.");
+                num_simple_bounds_ = lb.rows();
+
+                if (check)
+                {
+                    QPMAD_CHECK(    (0 == num_simple_bounds_) || (primal_size_ == num_simple_bounds_),
+                                    false, "Vector of lower simple bounds has wrong size.");
+                    QPMAD_CHECK(    ub.rows() == num_simple_bounds_,
+                                    false, "Vector of upper simple bounds has wrong size.");
+
+                    QPMAD_CHECK(    ((num_simple_bounds_ > 0) && (1 == lb.cols())) || (0 == lb.rows()),
+                                    false, "Vector of lower simple bounds has wrong size.");
+                    QPMAD_CHECK(    ((num_simple_bounds_ > 0) && (1 == ub.cols())) || (0 == ub.rows()),
+                                    false, "Vector of upper simple bounds has wrong size.");
+                }
+                return (true);
             }
 
 
             template<   class t_DerivedA,
                         class t_Derivedlb,
                         class t_Derivedub>
-                void    parseGeneralConstraints(const Eigen::PlainObjectBase<t_DerivedA> & A,
-                                                const Eigen::PlainObjectBase<t_Derivedlb> & lb,
-                                                const Eigen::PlainObjectBase<t_Derivedub> & ub)
+                bool    parseGeneralConstraints(const Eigen::MatrixBase<t_DerivedA> & A,
+                                                const Eigen::MatrixBase<t_Derivedlb> & lb,
+                                                const Eigen::MatrixBase<t_Derivedub> & ub,
+                                                const bool check)
             {
                 num_general_constraints_ = A.rows();
 
-                QPMAD_ASSERT(   (A.cols() == primal_size_)
-                                || ((0 == num_general_constraints_) && (0 == A.cols())),
-                                "Matrix of general constraints has wrong size.");
-
-                QPMAD_ASSERT(   lb.rows() == num_general_constraints_,
-                                "Vector of lower bounds of general constraints has wrong size.");
-                QPMAD_ASSERT(   ub.rows() == num_general_constraints_,
-                                "Vector of upper bounds of general constraints has wrong size.");
-
-                QPMAD_ASSERT(   ((num_general_constraints_ > 0) && (1 == lb.cols())) || (0 == lb.rows()),
-                                "Vector of lower bounds of general constraints has wrong size.");
-                QPMAD_ASSERT(   ((num_general_constraints_ > 0) && (1 == ub.cols())) || (0 == ub.rows()),
-                                "Vector of upper bounds of general constraints has wrong size.");
+                if (check)
+                {
+                    QPMAD_CHECK(    (A.cols() == primal_size_)
+                                    || ((0 == num_general_constraints_) && (0 == A.cols())),
+                                    false, "Matrix of general constraints has wrong size.");
+
+                    QPMAD_CHECK(    lb.rows() == num_general_constraints_,
+                                    false, "Vector of lower bounds of general constraints has wrong size.");
+                    QPMAD_CHECK(    ub.rows() == num_general_constraints_,
+                                    false, "Vector of upper bounds of general constraints has wrong size.");
+
+                    QPMAD_CHECK(    ((num_general_constraints_ > 0) && (1 == lb.cols())) || (0 == lb.rows()),
+                                    false, "Vector of lower bounds of general constraints has wrong size.");
+                    QPMAD_CHECK(    ((num_general_constraints_ > 0) && (1 == ub.cols())) || (0 == ub.rows()),
+                                    false, "Vector of upper bounds of general constraints has wrong size.");
+                }
+                return (true);
             }
     };
 }
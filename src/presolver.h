@@ -0,0 +1,620 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <limits>
+
+#include "common.h"
+#include "solver.h"
+
+
+namespace qpmad
+{
+    /**
+     * @brief Presolve stage, which reduces the problem before it is
+     * passed to the solver.
+     *
+     * - Variables fixed by equal simple bounds are substituted, which
+     *   requires the Hessian in the HESSIAN_LOWER_TRIANGULAR form, since
+     *   its factors cannot be reduced; otherwise they are kept.
+     * - Ranges of general constraints are computed from simple bounds:
+     *   constraints, which are implied by simple bounds, are dropped,
+     *   constraints, which cannot be satisfied, are reported as
+     *   infeasible without iterations.
+     * - Parallel rows of the constraint matrix are merged by intersecting
+     *   their bounds.
+     *
+     * The reduced solution and multipliers are mapped back to the
+     * original problem.
+     */
+    class Presolver
+    {
+        public:
+            typedef Solver::ReturnStatus    ReturnStatus;
+
+
+        public:
+            Presolver()
+            {
+                primal_size_ = 0;
+                num_simple_bounds_ = 0;
+                num_general_constraints_ = 0;
+                objective_offset_ = 0.0;
+            }
+
+
+            /**
+             * @brief Presolve the problem and solve the reduced problem
+             * with the given solver, see Solver::solve().
+             *
+             * H is not modified. Statuses INFEASIBLE_EQUALITY and
+             * INFEASIBLE_INEQUALITY may be returned by the presolve stage,
+             * inconsistent bounds are reported as by the solver. The
+             * solution is mapped back if the reduced problem is passed to
+             * the solver.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    solve(  Solver                          & solver,
+                                        Eigen::MatrixBase<t_primal>     & primal,
+                                        const Eigen::MatrixBase<t_H>    & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_lb>   & lb,
+                                        const Eigen::MatrixBase<t_ub>   & ub,
+                                        const Eigen::MatrixBase<t_A>    & A,
+                                        const Eigen::MatrixBase<t_Alb>  & Alb,
+                                        const Eigen::MatrixBase<t_Aub>  & Aub,
+                                        const SolverParameters          & param)
+            {
+                ReturnStatus status = presolve(H, h, lb, ub, A, Alb, Aub, param);
+                if (Solver::OK != status)
+                {
+                    return (status);
+                }
+
+
+                if (free_variables_.empty())
+                {
+                    // all variables are fixed
+                    primal.derived().resize(primal_size_);
+                    primal = fixed_primal_;
+                    return (Solver::OK);
+                }
+
+                status = solver.solve(reduced_primal_, H_, h_, lb_, ub_, A_, Alb_, Aub_, param);
+
+                primal.derived().resize(primal_size_);
+                primal = fixed_primal_;
+                if (reduced_primal_.rows() == static_cast<MatrixIndex>(free_variables_.size()))
+                {
+                    for (std::size_t i = 0; i < free_variables_.size(); ++i)
+                    {
+                        primal(free_variables_[i]) = reduced_primal_(i);
+                    }
+                }
+
+                return (status);
+            }
+
+
+            /**
+             * @brief Multipliers of the solution found by the last call to
+             * solve(), which must return OK, in the convention of
+             * Solver::getDual().
+             *
+             * Multipliers of dropped constraints are zero, multipliers of
+             * merged constraints are assigned to the constraints providing
+             * the active bounds, multipliers of fixed variables are
+             * recovered from the stationarity condition, which requires
+             * the original problem data.
+             */
+            template<   class t_dual,
+                        class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_A>
+                void getDual(   Eigen::MatrixBase<t_dual>           & dual,
+                                const Solver                        & solver,
+                                const Eigen::MatrixBase<t_primal>   & primal,
+                                const Eigen::MatrixBase<t_H>        & H,
+                                const Eigen::MatrixBase<t_h>        & h,
+                                const Eigen::MatrixBase<t_A>        & A) const
+            {
+                const MatrixIndex num_free = free_variables_.size();
+                const MatrixIndex num_reduced_simple_bounds = (num_simple_bounds_ > 0) ? num_free : 0;
+
+                dual.derived().resize(num_simple_bounds_ + num_general_constraints_);
+                dual.setZero();
+
+                if (num_free > 0)
+                {
+                    solver.getDual(reduced_dual_);
+
+                    for (MatrixIndex i = 0; i < num_reduced_simple_bounds; ++i)
+                    {
+                        dual(free_variables_[i]) = reduced_dual_(i);
+                    }
+
+                    for (std::size_t i = 0; i < kept_constraints_.size(); ++i)
+                    {
+                        const KeptConstraint & ctr = kept_constraints_[i];
+                        // multiplier of the normalized row
+                        const double normalized_dual = reduced_dual_(num_reduced_simple_bounds + i) * ctr.scale_;
+
+                        if (normalized_dual < 0.0)
+                        {
+                            dual(num_simple_bounds_ + ctr.lower_source_) = normalized_dual / ctr.lower_scale_;
+                        }
+                        if (normalized_dual > 0.0)
+                        {
+                            dual(num_simple_bounds_ + ctr.upper_source_) = normalized_dual / ctr.upper_scale_;
+                        }
+                    }
+                }
+
+
+                if (num_free < primal_size_)
+                {
+                    // H * primal + h + sum_i dual_i * a_i = 0
+                    QPVector gradient = H.template selfadjointView<Eigen::Lower>() * primal;
+                    if (h.rows() > 0)
+                    {
+                        gradient += h;
+                    }
+                    if (num_general_constraints_ > 0)
+                    {
+                        gradient.noalias() += A.transpose() * dual.tail(num_general_constraints_);
+                    }
+
+                    for (MatrixIndex i = 0; i < primal_size_; ++i)
+                    {
+                        if (is_fixed_[i])
+                        {
+                            dual(i) = - gradient(i);
+                        }
+                    }
+                }
+            }
+
+
+            /// Value of the objective of the original problem, see
+            /// Solver::getObjective().
+            double getObjective(const Solver & solver) const
+            {
+                if (free_variables_.empty())
+                {
+                    return (objective_offset_);
+                }
+                return (solver.getObjective() + objective_offset_);
+            }
+
+
+            /// Number of variables substituted by the last call to solve().
+            MatrixIndex getNumFixedVariables() const
+            {
+                return (primal_size_ - static_cast<MatrixIndex>(free_variables_.size()));
+            }
+
+
+            /// Number of general constraints dropped or merged by the last
+            /// call to solve().
+            MatrixIndex getNumRemovedConstraints() const
+            {
+                return (num_general_constraints_ - static_cast<MatrixIndex>(kept_constraints_.size()));
+            }
+
+
+        private:
+            /// General constraint of the reduced problem
+            class KeptConstraint
+            {
+                public:
+                    MatrixIndex     index_;
+                    /// the first nonzero coefficient of the reduced row
+                    double          scale_;
+
+                    /// bounds of the normalized row during presolve, then
+                    /// bounds in the scale of the row 'index_'
+                    double          lb_;
+                    double          ub_;
+
+                    /// constraints providing the bounds of the normalized
+                    /// row and the first nonzero coefficients of their rows
+                    MatrixIndex     lower_source_;
+                    double          lower_scale_;
+                    MatrixIndex     upper_source_;
+                    double          upper_scale_;
+
+                    /// key for detection of parallel rows
+                    double          key_;
+
+                public:
+                    static bool compareKeys(const KeptConstraint & left, const KeptConstraint & right)
+                    {
+                        return (    (left.key_ < right.key_)
+                                    || ((left.key_ == right.key_) && (left.index_ < right.index_)) );
+                    }
+
+                    static bool compareIndices(const KeptConstraint & left, const KeptConstraint & right)
+                    {
+                        return (left.index_ < right.index_);
+                    }
+            };
+
+
+        private:
+            MatrixIndex                 primal_size_;
+            MatrixIndex                 num_simple_bounds_;
+            MatrixIndex                 num_general_constraints_;
+
+            /// original indices of variables of the reduced problem
+            std::vector<MatrixIndex>    free_variables_;
+            std::vector<bool>           is_fixed_;
+            /// values of fixed variables, zeros for free variables
+            QPVector                    fixed_primal_;
+
+            std::vector<KeptConstraint> kept_constraints_;
+
+            /// objective at the fixed variables
+            double                      objective_offset_;
+
+            /// reduced problem
+            QPMatrix                    H_;
+            QPVector                    h_;
+            QPVector                    lb_;
+            QPVector                    ub_;
+            QPRowMajorMatrix            A_;
+            QPVector                    Alb_;
+            QPVector                    Aub_;
+
+            QPVector                    reduced_primal_;
+            mutable QPVector            reduced_dual_;
+
+
+        private:
+            Presolver(const Presolver &);
+            Presolver & operator=(const Presolver &);
+
+
+            template<   class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    presolve(   const Eigen::MatrixBase<t_H>    & H,
+                                            const Eigen::MatrixBase<t_h>    & h,
+                                            const Eigen::MatrixBase<t_lb>   & lb,
+                                            const Eigen::MatrixBase<t_ub>   & ub,
+                                            const Eigen::MatrixBase<t_A>    & A,
+                                            const Eigen::MatrixBase<t_Alb>  & Alb,
+                                            const Eigen::MatrixBase<t_Aub>  & Aub,
+                                            const SolverParameters          & param)
+            {
+                primal_size_ = H.rows();
+                num_simple_bounds_ = lb.rows();
+                num_general_constraints_ = A.rows();
+
+                if (param.check_input_)
+                {
+                    QPMAD_CHECK(    (primal_size_ > 0) && (H.cols() == primal_size_)
+                                    && ((0 == h.rows()) || (h.rows() == primal_size_))
+                                    && ((0 == num_simple_bounds_) || (num_simple_bounds_ == primal_size_))
+                                    && (ub.rows() == num_simple_bounds_)
+                                    && ((0 == num_general_constraints_) || (A.cols() == primal_size_))
+                                    && (Alb.rows() == num_general_constraints_)
+                                    && (Aub.rows() == num_general_constraints_),
+                                    Solver::INVALID_INPUT, "Wrong size of the input.");
+                }
+
+
+                // fixed variables
+                const bool substitute = (SolverParameters::HESSIAN_LOWER_TRIANGULAR == param.hessian_type_);
+
+                free_variables_.clear();
+                is_fixed_.assign(primal_size_, false);
+                fixed_primal_.setZero(primal_size_);
+                for (MatrixIndex i = 0; i < primal_size_; ++i)
+                {
+                    if (num_simple_bounds_ > 0)
+                    {
+                        QPMAD_CHECK(    lb(i) - param.tolerance_ <= ub(i),
+                                        Solver::INCONSISTENT_CONSTRAINTS, "Inconsistent constraints!");
+
+                        if (substitute && (std::abs(ub(i) - lb(i)) <= param.tolerance_))
+                        {
+                            is_fixed_[i] = true;
+                            fixed_primal_(i) = lb(i);
+                            continue;
+                        }
+                    }
+                    free_variables_.push_back(i);
+                }
+
+
+                // ranges of general constraints
+                kept_constraints_.clear();
+                for (MatrixIndex i = 0; i < num_general_constraints_; ++i)
+                {
+                    QPMAD_CHECK(    Alb(i) - param.tolerance_ <= Aub(i),
+                                    Solver::INCONSISTENT_CONSTRAINTS, "Inconsistent constraints!");
+
+                    KeptConstraint ctr;
+                    ctr.index_ = i;
+                    ctr.scale_ = 0.0;
+                    ctr.key_ = 0.0;
+
+                    double ctr_lb = Alb(i);
+                    double ctr_ub = Aub(i);
+                    double range_lb = 0.0;
+                    double range_ub = 0.0;
+
+                    for (MatrixIndex j = 0; j < primal_size_; ++j)
+                    {
+                        const double a_ij = A(i, j);
+
+                        if (0.0 != a_ij)
+                        {
+                            if (is_fixed_[j])
+                            {
+                                ctr_lb -= a_ij * fixed_primal_(j);
+                                ctr_ub -= a_ij * fixed_primal_(j);
+                            }
+                            else
+                            {
+                                if (0.0 == ctr.scale_)
+                                {
+                                    ctr.scale_ = a_ij;
+                                }
+                                // deterministic weights, equal keys are
+                                // unlikely for rows that are not parallel
+                                ctr.key_ += (a_ij / ctr.scale_) * (1.0 + 0.6180339887498949 * (j % 64));
+
+                                if (num_simple_bounds_ > 0)
+                                {
+                                    range_lb += a_ij * ((a_ij > 0.0) ? lb(j) : ub(j));
+                                    range_ub += a_ij * ((a_ij > 0.0) ? ub(j) : lb(j));
+                                }
+                                else
+                                {
+                                    range_lb = -std::numeric_limits<double>::infinity();
+                                    range_ub = std::numeric_limits<double>::infinity();
+                                }
+                            }
+                        }
+                    }
+
+
+                    if ((range_ub < ctr_lb - param.tolerance_) || (range_lb > ctr_ub + param.tolerance_))
+                    {
+                        return (isEquality(ctr_lb, ctr_ub, param) ? Solver::INFEASIBLE_EQUALITY : Solver::INFEASIBLE_INEQUALITY);
+                    }
+
+                    if ((0.0 == ctr.scale_) || ((range_lb >= ctr_lb) && (range_ub <= ctr_ub)))
+                    {
+                        // implied by simple bounds or depends on fixed
+                        // variables only
+                        continue;
+                    }
+
+
+                    // bounds in the scale of the row, which is normalized
+                    // by its first nonzero coefficient
+                    if (ctr.scale_ > 0.0)
+                    {
+                        ctr.lb_ = ctr_lb / ctr.scale_;
+                        ctr.ub_ = ctr_ub / ctr.scale_;
+                    }
+                    else
+                    {
+                        ctr.lb_ = ctr_ub / ctr.scale_;
+                        ctr.ub_ = ctr_lb / ctr.scale_;
+                    }
+                    ctr.lower_source_ = ctr.upper_source_ = i;
+                    ctr.lower_scale_ = ctr.upper_scale_ = ctr.scale_;
+
+                    kept_constraints_.push_back(ctr);
+                }
+
+
+                mergeParallelConstraints(A, param);
+                for (std::size_t i = 0; i < kept_constraints_.size(); ++i)
+                {
+                    KeptConstraint & ctr = kept_constraints_[i];
+
+                    if (ctr.lb_ - param.tolerance_ > ctr.ub_)
+                    {
+                        return (isEquality(ctr.lb_, ctr.ub_, param) ? Solver::INFEASIBLE_EQUALITY : Solver::INFEASIBLE_INEQUALITY);
+                    }
+                    // back to the scale of the row
+                    const double normalized_lb = ctr.lb_;
+                    if (ctr.scale_ > 0.0)
+                    {
+                        ctr.lb_ = normalized_lb * ctr.scale_;
+                        ctr.ub_ = ctr.ub_ * ctr.scale_;
+                    }
+                    else
+                    {
+                        ctr.lb_ = ctr.ub_ * ctr.scale_;
+                        ctr.ub_ = normalized_lb * ctr.scale_;
+                    }
+                }
+
+
+                buildReducedProblem(H, h, lb, ub, A);
+
+                return (Solver::OK);
+            }
+
+
+            static bool isEquality(const double lb, const double ub, const SolverParameters & param)
+            {
+                return (std::abs(lb - ub) <= param.tolerance_);
+            }
+
+
+            /**
+             * @brief Merge constraints with parallel rows: rows are sorted
+             * by keys and rows with equal keys are compared with the first
+             * row of the group.
+             */
+            template<class t_A>
+                void mergeParallelConstraints(  const Eigen::MatrixBase<t_A>    & A,
+                                                const SolverParameters          & param)
+            {
+                if (kept_constraints_.size() < 2)
+                {
+                    return;
+                }
+
+                std::sort(kept_constraints_.begin(), kept_constraints_.end(), KeptConstraint::compareKeys);
+
+                std::size_t group = 0;
+                for (std::size_t i = 1; i < kept_constraints_.size(); ++i)
+                {
+                    KeptConstraint & leader = kept_constraints_[group];
+                    const KeptConstraint & ctr = kept_constraints_[i];
+
+                    if (    (std::abs(ctr.key_ - leader.key_) <= param.tolerance_ * (1.0 + std::abs(leader.key_)))
+                            && (isParallel(A, leader, ctr, param)))
+                    {
+                        if (ctr.lb_ > leader.lb_)
+                        {
+                            leader.lb_ = ctr.lb_;
+                            leader.lower_source_ = ctr.index_;
+                            leader.lower_scale_ = ctr.scale_;
+                        }
+                        if (ctr.ub_ < leader.ub_)
+                        {
+                            leader.ub_ = ctr.ub_;
+                            leader.upper_source_ = ctr.index_;
+                            leader.upper_scale_ = ctr.scale_;
+                        }
+                    }
+                    else
+                    {
+                        ++group;
+                        kept_constraints_[group] = ctr;
+                    }
+                }
+                kept_constraints_.resize(group + 1);
+
+                std::sort(kept_constraints_.begin(), kept_constraints_.end(), KeptConstraint::compareIndices);
+            }
+
+
+            template<class t_A>
+                bool isParallel(const Eigen::MatrixBase<t_A>    & A,
+                                const KeptConstraint            & left,
+                                const KeptConstraint            & right,
+                                const SolverParameters          & param) const
+            {
+                for (std::size_t j = 0; j < free_variables_.size(); ++j)
+                {
+                    const MatrixIndex column = free_variables_[j];
+
+                    if (std::abs(   A(left.index_, column) / left.scale_
+                                    - A(right.index_, column) / right.scale_) > param.tolerance_)
+                    {
+                        return (false);
+                    }
+                }
+                return (true);
+            }
+
+
+            template<   class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A>
+                void buildReducedProblem(   const Eigen::MatrixBase<t_H>    & H,
+                                            const Eigen::MatrixBase<t_h>    & h,
+                                            const Eigen::MatrixBase<t_lb>   & lb,
+                                            const Eigen::MatrixBase<t_ub>   & ub,
+                                            const Eigen::MatrixBase<t_A>    & A)
+            {
+                const MatrixIndex num_free = free_variables_.size();
+                const MatrixIndex num_kept = kept_constraints_.size();
+
+
+                objective_offset_ = 0.0;
+                if (num_free == primal_size_)
+                {
+                    H_ = H;
+                    h_ = h;
+                    lb_ = lb;
+                    ub_ = ub;
+                }
+                else
+                {
+                    // the lower triangular part is preserved by the
+                    // selection of rows and columns in increasing order
+                    H_.resize(num_free, num_free);
+                    for (MatrixIndex j = 0; j < num_free; ++j)
+                    {
+                        for (MatrixIndex i = j; i < num_free; ++i)
+                        {
+                            H_(i, j) = H(free_variables_[i], free_variables_[j]);
+                        }
+                    }
+
+                    // h_F + H_FX * x_X
+                    const QPVector gradient = H.template selfadjointView<Eigen::Lower>() * fixed_primal_;
+
+                    h_.resize(num_free);
+                    lb_.resize(num_free);
+                    ub_.resize(num_free);
+                    for (MatrixIndex i = 0; i < num_free; ++i)
+                    {
+                        h_(i) = gradient(free_variables_[i]);
+                        lb_(i) = lb(free_variables_[i]);
+                        ub_(i) = ub(free_variables_[i]);
+                    }
+                    objective_offset_ = 0.5 * fixed_primal_.dot(gradient);
+                    if (h.rows() > 0)
+                    {
+                        objective_offset_ += h.dot(fixed_primal_);
+                        for (MatrixIndex i = 0; i < num_free; ++i)
+                        {
+                            h_(i) += h(free_variables_[i]);
+                        }
+                    }
+                }
+
+
+                A_.resize(num_kept, num_free);
+                Alb_.resize(num_kept);
+                Aub_.resize(num_kept);
+                for (MatrixIndex i = 0; i < num_kept; ++i)
+                {
+                    const KeptConstraint & ctr = kept_constraints_[i];
+
+                    for (MatrixIndex j = 0; j < num_free; ++j)
+                    {
+                        A_(i, j) = A(ctr.index_, free_variables_[j]);
+                    }
+                    Alb_(i) = ctr.lb_;
+                    Aub_(i) = ctr.ub_;
+                }
+            }
+    };
+}
@@ -0,0 +1,259 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#include "qpmad_c.h"
+#include "solver.h"
+
+
+#if QPMAD_C_WORKSPACE_ALIGNMENT % QPMAD_WORKSPACE_ALIGNMENT != 0
+#   error "QPMAD_C_WORKSPACE_ALIGNMENT is incompatible with QPMAD_WORKSPACE_ALIGNMENT."
+#endif
+
+
+namespace
+{
+    /**
+     * @brief Placed at the beginning of the C workspace, followed by the
+     * workspace of the solver.
+     *
+     * Only the features of the solver, which keep all their data in the
+     * workspace, are exposed: soft constraints, the cutting-plane mode,
+     * block activation, parallel selection of constraints and
+     * sensitivities are not available via the C interface.
+     */
+    class CWorkspaceHeader
+    {
+        public:
+            /// marks initialized workspaces, see qpmad_init(), it is
+            /// checked only by qpmad_destroy() and qpmad_solve()
+            std::size_t     magic_;
+            qpmad::Solver   solver_;
+            int             primal_size_;
+            int             num_general_constraints_;
+            int             max_active_set_size_;
+
+
+        public:
+            static const std::size_t MAGIC = 0x716d6164;
+
+
+        public:
+            static std::size_t getSize()
+            {
+                return (qpmad::Workspace::getChunkSize<CWorkspaceHeader>(1));
+            }
+
+
+            /// NULL if the workspace is not initialized
+            static CWorkspaceHeader * get(void *workspace)
+            {
+                CWorkspaceHeader *header = static_cast<CWorkspaceHeader *>(workspace);
+
+                if ((NULL == header) || (MAGIC != header->magic_))
+                {
+                    return (NULL);
+                }
+                return (header);
+            }
+    };
+
+
+    typedef Eigen::Map<const qpmad::QPMatrix>   ConstMatrixMap;
+    typedef Eigen::Map<const qpmad::QPVector>   ConstVectorMap;
+
+
+    inline ConstVectorMap mapVector(const double *data, const int size)
+    {
+        return (ConstVectorMap(data, (NULL == data) ? 0 : size));
+    }
+
+
+    inline int convertStatus(const qpmad::Solver::ReturnStatus status)
+    {
+        switch (status)
+        {
+            case qpmad::Solver::INVALID_INPUT:
+                return (QPMAD_ERROR_INVALID_ARGUMENT);
+            case qpmad::Solver::WORKSPACE_TOO_SMALL:
+                return (QPMAD_ERROR_WORKSPACE);
+            case qpmad::Solver::INCONSISTENT_CONSTRAINTS:
+            case qpmad::Solver::NUMERICAL_FAILURE:
+                return (QPMAD_ERROR_FAILURE);
+            default:
+                return (status);
+        }
+    }
+}
+
+
+extern "C"
+{
+    void qpmad_get_default_parameters(qpmad_parameters *param)
+    {
+        if (NULL != param)
+        {
+            const qpmad::SolverParameters default_param;
+
+            param->hessian_type = default_param.hessian_type_;
+            param->tolerance = default_param.tolerance_;
+            param->max_iter = default_param.max_iter_;
+            param->warm_start = default_param.warm_start_;
+        }
+    }
+
+
+    size_t qpmad_get_workspace_size(const int primal_size,
+                                    const int num_general_constraints,
+                                    const int max_active_set_size)
+    {
+        if ((primal_size <= 0) || (num_general_constraints < 0))
+        {
+            return (0);
+        }
+
+        return (CWorkspaceHeader::getSize()
+                + qpmad::Solver::getWorkspaceSize(  primal_size,
+                                                    primal_size + num_general_constraints,
+                                                    max_active_set_size));
+    }
+
+
+    int qpmad_init( void *workspace,
+                    const size_t workspace_size,
+                    const int primal_size,
+                    const int num_general_constraints,
+                    const int max_active_set_size)
+    {
+        const size_t required_size = qpmad_get_workspace_size(primal_size, num_general_constraints, max_active_set_size);
+
+        if ((NULL == workspace) || (0 == required_size))
+        {
+            return (QPMAD_ERROR_INVALID_ARGUMENT);
+        }
+
+        if ((workspace_size < required_size)
+                || (0 != reinterpret_cast<std::size_t>(workspace) % QPMAD_C_WORKSPACE_ALIGNMENT))
+        {
+            return (QPMAD_ERROR_WORKSPACE);
+        }
+
+        // the block is not read: it may contain anything, including a
+        // stale header
+        CWorkspaceHeader *header = new (workspace) CWorkspaceHeader;
+
+        header->magic_ = CWorkspaceHeader::MAGIC;
+        header->primal_size_ = primal_size;
+        header->num_general_constraints_ = num_general_constraints;
+        header->max_active_set_size_ = max_active_set_size;
+
+        if (false == header->solver_.setWorkspace(
+                    static_cast<char *>(workspace) + CWorkspaceHeader::getSize(),
+                    workspace_size - CWorkspaceHeader::getSize()))
+        {
+            qpmad_destroy(workspace);
+            return (QPMAD_ERROR_WORKSPACE);
+        }
+
+        return (QPMAD_OK);
+    }
+
+
+    void qpmad_destroy(void *workspace)
+    {
+        CWorkspaceHeader *header = CWorkspaceHeader::get(workspace);
+
+        if (NULL != header)
+        {
+            header->magic_ = 0;
+            header->~CWorkspaceHeader();
+        }
+    }
+
+
+    int qpmad_solve(void *workspace,
+                    const int primal_size,
+                    const int num_general_constraints,
+                    double *primal,
+                    double *H,
+                    const double *h,
+                    const double *lb,
+                    const double *ub,
+                    const double *A,
+                    const double *Alb,
+                    const double *Aub,
+                    const qpmad_parameters *param)
+    {
+        CWorkspaceHeader *header = CWorkspaceHeader::get(workspace);
+
+        if ((NULL == header) || (NULL == primal) || (NULL == H))
+        {
+            return (QPMAD_ERROR_INVALID_ARGUMENT);
+        }
+
+        if ((primal_size <= 0)
+                || (primal_size > header->primal_size_)
+                || (num_general_constraints < 0)
+                || (num_general_constraints > header->num_general_constraints_)
+                || ((NULL == lb) != (NULL == ub))
+                || ((num_general_constraints > 0) && ((NULL == A) || (NULL == Alb) || (NULL == Aub))))
+        {
+            return (QPMAD_ERROR_INVALID_ARGUMENT);
+        }
+
+        qpmad::SolverParameters solver_param;
+        if (NULL != param)
+        {
+            switch (param->hessian_type)
+            {
+                case QPMAD_HESSIAN_LOWER_TRIANGULAR:
+                case QPMAD_HESSIAN_CHOLESKY_FACTOR:
+                case QPMAD_HESSIAN_INVERTED_CHOLESKY_FACTOR:
+                    break;
+                default:
+                    return (QPMAD_ERROR_INVALID_ARGUMENT);
+            }
+
+            solver_param.hessian_type_ = static_cast<qpmad::SolverParameters::HessianType>(param->hessian_type);
+            solver_param.tolerance_ = param->tolerance;
+            solver_param.max_iter_ = param->max_iter;
+            solver_param.warm_start_ = (0 != param->warm_start);
+        }
+        solver_param.max_active_set_size_ = header->max_active_set_size_;
+        // sizes of the maps are consistent by construction
+        solver_param.check_input_ = false;
+
+#ifndef QPMAD_NO_EXCEPTIONS
+        try
+#endif
+        {
+            Eigen::Map<qpmad::QPVector> primal_map(primal, primal_size);
+            Eigen::Map<qpmad::QPMatrix> H_map(H, primal_size, primal_size);
+
+            const int num_rows_A = (NULL == A) ? 0 : num_general_constraints;
+
+            return (convertStatus(header->solver_.solve(
+                        primal_map,
+                        H_map,
+                        mapVector(h, primal_size),
+                        mapVector(lb, primal_size),
+                        mapVector(ub, primal_size),
+                        ConstMatrixMap(A, num_rows_A, (0 == num_rows_A) ? 0 : primal_size),
+                        mapVector(Alb, num_rows_A),
+                        mapVector(Aub, num_rows_A),
+                        solver_param)));
+        }
+#ifndef QPMAD_NO_EXCEPTIONS
+        catch (...)
+        {
+            return (QPMAD_ERROR_FAILURE);
+        }
+#endif
+    }
+}
@@ -0,0 +1,166 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief C interface of the solver.
+
+    All memory used by the solver is provided by the caller: a workspace of
+    size qpmad_get_workspace_size() aligned to QPMAD_C_WORKSPACE_ALIGNMENT
+    bytes is initialized with qpmad_init(), passed to qpmad_solve() any
+    number of times, and released with qpmad_destroy(). No memory is
+    allocated and no exceptions are propagated by these functions; errors
+    are reported by negative return values.
+
+    Matrices are stored in column-major order without padding. Pointers to
+    optional inputs may be NULL.
+*/
+
+#ifndef H_QPMAD_C
+#define H_QPMAD_C
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#define QPMAD_C_WORKSPACE_ALIGNMENT     64
+
+
+    enum qpmad_return_status
+    {
+        QPMAD_OK = 0,
+        QPMAD_INFEASIBLE_EQUALITY = 1,
+        QPMAD_INFEASIBLE_INEQUALITY = 2,
+        QPMAD_MAXIMAL_NUMBER_OF_ITERATIONS = 3,
+        QPMAD_MAXIMAL_ACTIVE_SET_SIZE = 4,
+
+        QPMAD_ERROR_INVALID_ARGUMENT = -1,
+        QPMAD_ERROR_WORKSPACE = -2,
+        QPMAD_ERROR_FAILURE = -3
+    };
+
+
+    enum qpmad_hessian_type
+    {
+        QPMAD_HESSIAN_LOWER_TRIANGULAR = 1,
+        QPMAD_HESSIAN_CHOLESKY_FACTOR = 2,
+        QPMAD_HESSIAN_INVERTED_CHOLESKY_FACTOR = 3
+    };
+
+
+    typedef struct
+    {
+        /** qpmad_hessian_type */
+        int     hessian_type;
+        double  tolerance;
+        /** negative value = no limit */
+        int     max_iter;
+        /** nonzero = start from the active set of the previous solve */
+        int     warm_start;
+    } qpmad_parameters;
+
+
+    /**
+     * @brief Initialize parameters with default values.
+     */
+    void    qpmad_get_default_parameters(qpmad_parameters *param);
+
+
+    /**
+     * @brief Size of the workspace in bytes for problems with at most
+     * 'primal_size' variables and 'num_general_constraints' general
+     * constraints, simple bounds on all variables are accounted for.
+     * 'max_active_set_size' limits the number of active constraints,
+     * negative value means 'primal_size'.
+     *
+     * @return 0 if arguments are invalid.
+     */
+    size_t  qpmad_get_workspace_size(   const int primal_size,
+                                        const int num_general_constraints,
+                                        const int max_active_set_size);
+
+
+    /**
+     * @brief Initialize workspace.
+     *
+     * The content of the memory block is ignored and overwritten, an
+     * initialized workspace must be released with qpmad_destroy() before
+     * it is initialized again. The block is not modified if an error is
+     * returned due to wrong arguments or insufficient size.
+     *
+     * @param[in,out] workspace memory block aligned to
+     * QPMAD_C_WORKSPACE_ALIGNMENT bytes
+     * @param[in] workspace_size size of the block
+     * @param[in] primal_size maximal number of variables
+     * @param[in] num_general_constraints maximal number of general
+     * constraints
+     * @param[in] max_active_set_size maximal number of active
+     * constraints, negative value means 'primal_size'
+     *
+     * @return QPMAD_OK or an error code
+     */
+    int     qpmad_init( void *workspace,
+                        const size_t workspace_size,
+                        const int primal_size,
+                        const int num_general_constraints,
+                        const int max_active_set_size);
+
+
+    /**
+     * @brief Release a workspace initialized with qpmad_init(), the memory
+     * block itself is owned by the caller. Does nothing if the workspace
+     * is NULL or already released.
+     */
+    void    qpmad_destroy(void *workspace);
+
+
+    /**
+     * @brief Solve a QP
+     *
+     *  min 0.5 x^T H x + h^T x
+     *  s.t. lb <= x <= ub
+     *       Alb <= A x <= Aub
+     *
+     * @param[in,out] workspace workspace initialized with qpmad_init()
+     * @param[in] primal_size number of variables
+     * @param[in] num_general_constraints number of rows in A
+     * @param[out] primal solution, 'primal_size' elements
+     * @param[in,out] H Hessian or its factor depending on parameters (see
+     * qpmad::SolverParameters::HessianType), the Hessian is overwritten
+     * with its Cholesky factor
+     * @param[in] h vector of the objective or NULL
+     * @param[in] lb lower simple bounds or NULL
+     * @param[in] ub upper simple bounds or NULL (lb and ub must be given
+     * together)
+     * @param[in] A matrix of general constraints or NULL
+     * @param[in] Alb lower bounds of general constraints or NULL
+     * @param[in] Aub upper bounds of general constraints or NULL
+     * @param[in] param parameters or NULL for default parameters,
+     * QPMAD_ERROR_INVALID_ARGUMENT is returned if the Hessian type is
+     * unknown
+     *
+     * @return qpmad_return_status
+     */
+    int     qpmad_solve(void *workspace,
+                        const int primal_size,
+                        const int num_general_constraints,
+                        double *primal,
+                        double *H,
+                        const double *h,
+                        const double *lb,
+                        const double *ub,
+                        const double *A,
+                        const double *Alb,
+                        const double *Aub,
+                        const qpmad_parameters *param);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,8 +12,11 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <limits>
 
 #include "common.h"
+#include "workspace.h"
 #include "cholesky.h"
 #include "givens.h"
 #include "input_parser.h"
@@ -22,11 +25,21 @@
 #include "constraint_status.h"
 #include "active_set.h"
 #include "factorization_data.h"
+#include "constraint_oracle.h"
+#include "factorization_cache.h"
+
+#ifdef QPMAD_USE_OPENMP
+#include <omp.h>
+#endif
 
 #ifdef QPMAD_ENABLE_TRACING
 #include "testing.h"
 #endif
 
+#ifdef QPMAD_ENABLE_EVENT_TRACE
+#include "event_trace.h"
+#endif
+
 namespace qpmad
 {
     class Solver : public InputParser
@@ -37,196 +50,3163 @@ namespace qpmad
                 OK = 0,
                 INFEASIBLE_EQUALITY = 1,
                 INFEASIBLE_INEQUALITY = 2,
-                MAXIMAL_NUMBER_OF_ITERATIONS = 3
+                MAXIMAL_NUMBER_OF_ITERATIONS = 3,
+                MAXIMAL_ACTIVE_SET_SIZE = 4,
+                /// Failures below are reported by exceptions unless the
+                /// solver is compiled with QPMAD_NO_EXCEPTIONS.
+                /// Wrong sizes of the input or malformed parameters.
+                INVALID_INPUT = 5,
+                /// Lower bound of a constraint exceeds its upper bound.
+                INCONSISTENT_CONSTRAINTS = 6,
+                /// External workspace is too small, see setWorkspace().
+                WORKSPACE_TOO_SMALL = 7,
+                /// Factorization update failed unexpectedly.
+                NUMERICAL_FAILURE = 8
+            };
+
+
+            /// Counters accumulated over calls to the solver
+            class Statistics
+            {
+                public:
+                    /// number of drift estimates, see
+                    /// SolverParameters::drift_check_period_
+                    std::size_t num_drift_checks_;
+                    /// number of recomputations of the factorization
+                    /// triggered by drift
+                    std::size_t num_refactorizations_;
+                    /// the largest drift estimate
+                    double      max_drift_;
+
+
+                public:
+                    Statistics()
+                    {
+                        reset();
+                    }
+
+
+                    void reset()
+                    {
+                        num_drift_checks_ = 0;
+                        num_refactorizations_ = 0;
+                        max_drift_ = 0.0;
+                    }
             };
 
 
         public:
-            ReturnStatus    solve(  QPVector     & primal,
-                                    QPMatrix     & H,
-                                    const QPVector & h,
-                                    const QPMatrix & A,
-                                    const QPVector & Alb,
-                                    const QPVector & Aub)
+            Solver() :  dual_(NULL, 0),
+                        primal_step_direction_(NULL, 0),
+                        dual_step_direction_(NULL, 0),
+                        general_ctr_dot_primal_(NULL, 0),
+                        oracle_constraints_(NULL, 0, 0),
+                        oracle_lb_(NULL, 0),
+                        oracle_ub_(NULL, 0),
+                        soft_constraint_weights_(NULL, 0),
+                        block_normals_(NULL, 0, 0),
+                        block_projections_(NULL, 0, 0),
+                        block_primal_(NULL, 0),
+                        block_dual_(NULL, 0)
             {
-                return (solve(primal, H, h, A, Alb, Aub, SolverParameters()));
+                machinery_initialized_ = false;
+                num_constraints_ = 0;
+                workspace_primal_size_ = 0;
+                workspace_num_constraints_ = 0;
+                workspace_max_active_set_size_ = 0;
+                constraints_status_ = NULL;
+                warm_start_indices_ = NULL;
+                warm_start_types_ = NULL;
+                num_warm_start_constraints_ = 0;
+                oracle_ = NULL;
+                factorization_cache_ = NULL;
+#ifdef QPMAD_USE_OPENMP
+                thread_chosen_ctr_ = NULL;
+#endif
+                block_candidates_ = NULL;
+                soft_constraints_ = false;
+                objective_ = std::numeric_limits<double>::quiet_NaN();
             }
 
 
-            ReturnStatus    solve(  QPVector     & primal,
-                                    QPMatrix     & H,
-                                    const QPVector & h,
-                                    const QPMatrix & A,
-                                    const QPVector & Alb,
-                                    const QPVector & Aub,
-                                    const SolverParameters & param)
+            /// Static description of a return status.
+            static const char * getStatusMessage(const ReturnStatus status)
             {
-                QPMAD_TRACE(std::setprecision(std::numeric_limits<double>::digits10));
+                switch (status)
+                {
+                    case OK:
+                        return ("Solution found.");
+                    case INFEASIBLE_EQUALITY:
+                        return ("Equality constraints are infeasible.");
+                    case INFEASIBLE_INEQUALITY:
+                        return ("Inequality constraints are infeasible.");
+                    case MAXIMAL_NUMBER_OF_ITERATIONS:
+                        return ("Maximal number of iterations is reached.");
+                    case MAXIMAL_ACTIVE_SET_SIZE:
+                        return ("Maximal size of the active set is reached.");
+                    case INVALID_INPUT:
+                        return ("Wrong size of the input or malformed solver parameters.");
+                    case INCONSISTENT_CONSTRAINTS:
+                        return ("Inconsistent constraints.");
+                    case WORKSPACE_TOO_SMALL:
+                        return ("Workspace is too small.");
+                    case NUMERICAL_FAILURE:
+                        return ("Failed to update the factorization.");
+                    default:
+                        return ("Unknown status.");
+                }
+            }
+
+
+            /**
+             * @brief Size of the memory block in bytes, which is required
+             * for the internal data of the solver.
+             *
+             * @param[in] primal_size number of variables
+             * @param[in] num_constraints total number of simple bounds and
+             * general constraints
+             * @param[in] max_active_set_size see
+             * SolverParameters::max_active_set_size_
+             */
+            static std::size_t getWorkspaceSize(const MatrixIndex primal_size,
+                                                const MatrixIndex num_constraints,
+                                                const MatrixIndex max_active_set_size = -1)
+            {
+                SolverParameters param;
+                param.max_active_set_size_ = max_active_set_size;
+
+                return (getWorkspaceSize(primal_size, num_constraints, param));
+            }
+
 
+            /**
+             * @brief Size of the memory block in bytes, which is required
+             * for the internal data of the solver given parameters passed
+             * to solve(), some of them require additional memory, e.g.,
+             * SolverParameters::num_threads_ and
+             * SolverParameters::max_block_size_.
+             */
+            static std::size_t getWorkspaceSize(const MatrixIndex           primal_size,
+                                                const MatrixIndex           num_constraints,
+                                                const SolverParameters      & param)
+            {
+                const MatrixIndex active_set_size = getMaxActiveSetSize(primal_size, param.max_active_set_size_);
+                const MatrixIndex block_size = getMaxBlockSize(active_set_size, param);
+
+                return (FactorizationData::getWorkspaceSize(primal_size, active_set_size)
+                        + ActiveSet::getWorkspaceSize(active_set_size)
+                        + 3 * Workspace::getChunkSize<double>(primal_size)
+                        + Workspace::getChunkSize<MatrixIndex>(active_set_size)
+                        + Workspace::getChunkSize<ConstraintStatus::Status>(active_set_size)
+                        + Workspace::getChunkSize<ConstraintStatus::Status>(num_constraints)
+                        + 2 * Workspace::getChunkSize<double>(num_constraints)
+#ifdef QPMAD_USE_OPENMP
+                        + Workspace::getChunkSize<ChosenConstraint>(getNumThreads(param))
+#endif
+                        + Workspace::getChunkSize<BlockCandidate>(block_size)
+                        + 2 * Workspace::getChunkSize<double>(primal_size * block_size)
+                        + Workspace::getChunkSize<double>((block_size > 0) ? primal_size : 0)
+                        + Workspace::getChunkSize<double>((block_size > 0) ? active_set_size : 0)
+                        );
+            }
+
+
+            /**
+             * @brief Size of the memory block in bytes, which is required
+             * by solve() in the cutting-plane mode, i.e., with a
+             * ConstraintOracle, including storage of generated constraints.
+             *
+             * @param[in] primal_size number of variables
+             * @param[in] num_simple_bounds number of simple bounds (0 or
+             * primal_size)
+             * @param[in] param parameters passed to solve()
+             */
+            static std::size_t getOracleWorkspaceSize(  const MatrixIndex           primal_size,
+                                                        const MatrixIndex           num_simple_bounds,
+                                                        const SolverParameters      & param)
+            {
+                const MatrixIndex num_slots = getNumOracleSlots(primal_size, param);
+
+                return (getWorkspaceSize(primal_size, num_simple_bounds + num_slots, param)
+                        + Workspace::getChunkSize<double>(primal_size * num_slots)
+                        + 2 * Workspace::getChunkSize<double>(num_slots));
+            }
+
+
+            /**
+             * @brief Use an external memory block for the internal data
+             * instead of allocating it on demand.
+             *
+             * The block must be aligned to QPMAD_WORKSPACE_ALIGNMENT bytes,
+             * its size must be at least getWorkspaceSize() for all problems
+             * and parameters used afterwards (getOracleWorkspaceSize() in
+             * the cutting-plane mode), and it must outlive the
+             * solver. No memory
+             * is allocated by solve() in this case.
+             *
+             * @return false if the block is not aligned.
+             */
+            bool setWorkspace(void *data, const std::size_t size)
+            {
                 machinery_initialized_ = false;
+                workspace_primal_size_ = 0;
+                workspace_num_constraints_ = 0;
+                workspace_max_active_set_size_ = 0;
+                return (workspace_.setExternal(data, size));
+            }
 
-                parseObjective(H, h);
-                parseGeneralConstraints(A, Alb, Aub);
 
+            /**
+             * @brief Attach a cache of factorizations of optimal active sets
+             * (NULL to detach), the cache is not owned by the solver.
+             *
+             * The cache is used by solve() only, it must be cleared when H
+             * or A change, and it is ignored in the cutting-plane mode.
+             */
+            void setFactorizationCache(FactorizationCache *cache)
+            {
+                factorization_cache_ = cache;
+            }
 
-                switch(param.hessian_type_)
+
+            /**
+             * @brief Value of the objective at the solution found by the
+             * last call to solve() or resume().
+             *
+             * The value is updated incrementally during iterations at a
+             * negligible cost. It is NaN after solving a problem with soft
+             * constraints, since penalties are not tracked, and if the
+             * primal method is terminated early.
+             */
+            double getObjective() const
+            {
+                return (objective_);
+            }
+
+
+            const Statistics & getStatistics() const
+            {
+                return (statistics_);
+            }
+
+
+            void resetStatistics()
+            {
+                statistics_.reset();
+            }
+
+
+            /**
+             * @brief Lagrange multipliers of the solution found by the last
+             * call to solve() or resume(), which must return OK.
+             *
+             * Multipliers are indexed in the same way as constraints, i.e.,
+             * simple bounds are followed by general constraints, and
+             * satisfy H * primal + h + sum_i dual_i * a_i = 0, where a_i is
+             * the normal of the i-th constraint: multipliers of active lower
+             * bounds are nonpositive, multipliers of active upper bounds are
+             * nonnegative, multipliers of inactive constraints are zero.
+             * Saturated soft constraints have multipliers equal to their
+             * weights with the corresponding sign. In the cutting-plane mode
+             * general constraints refer to the internal storage of
+             * generated constraints.
+             */
+            template<class t_dual>
+                void getDual(Eigen::MatrixBase<t_dual> & dual) const
+            {
+                dual.derived().resize(num_constraints_);
+                dual.setZero();
+
+                if (machinery_initialized_)
                 {
-                    case SolverParameters::HESSIAN_LOWER_TRIANGULAR:
-                        CholeskyFactorization::compute(H);
-                        // no break here!
-                    case SolverParameters::HESSIAN_CHOLESKY_FACTOR:
-                        break;
+                    for (MatrixIndex i = 0; i < active_set_.size_; ++i)
+                    {
+                        const MatrixIndex ctr_index = active_set_.getIndex(i);
 
-                    default:
-                        QPMAD_THROW("Malformed solver parameters!");
-                        break;
+                        if (ConstraintStatus::ACTIVE_LOWER_BOUND == constraints_status_[ctr_index])
+                        {
+                            dual(ctr_index) = - dual_(i);
+                        }
+                        else
+                        {
+                            dual(ctr_index) = dual_(i);
+                        }
+                    }
+
+                    for (MatrixIndex i = num_simple_bounds_; i < num_constraints_; ++i)
+                    {
+                        const double force = getSaturatedConstraintForce(i);
+                        if (0.0 != force)
+                        {
+                            dual(i) = force;
+                        }
+                    }
                 }
+            }
 
 
-                // Unconstrained optimum
-                if (h_size_ > 0)
+            /**
+             * @brief Compute residuals of the solution found by the last call
+             * to solve() or resume(), which must return OK, the problem data
+             * must be the same.
+             *
+             * The cost is comparable to a single iteration: H is not used,
+             * since the factorization of its inverse is available.
+             *
+             * @param[in] primal solution
+             * @param[out] primal_residual the largest violation of
+             * constraints, violations of saturated soft constraints are
+             * ignored.
+             * @param[out] dual_residual infinity norm of primal + H^-1 * (h
+             * + sum_i dual_i * a_i), i.e., the distance to the minimizer of
+             * the Lagrangian given multipliers, see getDual(). Signs of the
+             * multipliers are enforced by the solver.
+             *
+             * @return INVALID_INPUT if the problem does not match the last
+             * solution and exceptions are disabled, OK otherwise.
+             */
+            template<   class t_primal,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus computeResiduals(  const Eigen::MatrixBase<t_primal>   & primal,
+                                                const Eigen::MatrixBase<t_h>        & h,
+                                                const Eigen::MatrixBase<t_lb>       & lb,
+                                                const Eigen::MatrixBase<t_ub>       & ub,
+                                                const Eigen::MatrixBase<t_A>        & A,
+                                                const Eigen::MatrixBase<t_Alb>      & Alb,
+                                                const Eigen::MatrixBase<t_Aub>      & Aub,
+                                                double                              & primal_residual,
+                                                double                              & dual_residual)
+            {
+                QPMAD_CHECK(    (primal.rows() == primal_size_)
+                                && (h.rows() == h_size_)
+                                && (lb.rows() == num_simple_bounds_)
+                                && (A.rows() == num_general_constraints_),
+                                INVALID_INPUT, "The problem does not match the last solution.");
+
+
+                primal_residual = 0.0;
+
+                if (num_general_constraints_ > 0)
                 {
-                    CholeskyFactorization::solve(primal, H, -h);
+                    general_ctr_dot_primal_.noalias() = A * primal;
                 }
-                else
+
+                for (MatrixIndex i = 0; i < num_constraints_; ++i)
                 {
-                    primal.setZero(primal_size_);
+                    if (    (ConstraintStatus::SATURATED_LOWER_BOUND != constraints_status_[i])
+                            && (ConstraintStatus::SATURATED_UPPER_BOUND != constraints_status_[i]) )
+                    {
+                        const double ctr_i_dot_primal = (i < num_simple_bounds_)
+                                                        ? primal(i)
+                                                        : general_ctr_dot_primal_(i - num_simple_bounds_);
+
+                        primal_residual = std::max(primal_residual, getLowerBound(lb, Alb, i) - ctr_i_dot_primal);
+                        primal_residual = std::max(primal_residual, ctr_i_dot_primal - getUpperBound(ub, Aub, i));
+                    }
                 }
 
-                if (0 == num_simple_bounds_ + num_general_constraints_)
+
+                // the unconstrained minimizer is computed directly
+                dual_residual = 0.0;
+
+                if (machinery_initialized_)
                 {
-                    // exit early -- avoid unnecessary memory allocations
+                    if (h_size_ > 0)
+                    {
+                        dual_step_direction_ = h;
+                    }
+                    else
+                    {
+                        dual_step_direction_.setZero();
+                    }
+
+                    for (MatrixIndex i = 0; i < active_set_.size_; ++i)
+                    {
+                        const MatrixIndex ctr_index = active_set_.getIndex(i);
+
+                        if (ConstraintStatus::ACTIVE_LOWER_BOUND == constraints_status_[ctr_index])
+                        {
+                            addConstraintNormal(dual_step_direction_, A, ctr_index, - dual_(i));
+                        }
+                        else
+                        {
+                            addConstraintNormal(dual_step_direction_, A, ctr_index, dual_(i));
+                        }
+                    }
+
+                    for (MatrixIndex i = num_simple_bounds_; i < num_constraints_; ++i)
+                    {
+                        const double force = getSaturatedConstraintForce(i);
+                        if (0.0 != force)
+                        {
+                            addConstraintNormal(dual_step_direction_, A, i, force);
+                        }
+                    }
+
+                    factorization_data_.d.noalias() = factorization_data_.QLi_aka_J.transpose() * dual_step_direction_;
+                    primal_step_direction_ = primal;
+                    primal_step_direction_.noalias() += factorization_data_.QLi_aka_J * factorization_data_.d;
+
+                    dual_residual = primal_step_direction_.lpNorm<Eigen::Infinity>();
+                }
+
+                return (OK);
+            }
+
+
+            /**
+             * @brief Forward sensitivities of the solution found by the last
+             * call to solve() or resume(), which must return OK.
+             *
+             * Derivatives of the primal and dual solutions are computed for
+             * several directions of perturbation of the linear term and the
+             * bounds (columns of the input matrices) assuming that the
+             * active set does not change, i.e., they are exact if
+             * multipliers of active constraints are nonzero. The final
+             * factorization is reused: the cost is a few products with J
+             * and two triangular solves with R per direction.
+             *
+             * Perturbations of bounds are indexed in the same way as
+             * constraints, i.e., simple bounds are followed by general
+             * constraints. Perturbations of inactive bounds have no effect;
+             * equality constraints are perturbed via their lower bounds.
+             * Empty inputs correspond to zero perturbations.
+             *
+             * @param[out] primal_sensitivity derivatives of the primal
+             * solution
+             * @param[out] dual_sensitivity derivatives of multipliers in the
+             * convention of getDual()
+             * @param[in] H the matrix modified by solve(), see resume()
+             * @param[in] h_directions perturbations of the linear term
+             * @param[in] lower_directions perturbations of the lower bounds
+             * @param[in] upper_directions perturbations of the upper bounds
+             * @param[in] param parameters passed to solve()
+             */
+            template<   class t_primal_sensitivity,
+                        class t_dual_sensitivity,
+                        class t_H,
+                        class t_h_directions,
+                        class t_lower_directions,
+                        class t_upper_directions>
+                ReturnStatus computeSensitivities(  Eigen::MatrixBase<t_primal_sensitivity>         & primal_sensitivity,
+                                                    Eigen::MatrixBase<t_dual_sensitivity>           & dual_sensitivity,
+                                                    const Eigen::MatrixBase<t_H>                    & H,
+                                                    const Eigen::MatrixBase<t_h_directions>         & h_directions,
+                                                    const Eigen::MatrixBase<t_lower_directions>     & lower_directions,
+                                                    const Eigen::MatrixBase<t_upper_directions>     & upper_directions,
+                                                    const SolverParameters                          & param)
+            {
+                const MatrixIndex num_directions = std::max(h_directions.cols(),
+                                                            std::max(lower_directions.cols(), upper_directions.cols()));
+
+                QPMAD_CHECK(    ((0 == h_directions.rows()) || (h_directions.rows() == primal_size_))
+                                && ((0 == lower_directions.rows()) || (lower_directions.rows() == num_constraints_))
+                                && ((0 == upper_directions.rows()) || (upper_directions.rows() == num_constraints_)),
+                                INVALID_INPUT, "Wrong number of rows of directions.");
+                QPMAD_CHECK(    ((0 == h_directions.rows()) || (h_directions.cols() == num_directions))
+                                && ((0 == lower_directions.rows()) || (lower_directions.cols() == num_directions))
+                                && ((0 == upper_directions.rows()) || (upper_directions.cols() == num_directions)),
+                                INVALID_INPUT, "Wrong number of directions.");
+
+
+                dual_sensitivity.derived().resize(num_constraints_, num_directions);
+                dual_sensitivity.setZero();
+
+                if (false == machinery_initialized_)
+                {
+                    // no active constraints
+                    computeUnconstrainedSensitivity(primal_sensitivity, H, h_directions, num_directions, param);
+                    return (OK);
+                }
+
+
+                const MatrixIndex active_set_size = active_set_.size_;
+                const MatrixIndex num_free = primal_size_ - active_set_size;
+
+                // perturbations of right hand sides of active constraints
+                sensitivity_active_.setZero(active_set_size, num_directions);
+                for (MatrixIndex i = 0; i < active_set_size; ++i)
+                {
+                    const MatrixIndex ctr_index = active_set_.getIndex(i);
+
+                    switch (constraints_status_[ctr_index])
+                    {
+                        case ConstraintStatus::ACTIVE_UPPER_BOUND:
+                            if (upper_directions.rows() > 0)
+                            {
+                                sensitivity_active_.row(i) = upper_directions.row(ctr_index);
+                            }
+                            break;
+                        case ConstraintStatus::ACTIVE_LOWER_BOUND:
+                            if (lower_directions.rows() > 0)
+                            {
+                                sensitivity_active_.row(i) = - lower_directions.row(ctr_index);
+                            }
+                            break;
+                        default:
+                            if (lower_directions.rows() > 0)
+                            {
+                                sensitivity_active_.row(i) = lower_directions.row(ctr_index);
+                            }
+                            break;
+                    }
+                }
+
+                // see FactorizationData::computeActiveSetOptimum()
+                solveRInPlace(sensitivity_active_, true);
+                primal_sensitivity.derived().noalias() =
+                    factorization_data_.QLi_aka_J.leftCols(active_set_size) * sensitivity_active_;
+
+                if (h_directions.rows() > 0)
+                {
+                    sensitivity_projection_.noalias() = factorization_data_.QLi_aka_J.transpose() * h_directions;
+
+                    primal_sensitivity.noalias() -=
+                        factorization_data_.QLi_aka_J.rightCols(num_free) * sensitivity_projection_.bottomRows(num_free);
+                    sensitivity_active_ += sensitivity_projection_.topRows(active_set_size);
+                }
+                sensitivity_active_ = - sensitivity_active_;
+                solveRInPlace(sensitivity_active_, false);
+
+
+                for (MatrixIndex i = 0; i < active_set_size; ++i)
+                {
+                    const MatrixIndex ctr_index = active_set_.getIndex(i);
+
+                    if (ConstraintStatus::ACTIVE_LOWER_BOUND == constraints_status_[ctr_index])
+                    {
+                        dual_sensitivity.row(ctr_index) = - sensitivity_active_.row(i);
+                    }
+                    else
+                    {
+                        dual_sensitivity.row(ctr_index) = sensitivity_active_.row(i);
+                    }
+                }
+
+                return (OK);
+            }
+
+
+            /**
+             * @brief Adjoint sensitivities of the primal solution found by
+             * the last call to solve() or resume(), which must return OK.
+             *
+             * Products of the transposed Jacobians of the primal solution
+             * with respect to the linear term and the bounds with several
+             * vectors (columns of 'primal_gradients'), e.g., gradients of a
+             * loss with respect to the solution, see
+             * computeSensitivities() for conventions and assumptions.
+             * Gradients with respect to inactive bounds are zero, gradients
+             * with respect to equality constraints are stored in
+             * 'lower_gradients'.
+             *
+             * @param[out] h_gradients gradients with respect to the linear
+             * term
+             * @param[out] lower_gradients gradients with respect to the
+             * lower bounds
+             * @param[out] upper_gradients gradients with respect to the
+             * upper bounds
+             * @param[in] H the matrix modified by solve(), see resume()
+             * @param[in] primal_gradients
+             * @param[in] param parameters passed to solve()
+             */
+            template<   class t_h_gradients,
+                        class t_lower_gradients,
+                        class t_upper_gradients,
+                        class t_H,
+                        class t_primal_gradients>
+                ReturnStatus computeAdjointSensitivities(   Eigen::MatrixBase<t_h_gradients>            & h_gradients,
+                                                            Eigen::MatrixBase<t_lower_gradients>        & lower_gradients,
+                                                            Eigen::MatrixBase<t_upper_gradients>        & upper_gradients,
+                                                            const Eigen::MatrixBase<t_H>                & H,
+                                                            const Eigen::MatrixBase<t_primal_gradients> & primal_gradients,
+                                                            const SolverParameters                      & param)
+            {
+                const MatrixIndex num_directions = primal_gradients.cols();
+
+                QPMAD_CHECK(    primal_gradients.rows() == primal_size_,
+                                INVALID_INPUT, "Wrong number of rows of gradients.");
+
+
+                lower_gradients.derived().resize(num_constraints_, num_directions);
+                lower_gradients.setZero();
+                upper_gradients.derived().resize(num_constraints_, num_directions);
+                upper_gradients.setZero();
+
+                if (false == machinery_initialized_)
+                {
+                    // the Jacobian with respect to h is symmetric
+                    computeUnconstrainedSensitivity(h_gradients, H, primal_gradients, num_directions, param);
                     return (OK);
                 }
 
 
-
-                // check consistency of general constraints and activate
-                // equality constraints
-                general_constraints_status_.resize(num_general_constraints_);
-                MatrixIndex     num_general_equalities = 0;
-                for (MatrixIndex i = 0; i < num_general_constraints_; ++i)
+                const MatrixIndex active_set_size = active_set_.size_;
+                const MatrixIndex num_free = primal_size_ - active_set_size;
+
+                sensitivity_projection_.noalias() = factorization_data_.QLi_aka_J.transpose() * primal_gradients;
+
+                h_gradients.derived().noalias() =
+                    - factorization_data_.QLi_aka_J.rightCols(num_free) * sensitivity_projection_.bottomRows(num_free);
+
+                sensitivity_active_ = sensitivity_projection_.topRows(active_set_size);
+                solveRInPlace(sensitivity_active_, false);
+
+
+                for (MatrixIndex i = 0; i < active_set_size; ++i)
+                {
+                    const MatrixIndex ctr_index = active_set_.getIndex(i);
+
+                    switch (constraints_status_[ctr_index])
+                    {
+                        case ConstraintStatus::ACTIVE_UPPER_BOUND:
+                            upper_gradients.row(ctr_index) = sensitivity_active_.row(i);
+                            break;
+                        case ConstraintStatus::ACTIVE_LOWER_BOUND:
+                            lower_gradients.row(ctr_index) = - sensitivity_active_.row(i);
+                            break;
+                        default:
+                            lower_gradients.row(ctr_index) = sensitivity_active_.row(i);
+                            break;
+                    }
+                }
+
+                return (OK);
+            }
+
+
+            /**
+             * @brief Solve a QP.
+             *
+             * All inputs are accepted as arbitrary Eigen matrix expressions,
+             * e.g., plain matrices, Eigen::Map or Eigen::Ref objects with
+             * any storage order or stride, so that externally allocated
+             * memory can be used without copying. Note that H is
+             * overwritten with its Cholesky factor, and that the size of
+             * primal must match the size of H if it is not resizable.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    solve(  Eigen::MatrixBase<t_primal>     & primal,
+                                        Eigen::MatrixBase<t_H>          & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_A>    & A,
+                                        const Eigen::MatrixBase<t_Alb>  & Alb,
+                                        const Eigen::MatrixBase<t_Aub>  & Aub)
+            {
+                return (solve(primal, H, h, A, Alb, Aub, SolverParameters()));
+            }
+
+
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    solve(  Eigen::MatrixBase<t_primal>     & primal,
+                                        Eigen::MatrixBase<t_H>          & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_A>    & A,
+                                        const Eigen::MatrixBase<t_Alb>  & Alb,
+                                        const Eigen::MatrixBase<t_Aub>  & Aub,
+                                        const SolverParameters & param)
+            {
+                return (solve(primal, H, h, QPVector(), QPVector(), A, Alb, Aub, param));
+            }
+
+
+            /**
+             * @brief Solve a QP with simple bounds 'lb <= primal <= ub'
+             * only.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub>
+                ReturnStatus    solve(  Eigen::MatrixBase<t_primal>     & primal,
+                                        Eigen::MatrixBase<t_H>          & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_lb>   & lb,
+                                        const Eigen::MatrixBase<t_ub>   & ub,
+                                        const SolverParameters & param)
+            {
+                return (solve(primal, H, h, lb, ub, QPMatrix(), QPVector(), QPVector(), param));
+            }
+
+
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    solve(  Eigen::MatrixBase<t_primal>     & primal,
+                                        Eigen::MatrixBase<t_H>          & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_lb>   & lb,
+                                        const Eigen::MatrixBase<t_ub>   & ub,
+                                        const Eigen::MatrixBase<t_A>    & A,
+                                        const Eigen::MatrixBase<t_Alb>  & Alb,
+                                        const Eigen::MatrixBase<t_Aub>  & Aub)
+            {
+                return (solve(primal, H, h, lb, ub, A, Alb, Aub, SolverParameters()));
+            }
+
+
+            /**
+             * @brief Solve a QP with simple bounds 'lb <= primal <= ub' and
+             * general constraints 'Alb <= A * primal <= Aub'.
+             *
+             * Simple bounds are handled natively without forming the
+             * corresponding rows of the constraint matrix, either pair of
+             * bounds may be empty. Constraints are indexed starting with
+             * simple bounds followed by general constraints.
+             *
+             * Rows of A are accessed individually, so it is preferable to
+             * store A in row-major order (QPRowMajorMatrix) or to pass a
+             * transposed column-major matrix, e.g., 'At.transpose()'.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    solve(  Eigen::MatrixBase<t_primal>     & primal,
+                                        Eigen::MatrixBase<t_H>          & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_lb>   & lb,
+                                        const Eigen::MatrixBase<t_ub>   & ub,
+                                        const Eigen::MatrixBase<t_A>    & A,
+                                        const Eigen::MatrixBase<t_Alb>  & Alb,
+                                        const Eigen::MatrixBase<t_Aub>  & Aub,
+                                        const SolverParameters & param)
+            {
+                QPMAD_TRACE_EVENT(SOLVE_BEGIN, H.rows(), A.rows());
+                // weights are not used
+                const ReturnStatus status = solveProblem(primal, H, h, lb, ub, A, Alb, Aub, QPVector(), param);
+                QPMAD_TRACE_EVENT(STATUS, 0, status);
+                return (status);
+            }
+
+
+            /**
+             * @brief Solve a QP with soft general constraints.
+             *
+             * A general constraint with a finite nonnegative weight w_i is
+             * softened with an L1 penalty, i.e., the objective is augmented
+             * with w_i * max(0, Alb_i - A_i * primal, A_i * primal - Aub_i);
+             * infinite weights correspond to hard constraints. Slack
+             * variables are not introduced: the penalty bounds the Lagrange
+             * multiplier of the constraint by w_i, a constraint whose
+             * multiplier reaches its weight leaves the active set and its
+             * force is kept constant (saturated constraint), so the size of
+             * the factorization does not change. Constraints with equal
+             * bounds are always hard. Warm start, crash, block activation
+             * and the factorization cache are not used in this mode.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub,
+                        class t_weights>
+                ReturnStatus    solve(  Eigen::MatrixBase<t_primal>         & primal,
+                                        Eigen::MatrixBase<t_H>              & H,
+                                        const Eigen::MatrixBase<t_h>        & h,
+                                        const Eigen::MatrixBase<t_lb>       & lb,
+                                        const Eigen::MatrixBase<t_ub>       & ub,
+                                        const Eigen::MatrixBase<t_A>        & A,
+                                        const Eigen::MatrixBase<t_Alb>      & Alb,
+                                        const Eigen::MatrixBase<t_Aub>      & Aub,
+                                        const Eigen::MatrixBase<t_weights>  & weights,
+                                        const SolverParameters              & param)
+            {
+                if (param.check_input_)
+                {
+                    QPMAD_CHECK(    (weights.rows() == A.rows()) && ((0 == weights.rows()) || (1 == weights.cols())),
+                                    INVALID_INPUT, "Wrong size of the vector of weights.");
+                    QPMAD_CHECK(    (weights.array() >= 0.0).all(),
+                                    INVALID_INPUT, "Weights of soft constraints must be nonnegative.");
+                }
+
+                SolverParameters soft_param = param;
+                soft_param.warm_start_ = false;
+                soft_param.crash_ = false;
+                soft_param.method_ = SolverParameters::METHOD_DUAL;
+
+                soft_constraints_ = true;
+                ReturnStatus status;
+                QPMAD_TRACE_EVENT(SOLVE_BEGIN, H.rows(), A.rows());
+#ifdef QPMAD_NO_EXCEPTIONS
+                status = solveProblem(primal, H, h, lb, ub, A, Alb, Aub, weights, soft_param);
+#else
+                try
+                {
+                    status = solveProblem(primal, H, h, lb, ub, A, Alb, Aub, weights, soft_param);
+                }
+                catch (...)
+                {
+                    soft_constraints_ = false;
+                    throw;
+                }
+#endif
+                QPMAD_TRACE_EVENT(STATUS, 0, status);
+                soft_constraints_ = false;
+                // penalties are not tracked
+                objective_ = std::numeric_limits<double>::quiet_NaN();
+
+                return (status);
+            }
+
+
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    resume( Eigen::MatrixBase<t_primal>         & primal,
+                                        const Eigen::MatrixBase<t_H>        & H,
+                                        const Eigen::MatrixBase<t_h>        & h,
+                                        const Eigen::MatrixBase<t_A>        & A,
+                                        const Eigen::MatrixBase<t_Alb>      & Alb,
+                                        const Eigen::MatrixBase<t_Aub>      & Aub,
+                                        const std::vector<MatrixIndex>      & removed_constraints,
+                                        const SolverParameters              & param)
+            {
+                return (resume(primal, H, h, QPVector(), QPVector(), A, Alb, Aub, removed_constraints, param));
+            }
+
+
+            /**
+             * @brief Solve a modified version of the problem passed to the
+             * previous call of solve() or resume() starting from its
+             * solution.
+             *
+             * General constraints of the new problem are obtained from the
+             * previous ones by removing rows listed in
+             * 'removed_constraints' (sorted indices of rows in the
+             * previous 'A') and appending new rows at the end. Removed
+             * active constraints are dropped from the factorization, after
+             * which iterations are resumed with the current active set.
+             * The Hessian and the simple bounds must be the same, except
+             * for bounds fixed by fixActiveSet(), where 'H' is the matrix
+             * modified by solve(), i.e., the Cholesky factor unless the
+             * Hessian type is HESSIAN_INVERTED_CHOLESKY_FACTOR; the linear
+             * term 'h' may change. Appended constraints with equal bounds
+             * are activated as equalities if no inequalities are active,
+             * e.g., after fixActiveSet(), otherwise they are handled as
+             * inequalities.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    resume( Eigen::MatrixBase<t_primal>         & primal,
+                                        const Eigen::MatrixBase<t_H>        & H,
+                                        const Eigen::MatrixBase<t_h>        & h,
+                                        const Eigen::MatrixBase<t_lb>       & lb,
+                                        const Eigen::MatrixBase<t_ub>       & ub,
+                                        const Eigen::MatrixBase<t_A>        & A,
+                                        const Eigen::MatrixBase<t_Alb>      & Alb,
+                                        const Eigen::MatrixBase<t_Aub>      & Aub,
+                                        const std::vector<MatrixIndex>      & removed_constraints,
+                                        const SolverParameters              & param)
+            {
+                QPMAD_TRACE(std::setprecision(std::numeric_limits<double>::digits10));
+
+                const MatrixIndex   prev_primal_size = primal_size_;
+                const MatrixIndex   prev_num_simple_bounds = num_simple_bounds_;
+                const MatrixIndex   prev_num_general_constraints = num_general_constraints_;
+                const MatrixIndex   num_removed = removed_constraints.size();
+
+                if (false == parseProblem(H, h, lb, ub, A, Alb, Aub, param.check_input_))
+                {
+                    return (INVALID_INPUT);
+                }
+
+                QPMAD_CHECK(    (prev_primal_size == primal_size_) && (prev_num_simple_bounds == num_simple_bounds_),
+                                INVALID_INPUT, "The objective and simple bounds must not change between solve() and resume().");
+                QPMAD_CHECK(    num_general_constraints_ >= prev_num_general_constraints - num_removed,
+                                INVALID_INPUT, "Wrong number of general constraints.");
+                for (MatrixIndex i = 0; i < num_removed; ++i)
+                {
+                    QPMAD_CHECK(    (removed_constraints[i] >= 0)
+                                    && (removed_constraints[i] < prev_num_general_constraints)
+                                    && ((0 == i) || (removed_constraints[i-1] < removed_constraints[i])),
+                                    INVALID_INPUT, "Indices of removed constraints must be sorted, unique and valid.");
+                }
+
+
+                for (MatrixIndex i = num_simple_bounds_; i < num_constraints_; ++i)
+                {
+                    QPMAD_CHECK(    (ConstraintStatus::SATURATED_LOWER_BOUND != constraints_status_[i])
+                                    && (ConstraintStatus::SATURATED_UPPER_BOUND != constraints_status_[i]),
+                                    INVALID_INPUT, "resume() is not supported if soft constraints are saturated.");
+                }
+
+
+                SolverParameters resume_param = param;
+                if (SolverParameters::HESSIAN_LOWER_TRIANGULAR == resume_param.hessian_type_)
+                {
+                    // factorized by solve()
+                    resume_param.hessian_type_ = SolverParameters::HESSIAN_CHOLESKY_FACTOR;
+                }
+
+
+                // Offset of statuses in the workspace does not depend on the
+                // number of constraints and the content is preserved by
+                // remapping, so they can be updated in place after
+                // remapping even if the number of constraints is reduced.
+                const MatrixIndex prev_num_constraints = num_constraints_;
+                QPMAD_CHECK(    (0 == prev_num_constraints)
+                                || (getMaxActiveSetSize(primal_size_, param.max_active_set_size_) == workspace_max_active_set_size_),
+                                INVALID_INPUT, "The maximal size of the active set must not change between solve() and resume().");
+                num_constraints_ = num_simple_bounds_ + num_general_constraints_;
+                if (false == mapWorkspace(param))
+                {
+                    return (WORKSPACE_TOO_SMALL);
+                }
+                initializeMachineryLazy(H, resume_param.hessian_type_);
+
+
+                // drop removed constraints from the active set
+                for (MatrixIndex i = active_set_.size_ - 1; i >= 0; --i)
+                {
+                    const MatrixIndex ctr_index = active_set_.getIndex(i);
+
+                    if ((ctr_index >= num_simple_bounds_)
+                            && (std::binary_search( removed_constraints.begin(),
+                                                    removed_constraints.end(),
+                                                    ctr_index - num_simple_bounds_)))
+                    {
+                        QPMAD_TRACE("||| Remove active constraint " << ctr_index);
+                        factorization_data_.downdate(i, active_set_.size_, resume_param.tolerance_);
+                        if (i < active_set_.num_equalities_)
+                        {
+                            active_set_.removeEquality(i);
+                        }
+                        else
+                        {
+                            active_set_.removeInequality(i);
+                        }
+                    }
+                }
+
+                // update indices of the remaining constraints
+                for (MatrixIndex i = 0; i < active_set_.size_; ++i)
+                {
+                    const MatrixIndex ctr_index = active_set_.getIndex(i);
+
+                    if (ctr_index >= num_simple_bounds_)
+                    {
+                        active_set_.active_constraints_indices_[i] =
+                            ctr_index
+                            - (std::lower_bound(removed_constraints.begin(),
+                                                removed_constraints.end(),
+                                                ctr_index - num_simple_bounds_)
+                                - removed_constraints.begin());
+                    }
+                }
+
+                MatrixIndex ctr_index = num_simple_bounds_;
+                MatrixIndex removed_index = 0;
+                for (MatrixIndex i = num_simple_bounds_; i < prev_num_constraints; ++i)
+                {
+                    if ((removed_index < num_removed)
+                            && (removed_constraints[removed_index] == i - num_simple_bounds_))
+                    {
+                        ++removed_index;
+                    }
+                    else
+                    {
+                        constraints_status_[ctr_index] = constraints_status_[i];
+                        ++ctr_index;
+                    }
+                }
+
+                // appended constraints, equalities can be activated only
+                // in front of inequalities
+                const bool activate_equalities = (0 == active_set_.num_inequalities_);
+                for (; ctr_index < num_constraints_; ++ctr_index)
+                {
+                    const double lb_i = getLowerBound(lb, Alb, ctr_index);
+                    const double ub_i = getUpperBound(ub, Aub, ctr_index);
+
+                    if (lb_i - resume_param.tolerance_ > ub_i)
+                    {
+                        constraints_status_[ctr_index] = ConstraintStatus::INCONSISTENT;
+                        QPMAD_FAIL(INCONSISTENT_CONSTRAINTS, "Inconsistent constraints!");
+                    }
+
+                    if (activate_equalities && (std::abs(lb_i - ub_i) <= resume_param.tolerance_))
+                    {
+                        constraints_status_[ctr_index] = ConstraintStatus::EQUALITY;
+
+                        if (isActiveSetSizeLimitReached())
+                        {
+                            return (MAXIMAL_ACTIVE_SET_SIZE);
+                        }
+
+                        if (active_set_.hasEmptySpace())
+                        {
+                            projectInequality(A, ctr_index, ConstraintStatus::ACTIVE_UPPER_BOUND);
+                            if (factorization_data_.update(active_set_.size_, resume_param.tolerance_))
+                            {
+                                active_set_.addEquality(ctr_index);
+                                continue;
+                            }
+                        }
+
+                        // linearly dependent constraint, the previous
+                        // solution satisfies the active constraints
+                        if (std::abs(lb_i - getConstraintDotVector(A, ctr_index, primal)) > resume_param.tolerance_)
+                        {
+                            return (INFEASIBLE_EQUALITY);
+                        }
+                    }
+                    else
+                    {
+                        constraints_status_[ctr_index] = ConstraintStatus::INACTIVE;
+                    }
+                }
+
+
+                // the factorization is carried over from the previous call
+                checkDrift(H, A, resume_param);
+                restoreDualFeasibility(primal, h, lb, ub, Alb, Aub, resume_param);
+
+                return (iterate(primal, H, h, lb, ub, A, Alb, Aub, resume_param));
+            }
+
+
+            /**
+             * @brief Turn inequality constraints, which are active at the
+             * solution found by the last call to solve() or resume(), into
+             * equalities, e.g., to preserve the solution of a higher
+             * priority problem in a hierarchy, see HierarchicalSolver.
+             *
+             * The factorization is kept: columns of R corresponding to
+             * active lower bounds are negated, since equalities are
+             * oriented along the constraint normals. Bounds of the fixed
+             * constraints are set to their active values in the given
+             * vectors, which must be passed to the following call to
+             * resume().
+             */
+            template<   class t_lb,
+                        class t_ub,
+                        class t_Alb,
+                        class t_Aub>
+                void fixActiveSet(  Eigen::MatrixBase<t_lb>     & lb,
+                                    Eigen::MatrixBase<t_ub>     & ub,
+                                    Eigen::MatrixBase<t_Alb>    & Alb,
+                                    Eigen::MatrixBase<t_Aub>    & Aub)
+            {
+                for (MatrixIndex i = active_set_.num_equalities_; i < active_set_.size_; ++i)
+                {
+                    const MatrixIndex ctr_index = active_set_.getIndex(i);
+
+                    if (ConstraintStatus::ACTIVE_LOWER_BOUND == constraints_status_[ctr_index])
+                    {
+                        factorization_data_.R.col(i).head(i + 1) *= -1.0;
+                        dual_(i) = - dual_(i);
+
+                        if (ctr_index < num_simple_bounds_)
+                        {
+                            ub(ctr_index) = lb(ctr_index);
+                        }
+                        else
+                        {
+                            Aub(ctr_index - num_simple_bounds_) = Alb(ctr_index - num_simple_bounds_);
+                        }
+                    }
+                    else
+                    {
+                        if (ctr_index < num_simple_bounds_)
+                        {
+                            lb(ctr_index) = ub(ctr_index);
+                        }
+                        else
+                        {
+                            Alb(ctr_index - num_simple_bounds_) = Aub(ctr_index - num_simple_bounds_);
+                        }
+                    }
+
+                    constraints_status_[ctr_index] = ConstraintStatus::EQUALITY;
+                }
+
+                active_set_.num_equalities_ = active_set_.size_;
+                active_set_.num_inequalities_ = 0;
+            }
+
+
+            /**
+             * @brief Solve a QP with simple bounds 'lb <= primal <= ub' and
+             * general constraints generated by an oracle (cutting-plane
+             * mode).
+             *
+             * General constraints are not scanned by the solver, they are
+             * obtained from ConstraintOracle::getMostViolatedConstraint()
+             * and stored in the workspace while they are active, i.e., the
+             * memory usage does not depend on the total number of
+             * constraints, see getOracleWorkspaceSize().
+             * Generated constraints are indexed after simple bounds in the
+             * order of internal slots, which are reused after deactivation.
+             * Warm start is not supported in this mode and is ignored.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub>
+                ReturnStatus    solve(  Eigen::MatrixBase<t_primal>     & primal,
+                                        Eigen::MatrixBase<t_H>          & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_lb>   & lb,
+                                        const Eigen::MatrixBase<t_ub>   & ub,
+                                        ConstraintOracle                & oracle,
+                                        const SolverParameters          & param)
+            {
+                const MatrixIndex primal_size = H.rows();
+                const MatrixIndex num_slots = getNumOracleSlots(primal_size, param);
+
+                // generated constraints are stored after the chunks mapped
+                // by mapWorkspace(), which does not move them since it
+                // reserves less memory
+                QPMAD_CHECK(    workspace_.reserve(getOracleWorkspaceSize(primal_size, lb.rows(), param)),
+                                WORKSPACE_TOO_SMALL, "Workspace is too small.");
+                workspace_.allocate<char>(getWorkspaceSize(primal_size, lb.rows() + num_slots, param));
+
+                new (&oracle_constraints_)  QPMatrixMap(workspace_.allocate<double>(primal_size * num_slots), primal_size, num_slots);
+                new (&oracle_lb_)           QPVectorMap(workspace_.allocate<double>(num_slots), num_slots);
+                new (&oracle_ub_)           QPVectorMap(workspace_.allocate<double>(num_slots), num_slots);
+
+                oracle_constraints_.setZero();
+                oracle_lb_.setConstant(-std::numeric_limits<double>::infinity());
+                oracle_ub_.setConstant(std::numeric_limits<double>::infinity());
+
+                SolverParameters oracle_param = param;
+                oracle_param.warm_start_ = false;
+
+                oracle_ = &oracle;
+                ReturnStatus status;
+#ifdef QPMAD_NO_EXCEPTIONS
+                status = solve(primal, H, h, lb, ub, oracle_constraints_.transpose(), oracle_lb_, oracle_ub_, oracle_param);
+#else
+                try
+                {
+                    status = solve(primal, H, h, lb, ub, oracle_constraints_.transpose(), oracle_lb_, oracle_ub_, oracle_param);
+                }
+                catch (...)
+                {
+                    oracle_ = NULL;
+                    throw;
+                }
+#endif
+                oracle_ = NULL;
+
+                return (status);
+            }
+
+
+            /**
+             * @brief Solve a QP with general constraints generated by an
+             * oracle only.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h>
+                ReturnStatus    solve(  Eigen::MatrixBase<t_primal>     & primal,
+                                        Eigen::MatrixBase<t_H>          & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        ConstraintOracle                & oracle,
+                                        const SolverParameters          & param)
+            {
+                return (solve(primal, H, h, QPVector(), QPVector(), oracle, param));
+            }
+
+
+        private:
+            class ChosenConstraint
+            {
+                public:
+                    double                      violation_;
+                    double                      dual_;
+                    MatrixIndex                 index_;
+                    ConstraintStatus::Status    type_;
+                    /// saturated soft constraint, which is released
+                    bool                        saturated_;
+
+                public:
+                    ChosenConstraint()
+                    {
+                        dual_ = 0.0;
+                        violation_ = 0.0;
+                        index_ = 0;
+                        type_ = ConstraintStatus::UNDEFINED;
+                        saturated_ = false;
+                    }
+            };
+
+
+            class BlockCandidate
+            {
+                public:
+                    double                      violation_;
+                    MatrixIndex                 index_;
+                    ConstraintStatus::Status    type_;
+
+                public:
+                    /// larger violations first, the lowest index wins on ties
+                    static bool compareViolations(const BlockCandidate & left, const BlockCandidate & right)
+                    {
+                        return (    (std::abs(left.violation_) > std::abs(right.violation_))
+                                    || ((std::abs(left.violation_) == std::abs(right.violation_))
+                                        && (left.index_ < right.index_)) );
+                    }
+
+                    static bool compareIndices(const BlockCandidate & left, const BlockCandidate & right)
+                    {
+                        return (left.index_ < right.index_);
+                    }
+            };
+
+
+        private:
+            bool        machinery_initialized_;
+
+            MatrixIndex num_constraints_;
+
+            Workspace   workspace_;
+            MatrixIndex workspace_primal_size_;
+            MatrixIndex workspace_num_constraints_;
+            MatrixIndex workspace_max_active_set_size_;
+
+            ActiveSet           active_set_;
+            FactorizationData   factorization_data_;
+
+            QPVectorMap dual_;
+
+            QPVectorMap primal_step_direction_;
+            QPVectorMap dual_step_direction_;
+
+            QPVectorMap general_ctr_dot_primal_;
+
+#ifdef QPMAD_USE_OPENMP
+            /// constraints chosen by threads, see chooseConstraint()
+            ChosenConstraint            *thread_chosen_ctr_;
+#endif
+
+            ConstraintStatus::Status    *constraints_status_;
+
+            MatrixIndex                 *warm_start_indices_;
+            ConstraintStatus::Status    *warm_start_types_;
+            MatrixIndex                 num_warm_start_constraints_;
+
+            /// cutting-plane mode: oracle and storage of generated constraints
+            ConstraintOracle            *oracle_;
+            QPMatrixMap                 oracle_constraints_;
+            QPVectorMap                 oracle_lb_;
+            QPVectorMap                 oracle_ub_;
+
+            FactorizationCache          *factorization_cache_;
+            /// key of the warm start active set, the memory is reused
+            std::vector<FactorizationCache::ConstraintKey>  factorization_cache_key_;
+
+            /// value of the objective, updated incrementally
+            double                      objective_;
+
+            Statistics                  statistics_;
+
+            /// weights of soft general constraints, they are kept in the
+            /// workspace after solve() for getDual()
+            bool                        soft_constraints_;
+            QPVectorMap                 soft_constraint_weights_;
+
+            /// block activation: violated constraints and temporary data,
+            /// see getMaxBlockSize()
+            BlockCandidate              *block_candidates_;
+            QPMatrixMap                 block_normals_;
+            QPMatrixMap                 block_projections_;
+            QPVectorMap                 block_primal_;
+            QPVectorMap                 block_dual_;
+
+            /// sensitivities: temporary data
+            QPMatrix                    sensitivity_active_;
+            QPMatrix                    sensitivity_projection_;
+
+
+        private:
+            Solver(const Solver &);
+            Solver & operator=(const Solver &);
+
+
+        private:
+            template <class t_MatrixType>
+                void initializeMachineryLazy(   const t_MatrixType &H,
+                                                const SolverParameters::HessianType hessian_type)
+            {
+                if (false == machinery_initialized_)
+                {
+                    active_set_.initialize();
+                    factorization_data_.initialize(H, hessian_type);
+
+                    machinery_initialized_ = true;
+                }
+            }
+
+
+            /// Solve 'R * X = B' or 'R^T * X = B' in place.
+            void solveRInPlace(QPMatrix & matrix, const bool transpose) const
+            {
+                if (transpose)
+                {
+                    factorization_data_.R.topLeftCorner(matrix.rows(), matrix.rows()).transpose()
+                        .triangularView<Eigen::Lower>().solveInPlace(matrix);
+                }
+                else
+                {
+                    factorization_data_.R.topLeftCorner(matrix.rows(), matrix.rows())
+                        .triangularView<Eigen::Upper>().solveInPlace(matrix);
+                }
+            }
+
+
+            /**
+             * @brief Sensitivity of the unconstrained minimizer '- H^-1 *
+             * directions' if J is not computed, see
+             * computeUnconstrainedOptimum().
+             */
+            template<   class t_sensitivity,
+                        class t_H,
+                        class t_directions>
+                void computeUnconstrainedSensitivity(   Eigen::MatrixBase<t_sensitivity>        & sensitivity,
+                                                        const Eigen::MatrixBase<t_H>            & H,
+                                                        const Eigen::MatrixBase<t_directions>   & directions,
+                                                        const MatrixIndex                       num_directions,
+                                                        const SolverParameters                  & param)
+            {
+                if (directions.rows() > 0)
+                {
+                    if (SolverParameters::HESSIAN_INVERTED_CHOLESKY_FACTOR == param.hessian_type_)
+                    {
+                        sensitivity.derived().noalias() = - H * (H.transpose() * directions);
+                    }
+                    else
+                    {
+                        CholeskyFactorization::solve(sensitivity.derived(), H, -directions);
+                    }
+                }
+                else
+                {
+                    sensitivity.derived().resize(primal_size_, num_directions);
+                    sensitivity.setZero();
+                }
+            }
+
+
+            /// @return false if the input is invalid, see InputParser
+            template<   class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                bool    parseProblem(   const Eigen::MatrixBase<t_H>    & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_lb>   & lb,
+                                        const Eigen::MatrixBase<t_ub>   & ub,
+                                        const Eigen::MatrixBase<t_A>    & A,
+                                        const Eigen::MatrixBase<t_Alb>  & Alb,
+                                        const Eigen::MatrixBase<t_Aub>  & Aub,
+                                        const bool                      check)
+            {
+                return (parseObjective(H, h, check)
+                        && parseSimpleBounds(lb, ub, check)
+                        && parseGeneralConstraints(A, Alb, Aub, check));
+            }
+
+
+            /**
+             * @brief Implementation of the main solve() overload, weights
+             * are copied to the workspace if soft_constraints_ is set.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub,
+                        class t_weights>
+                ReturnStatus    solveProblem(   Eigen::MatrixBase<t_primal>         & primal,
+                                                Eigen::MatrixBase<t_H>              & H,
+                                                const Eigen::MatrixBase<t_h>        & h,
+                                                const Eigen::MatrixBase<t_lb>       & lb,
+                                                const Eigen::MatrixBase<t_ub>       & ub,
+                                                const Eigen::MatrixBase<t_A>        & A,
+                                                const Eigen::MatrixBase<t_Alb>      & Alb,
+                                                const Eigen::MatrixBase<t_Aub>      & Aub,
+                                                const Eigen::MatrixBase<t_weights>  & weights,
+                                                const SolverParameters              & param)
+            {
+                QPMAD_TRACE(std::setprecision(std::numeric_limits<double>::digits10));
+
+                if (false == parseProblem(H, h, lb, ub, A, Alb, Aub, param.check_input_))
+                {
+                    return (INVALID_INPUT);
+                }
+                num_constraints_ = num_simple_bounds_ + num_general_constraints_;
+
+                saveActiveSetForWarmStart(param);
+                machinery_initialized_ = false;
+
+                if (num_constraints_ > 0)
+                {
+                    if (false == mapWorkspace(param))
+                    {
+                        return (WORKSPACE_TOO_SMALL);
+                    }
+
+                    if (soft_constraints_)
+                    {
+                        soft_constraint_weights_ = weights;
+                    }
+
+                    if ((param.crash_) && (primal.rows() == primal_size_))
+                    {
+                        guessActiveSet(primal, lb, ub, A, Alb, Aub, param);
+                    }
+                }
+
+
+                switch(param.hessian_type_)
+                {
+                    case SolverParameters::HESSIAN_LOWER_TRIANGULAR:
+                        CholeskyFactorization::compute(H);
+                        // no break here!
+                    case SolverParameters::HESSIAN_CHOLESKY_FACTOR:
+                    case SolverParameters::HESSIAN_INVERTED_CHOLESKY_FACTOR:
+                        break;
+
+                    default:
+                        QPMAD_FAIL(INVALID_INPUT, "Malformed solver parameters!");
+                        break;
+                }
+
+
+                if ((SolverParameters::METHOD_PRIMAL == param.method_)
+                    && (num_constraints_ > 0)
+                    && (NULL == oracle_)
+                    && (false == soft_constraints_)
+                    && (primal.rows() == primal_size_)
+                    && (isFeasible(primal, lb, ub, A, Alb, Aub, param.tolerance_)))
+                {
+                    const ReturnStatus status = iteratePrimal(primal, H, h, lb, ub, A, Alb, Aub, param);
+                    if (OK == status)
+                    {
+                        updateFactorizationCache();
+                    }
+                    return (status);
+                }
+
+
+                computeUnconstrainedOptimum(primal, H, h, param.hessian_type_);
+
+                if (0 == num_constraints_)
+                {
+                    // exit early -- avoid unnecessary memory allocations
+                    return (OK);
+                }
+
+
+                if ((NULL != factorization_cache_) && (NULL == oracle_) && (false == soft_constraints_))
+                {
+                    if (restoreFromFactorizationCache(primal, h, lb, ub, A, Alb, Aub, param))
+                    {
+                        return (OK);
+                    }
+                    // the primal variables are overwritten
+                    computeUnconstrainedOptimum(primal, H, h, param.hessian_type_);
+                }
+
+
+                // check consistency of constraints and activate equality
+                // constraints
+                MatrixIndex     num_equalities = 0;
+                for (MatrixIndex i = 0; i < num_constraints_; ++i)
+                {
+                    const double lb_i = getLowerBound(lb, Alb, i);
+                    const double ub_i = getUpperBound(ub, Aub, i);
+
+                    if (lb_i - param.tolerance_ > ub_i)
+                    {
+                        constraints_status_[i] = ConstraintStatus::INCONSISTENT;
+                        QPMAD_FAIL(INCONSISTENT_CONSTRAINTS, "Inconsistent constraints!");
+                    }
+
+                    if (std::abs(lb_i - ub_i) > param.tolerance_)
+                    {
+                        constraints_status_[i] = ConstraintStatus::INACTIVE;
+                    }
+                    else
+                    {
+                        constraints_status_[i] = ConstraintStatus::EQUALITY;
+                        ++num_equalities;
+
+
+                        double violation = lb_i - getConstraintDotVector(A, i, primal);
+
+                        initializeMachineryLazy(H, param.hessian_type_);
+
+                        if (isActiveSetSizeLimitReached())
+                        {
+                            return (MAXIMAL_ACTIVE_SET_SIZE);
+                        }
+
+                        // if 'primal_size_' constraints are already activated
+                        // all other constraints are linearly dependent
+                        if (active_set_.hasEmptySpace())
+                        {
+                            computeEqualityPrimalStep(A, i);
+
+                            double ctr_i_dot_primal_step_direction = getConstraintDotVector(A, i, primal_step_direction_);
+                            // if step direction is a zero vector, constraint is
+                            // linearly dependent with previously added constraints
+                            if (ctr_i_dot_primal_step_direction < -param.tolerance_)
+                            {
+                                double primal_step_length_ = violation / ctr_i_dot_primal_step_direction;
+
+                                primal.noalias() += primal_step_length_ * primal_step_direction_;
+                                // the gradient is orthogonal to the step
+                                // direction, which is the null space
+                                // projection of the constraint normal
+                                objective_ -= 0.5 * primal_step_length_ * violation;
+
+                                if (false == factorization_data_.update(active_set_.size_, param.tolerance_))
+                                {
+                                    QPMAD_FAIL(NUMERICAL_FAILURE, "Failed to add an equality constraint -- is this possible?");
+                                }
+                                active_set_.addEquality(i);
+
+                                continue;
+                            }
+                            // otherwise -- linear dependence
+                        }
+
+                        // this point is reached if constraint is linearly dependent
+
+                        // check if this constraint is actually satisfied
+                        if (std::abs(violation) > param.tolerance_)
+                        {
+                            // nope it is not
+                            return (INFEASIBLE_EQUALITY);
+                        }
+                        // otherwise keep going
+                    }
+                }
+
+
+                if (num_equalities == num_constraints_)
+                {
+                    // exit early -- there are no inequalities
+                    computeEqualityDuals(h, lb, A, Alb);
+                    updateFactorizationCache();
+                    return (OK);
+                }
+
+
+                if (num_warm_start_constraints_ > 0)
+                {
+                    warmStart(primal, H, h, lb, ub, A, Alb, Aub, param);
+                }
+
+
+                const ReturnStatus status = iterate(primal, H, h, lb, ub, A, Alb, Aub, param);
+                if (OK == status)
+                {
+                    updateFactorizationCache();
+                }
+                return (status);
+            }
+
+
+            /**
+             * @brief Primal active set method.
+             *
+             * Starts from a feasible point and moves towards the minimizer
+             * of the objective subject to the active constraints treated as
+             * equalities, see computeActiveSetOptimum(). The step is cut by
+             * the first inactive constraint on the way, which is then
+             * activated; otherwise the active constraint with the most
+             * negative multiplier is deactivated, or the solution is found
+             * if there are no such constraints. The factorization is
+             * updated in the same way as in the dual method.
+             *
+             * Initially active constraints are not required to be tight:
+             * the step moves them towards their bounds, so all iterates
+             * remain feasible.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    iteratePrimal(  Eigen::MatrixBase<t_primal>     & primal,
+                                                const Eigen::MatrixBase<t_H>    & H,
+                                                const Eigen::MatrixBase<t_h>    & h,
+                                                const Eigen::MatrixBase<t_lb>   & lb,
+                                                const Eigen::MatrixBase<t_ub>   & ub,
+                                                const Eigen::MatrixBase<t_A>    & A,
+                                                const Eigen::MatrixBase<t_Alb>  & Alb,
+                                                const Eigen::MatrixBase<t_Aub>  & Aub,
+                                                const SolverParameters          & param)
+            {
+                initializeMachineryLazy(H, param.hessian_type_);
+
+                // equality constraints are satisfied at the starting point
+                for (MatrixIndex i = 0; i < num_constraints_; ++i)
+                {
+                    const double lb_i = getLowerBound(lb, Alb, i);
+                    const double ub_i = getUpperBound(ub, Aub, i);
+
+                    if (lb_i - param.tolerance_ > ub_i)
+                    {
+                        constraints_status_[i] = ConstraintStatus::INCONSISTENT;
+                        QPMAD_FAIL(INCONSISTENT_CONSTRAINTS, "Inconsistent constraints!");
+                    }
+
+                    if (std::abs(lb_i - ub_i) > param.tolerance_)
+                    {
+                        constraints_status_[i] = ConstraintStatus::INACTIVE;
+                    }
+                    else
+                    {
+                        constraints_status_[i] = ConstraintStatus::EQUALITY;
+
+                        if (isActiveSetSizeLimitReached())
+                        {
+                            return (MAXIMAL_ACTIVE_SET_SIZE);
+                        }
+
+                        if (active_set_.hasEmptySpace())
+                        {
+                            projectInequality(A, i, ConstraintStatus::ACTIVE_UPPER_BOUND);
+                            // linearly dependent constraints are skipped
+                            if (factorization_data_.update(active_set_.size_, param.tolerance_))
+                            {
+                                active_set_.addEquality(i);
+                            }
+                        }
+                    }
+                }
+
+                for (MatrixIndex i = 0; (i < num_warm_start_constraints_) && (active_set_.hasEmptySpace()); ++i)
+                {
+                    const MatrixIndex ctr_index = warm_start_indices_[i];
+
+                    if (ConstraintStatus::INACTIVE == constraints_status_[ctr_index])
+                    {
+                        projectInequality(A, ctr_index, warm_start_types_[i]);
+                        if (factorization_data_.update(active_set_.size_, param.tolerance_))
+                        {
+                            constraints_status_[ctr_index] = warm_start_types_[i];
+                            active_set_.addInequality(ctr_index);
+                        }
+                    }
+                }
+
+
+                ReturnStatus return_status = MAXIMAL_NUMBER_OF_ITERATIONS;
+                for(int iter = 0;
+                    (iter < param.max_iter_) || (param.max_iter_ < 0);
+                    ++iter)
+                {
+                    QPMAD_TRACE(">>>>>>>>>"  << iter << "<<<<<<<<<");
+                    QPMAD_TRACE_EVENT(ITERATION_START, iter, active_set_.size_);
+
+                    checkDrift(H, A, param);
+                    computeActiveSetOptimum(primal_step_direction_, h, lb, ub, Alb, Aub);
+                    primal_step_direction_ -= primal;
+
+
+                    // the longest feasible step
+                    double                      step_length = 1.0;
+                    MatrixIndex                 blocking_ctr_index = num_constraints_;
+                    ConstraintStatus::Status    blocking_ctr_type = ConstraintStatus::UNDEFINED;
+
+                    if (num_general_constraints_ > 0)
+                    {
+                        general_ctr_dot_primal_.noalias() = A * primal;
+                    }
+                    for (MatrixIndex i = 0; i < num_constraints_; ++i)
+                    {
+                        if (ConstraintStatus::INACTIVE == constraints_status_[i])
+                        {
+                            const double ctr_i_dot_primal = (i < num_simple_bounds_)
+                                                            ? primal(i)
+                                                            : general_ctr_dot_primal_(i - num_simple_bounds_);
+                            const double ctr_i_dot_step = getConstraintDotVector(A, i, primal_step_direction_);
+
+                            if (ctr_i_dot_step < -param.tolerance_)
+                            {
+                                const double step_length_i = std::max(
+                                        0.0, (getLowerBound(lb, Alb, i) - ctr_i_dot_primal) / ctr_i_dot_step);
+                                if (step_length_i < step_length)
+                                {
+                                    step_length = step_length_i;
+                                    blocking_ctr_index = i;
+                                    blocking_ctr_type = ConstraintStatus::ACTIVE_LOWER_BOUND;
+                                }
+                            }
+                            else
+                            {
+                                if (ctr_i_dot_step > param.tolerance_)
+                                {
+                                    const double step_length_i = std::max(
+                                            0.0, (getUpperBound(ub, Aub, i) - ctr_i_dot_primal) / ctr_i_dot_step);
+                                    if (step_length_i < step_length)
+                                    {
+                                        step_length = step_length_i;
+                                        blocking_ctr_index = i;
+                                        blocking_ctr_type = ConstraintStatus::ACTIVE_UPPER_BOUND;
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+
+                    if (blocking_ctr_index == num_constraints_)
+                    {
+                        QPMAD_TRACE("||| FULL STEP");
+                        QPMAD_TRACE_EVENT(FULL_STEP, -1, step_length);
+                        primal.noalias() += primal_step_direction_;
+
+                        // multipliers are computed at the new point
+                        MatrixIndex negative_dual_index = active_set_.size_;
+                        double      negative_dual = -param.tolerance_;
+                        for (MatrixIndex i = active_set_.num_equalities_; i < active_set_.size_; ++i)
+                        {
+                            if (dual_(i) < negative_dual)
+                            {
+                                negative_dual = dual_(i);
+                                negative_dual_index = i;
+                            }
+                        }
+
+                        if (negative_dual_index == active_set_.size_)
+                        {
+                            return_status = OK;
+                            break;
+                        }
+
+                        QPMAD_TRACE("||| Deactivate constraint with negative dual " << active_set_.getIndex(negative_dual_index));
+                        QPMAD_TRACE_EVENT(DOWNDATE, active_set_.getIndex(negative_dual_index), negative_dual);
+                        constraints_status_[ active_set_.getIndex(negative_dual_index) ] = ConstraintStatus::INACTIVE;
+                        factorization_data_.downdate(negative_dual_index, active_set_.size_, param.tolerance_);
+                        active_set_.removeInequality(negative_dual_index);
+                    }
+                    else
+                    {
+                        QPMAD_TRACE("||| PARTIAL STEP, blocking ctr index = " << blocking_ctr_index);
+                        QPMAD_TRACE_EVENT(PARTIAL_STEP, blocking_ctr_index, step_length);
+                        primal.noalias() += step_length * primal_step_direction_;
+
+                        if (false == active_set_.hasEmptySpace())
+                        {
+                            return_status = MAXIMAL_ACTIVE_SET_SIZE;
+                            break;
+                        }
+
+                        // the blocking constraint is not parallel to the
+                        // step, i.e., it is linearly independent of the
+                        // active constraints
+                        projectInequality(A, blocking_ctr_index, blocking_ctr_type);
+                        if (false == factorization_data_.update(active_set_.size_, param.tolerance_))
+                        {
+                            QPMAD_FAIL(NUMERICAL_FAILURE, "Failed to add an inequality constraint -- is this possible?");
+                        }
+                        constraints_status_[blocking_ctr_index] = blocking_ctr_type;
+                        active_set_.addInequality(blocking_ctr_index);
+                    }
+                }
+
+
+                if (OK == return_status)
+                {
+                    for (MatrixIndex i = active_set_.num_equalities_; i < active_set_.size_; ++i)
+                    {
+                        // small negative values are possible due to rounding
+                        dual_(i) = std::max(0.0, dual_(i));
+                    }
+                }
+                else
+                {
+                    // computed only at minimizers subject to the active
+                    // constraints
+                    objective_ = std::numeric_limits<double>::quiet_NaN();
+                }
+
+#ifdef QPMAD_ENABLE_TRACING
+                testing::printActiveSet(active_set_, constraints_status_, dual_);
+#endif
+                return (return_status);
+            }
+
+
+            /// Check if all constraints are satisfied at the given point.
+            template<   class t_primal,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                bool isFeasible(const Eigen::MatrixBase<t_primal>   & primal,
+                                const Eigen::MatrixBase<t_lb>       & lb,
+                                const Eigen::MatrixBase<t_ub>       & ub,
+                                const Eigen::MatrixBase<t_A>        & A,
+                                const Eigen::MatrixBase<t_Alb>      & Alb,
+                                const Eigen::MatrixBase<t_Aub>      & Aub,
+                                const double                        tolerance)
+            {
+                if (num_general_constraints_ > 0)
+                {
+                    general_ctr_dot_primal_.noalias() = A * primal;
+                }
+
+                for (MatrixIndex i = 0; i < num_constraints_; ++i)
+                {
+                    const double ctr_i_dot_primal = (i < num_simple_bounds_)
+                                                    ? primal(i)
+                                                    : general_ctr_dot_primal_(i - num_simple_bounds_);
+
+                    if (    (ctr_i_dot_primal < getLowerBound(lb, Alb, i) - tolerance)
+                            || (ctr_i_dot_primal > getUpperBound(ub, Aub, i) + tolerance) )
+                    {
+                        return (false);
+                    }
+                }
+                return (true);
+            }
+
+
+            /// Minimizer of the objective without constraints
+            template<   class t_primal,
+                        class t_H,
+                        class t_h>
+                void computeUnconstrainedOptimum(   Eigen::MatrixBase<t_primal>         & primal,
+                                                    const Eigen::MatrixBase<t_H>        & H,
+                                                    const Eigen::MatrixBase<t_h>        & h,
+                                                    const SolverParameters::HessianType hessian_type)
+            {
+                if (h_size_ > 0)
+                {
+                    if (SolverParameters::HESSIAN_INVERTED_CHOLESKY_FACTOR == hessian_type)
+                    {
+                        if (num_constraints_ > 0)
+                        {
+                            // dual_ is not used yet, avoid a temporary
+                            dual_.noalias() = H.transpose() * h;
+                            primal.noalias() = - H * dual_;
+                        }
+                        else
+                        {
+                            primal.noalias() = - H * (H.transpose() * h);
+                        }
+                    }
+                    else
+                    {
+                        CholeskyFactorization::solve(primal.derived(), H, -h);
+                    }
+                    // - 0.5 * h^T * H^-1 * h
+                    objective_ = 0.5 * h.dot(primal);
+                }
+                else
+                {
+                    primal.derived().resize(primal_size_);
+                    primal.setZero();
+                    objective_ = 0.0;
+                }
+            }
+
+
+            /**
+             * @brief Distribute the workspace between internal data.
+             *
+             * The layout depends only on the problem size, so the data is
+             * preserved when problems of the same size are solved
+             * repeatedly. Only the size of the last chunks depends on the
+             * number of constraints.
+             *
+             * @return false if an external workspace is too small.
+             */
+            bool mapWorkspace(const SolverParameters & param)
+            {
+                const MatrixIndex active_set_size = getMaxActiveSetSize(primal_size_, param.max_active_set_size_);
+
+                QPMAD_CHECK(    workspace_.reserve(getWorkspaceSize(primal_size_, num_constraints_, param)),
+                                false, "Workspace is too small.");
+
+                factorization_data_.mapWorkspace(workspace_, primal_size_, active_set_size);
+                active_set_.mapWorkspace(workspace_, active_set_size);
+
+                new (&dual_)                    QPVectorMap(workspace_.allocate<double>(primal_size_), primal_size_);
+                new (&primal_step_direction_)   QPVectorMap(workspace_.allocate<double>(primal_size_), primal_size_);
+                new (&dual_step_direction_)     QPVectorMap(workspace_.allocate<double>(primal_size_), primal_size_);
+
+                warm_start_indices_ = workspace_.allocate<MatrixIndex>(active_set_size);
+                warm_start_types_ = workspace_.allocate<ConstraintStatus::Status>(active_set_size);
+
+                // offset must not depend on the number of constraints, see
+                // resume()
+                constraints_status_ = workspace_.allocate<ConstraintStatus::Status>(num_constraints_);
+
+                new (&general_ctr_dot_primal_)  QPVectorMap(
+                        workspace_.allocate<double>(num_constraints_),
+                        num_general_constraints_);
+                new (&soft_constraint_weights_) QPVectorMap(
+                        workspace_.allocate<double>(num_constraints_),
+                        num_general_constraints_);
+
+#ifdef QPMAD_USE_OPENMP
+                thread_chosen_ctr_ = workspace_.allocate<ChosenConstraint>(getNumThreads(param));
+#endif
+
+                const MatrixIndex block_size = getMaxBlockSize(active_set_size, param);
+                const MatrixIndex block_primal_size = (block_size > 0) ? primal_size_ : 0;
+                const MatrixIndex block_dual_size = (block_size > 0) ? active_set_size : 0;
+                block_candidates_ = workspace_.allocate<BlockCandidate>(block_size);
+                new (&block_normals_)       QPMatrixMap(
+                        workspace_.allocate<double>(primal_size_ * block_size),
+                        primal_size_, block_size);
+                new (&block_projections_)   QPMatrixMap(
+                        workspace_.allocate<double>(primal_size_ * block_size),
+                        primal_size_, block_size);
+                new (&block_primal_)        QPVectorMap(workspace_.allocate<double>(block_primal_size), block_primal_size);
+                new (&block_dual_)          QPVectorMap(workspace_.allocate<double>(block_dual_size), block_dual_size);
+
+                workspace_primal_size_ = primal_size_;
+                workspace_num_constraints_ = num_constraints_;
+                workspace_max_active_set_size_ = active_set_size;
+
+                return (true);
+            }
+
+
+            /**
+             * @brief Maximal number of constraints activated at once by
+             * activateBlock(), 0 if block activation is disabled.
+             */
+            static MatrixIndex getMaxBlockSize( const MatrixIndex           active_set_size,
+                                                const SolverParameters      & param)
+            {
+                return ((param.max_block_size_ > 1)
+                        ? std::min(static_cast<MatrixIndex>(param.max_block_size_), active_set_size)
+                        : 0);
+            }
+
+
+#ifdef QPMAD_USE_OPENMP
+            static MatrixIndex getNumThreads(const SolverParameters & param)
+            {
+                return (std::max(1, param.num_threads_));
+            }
+#endif
+
+
+            static MatrixIndex getMaxActiveSetSize( const MatrixIndex primal_size,
+                                                    const MatrixIndex max_active_set_size)
+            {
+                if ((max_active_set_size < 0) || (max_active_set_size > primal_size))
+                {
+                    return (primal_size);
+                }
+                return (max_active_set_size);
+            }
+
+
+            /// one slot more than the maximal number of active constraints
+            /// for the constraint being added
+            static MatrixIndex getNumOracleSlots(   const MatrixIndex           primal_size,
+                                                    const SolverParameters      & param)
+            {
+                return (getMaxActiveSetSize(primal_size, param.max_active_set_size_) + 1);
+            }
+
+
+            /**
+             * @brief Distinguishes linear dependence of constraints from the
+             * limit on the number of active constraints.
+             */
+            bool isActiveSetSizeLimitReached() const
+            {
+                return ((false == active_set_.hasEmptySpace()) && (active_set_.size_ < primal_size_));
+            }
+
+
+            template<   class t_lb,
+                        class t_Alb>
+                double getLowerBound(   const Eigen::MatrixBase<t_lb>   & lb,
+                                        const Eigen::MatrixBase<t_Alb>  & Alb,
+                                        const MatrixIndex ctr_index) const
+            {
+                if (ctr_index < num_simple_bounds_)
+                {
+                    return (lb(ctr_index));
+                }
+                else
+                {
+                    return (Alb(ctr_index - num_simple_bounds_));
+                }
+            }
+
+
+            template<   class t_ub,
+                        class t_Aub>
+                double getUpperBound(   const Eigen::MatrixBase<t_ub>   & ub,
+                                        const Eigen::MatrixBase<t_Aub>  & Aub,
+                                        const MatrixIndex ctr_index) const
+            {
+                if (ctr_index < num_simple_bounds_)
+                {
+                    return (ub(ctr_index));
+                }
+                else
+                {
+                    return (Aub(ctr_index - num_simple_bounds_));
+                }
+            }
+
+
+            template<   class t_A,
+                        class t_VectorType>
+                double getConstraintDotVector(  const Eigen::MatrixBase<t_A>        & A,
+                                                const MatrixIndex                   ctr_index,
+                                                const Eigen::MatrixBase<t_VectorType> & vector) const
+            {
+                if (ctr_index < num_simple_bounds_)
+                {
+                    return (vector(ctr_index));
+                }
+                else
+                {
+                    return (A.row(ctr_index - num_simple_bounds_).dot(vector.transpose()));
+                }
+            }
+
+
+            template<class t_A>
+                void computeEqualityPrimalStep( const Eigen::MatrixBase<t_A>    & A,
+                                                const MatrixIndex               ctr_index)
+            {
+                if (ctr_index < num_simple_bounds_)
+                {
+                    factorization_data_.computeEqualityPrimalStep(
+                            primal_step_direction_, ctr_index, active_set_.size_);
+                }
+                else
+                {
+                    factorization_data_.computeEqualityPrimalStep(
+                            primal_step_direction_, A.row(ctr_index - num_simple_bounds_), active_set_.size_);
+                }
+            }
+
+
+            template<class t_A>
+                void computeInequalitySteps(const Eigen::MatrixBase<t_A>    & A,
+                                            const ChosenConstraint          & chosen_ctr)
+            {
+                if (chosen_ctr.index_ < num_simple_bounds_)
+                {
+                    factorization_data_.computeInequalitySteps(
+                            primal_step_direction_,
+                            dual_step_direction_,
+                            chosen_ctr.index_,
+                            chosen_ctr.type_,
+                            active_set_);
+                }
+                else
+                {
+                    factorization_data_.computeInequalitySteps(
+                            primal_step_direction_,
+                            dual_step_direction_,
+                            A.row(chosen_ctr.index_ - num_simple_bounds_),
+                            chosen_ctr.type_,
+                            active_set_);
+                }
+            }
+
+
+            template<class t_A>
+                void computeInequalityDualStep( const Eigen::MatrixBase<t_A>    & A,
+                                                const ChosenConstraint          & chosen_ctr)
+            {
+                if (chosen_ctr.index_ < num_simple_bounds_)
+                {
+                    factorization_data_.computeInequalityDualStep(
+                            dual_step_direction_,
+                            chosen_ctr.index_,
+                            chosen_ctr.type_,
+                            active_set_);
+                }
+                else
+                {
+                    factorization_data_.computeInequalityDualStep(
+                            dual_step_direction_,
+                            A.row(chosen_ctr.index_ - num_simple_bounds_),
+                            chosen_ctr.type_,
+                            active_set_);
+                }
+            }
+
+
+            template<class t_A>
+                void projectInequality( const Eigen::MatrixBase<t_A>    & A,
+                                        const MatrixIndex               ctr_index,
+                                        const ConstraintStatus::Status  ctr_type)
+            {
+                if (ctr_index < num_simple_bounds_)
+                {
+                    factorization_data_.projectInequality(ctr_index, ctr_type);
+                }
+                else
+                {
+                    factorization_data_.projectInequality(
+                            A.row(ctr_index - num_simple_bounds_), ctr_type);
+                }
+            }
+
+
+            template<   class t_VectorType,
+                        class t_A>
+                void addConstraintNormal(   t_VectorType                    & vector,
+                                            const Eigen::MatrixBase<t_A>    & A,
+                                            const MatrixIndex               ctr_index,
+                                            const double                    scale) const
+            {
+                if (ctr_index < num_simple_bounds_)
+                {
+                    vector(ctr_index) += scale;
+                }
+                else
+                {
+                    vector.noalias() += scale * A.row(ctr_index - num_simple_bounds_).transpose();
+                }
+            }
+
+
+            /**
+             * @brief Remember inequality constraints, which are active after
+             * the previous call to solve(), if warm start is requested and
+             * the problem size is preserved.
+             */
+            void saveActiveSetForWarmStart(const SolverParameters & param)
+            {
+                num_warm_start_constraints_ = 0;
+
+                if ( (param.warm_start_)
+                    && (machinery_initialized_)
+                    && (num_constraints_ == workspace_num_constraints_)
+                    && (primal_size_ == workspace_primal_size_)
+                    && (getMaxActiveSetSize(primal_size_, param.max_active_set_size_) == workspace_max_active_set_size_) )
+                {
+                    for (MatrixIndex i = active_set_.num_equalities_; i < active_set_.size_; ++i)
+                    {
+                        const MatrixIndex ctr_index = active_set_.getIndex(i);
+                        warm_start_indices_[num_warm_start_constraints_] = ctr_index;
+                        warm_start_types_[num_warm_start_constraints_] = constraints_status_[ctr_index];
+                        ++num_warm_start_constraints_;
+                    }
+                }
+            }
+
+
+            /**
+             * @brief Select constraints for the crash procedure: constraints,
+             * which are violated or nearly tight at the given point, are
+             * stored in the same way as by saveActiveSetForWarmStart(), in
+             * the order of their indices up to the maximal size of the
+             * active set. Equality constraints are skipped.
+             */
+            template<   class t_primal,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                void guessActiveSet(const Eigen::MatrixBase<t_primal>   & primal,
+                                    const Eigen::MatrixBase<t_lb>       & lb,
+                                    const Eigen::MatrixBase<t_ub>       & ub,
+                                    const Eigen::MatrixBase<t_A>        & A,
+                                    const Eigen::MatrixBase<t_Alb>      & Alb,
+                                    const Eigen::MatrixBase<t_Aub>      & Aub,
+                                    const SolverParameters              & param)
+            {
+                num_warm_start_constraints_ = 0;
+
+                if (num_general_constraints_ > 0)
+                {
+                    general_ctr_dot_primal_.noalias() = A * primal;
+                }
+
+                for (MatrixIndex i = 0;
+                     (i < num_constraints_) && (num_warm_start_constraints_ < active_set_.max_size_);
+                     ++i)
+                {
+                    const double lb_i = getLowerBound(lb, Alb, i);
+                    const double ub_i = getUpperBound(ub, Aub, i);
+
+                    if (std::abs(lb_i - ub_i) <= param.tolerance_)
+                    {
+                        // equalities are activated anyway and skipped by
+                        // warmStart(), they must not reduce the number of
+                        // guessed inequalities
+                        continue;
+                    }
+
+                    const double ctr_i_dot_primal = (i < num_simple_bounds_)
+                                                    ? primal(i)
+                                                    : general_ctr_dot_primal_(i - num_simple_bounds_);
+                    const double lower_slack = ctr_i_dot_primal - lb_i;
+                    const double upper_slack = ub_i - ctr_i_dot_primal;
+
+                    if (std::min(lower_slack, upper_slack) < param.crash_tolerance_)
+                    {
+                        warm_start_indices_[num_warm_start_constraints_] = i;
+                        warm_start_types_[num_warm_start_constraints_] =   (lower_slack < upper_slack)
+                                                                            ? ConstraintStatus::ACTIVE_LOWER_BOUND
+                                                                            : ConstraintStatus::ACTIVE_UPPER_BOUND;
+                        ++num_warm_start_constraints_;
+                    }
+                }
+            }
+
+
+            /**
+             * @brief Activate inequality constraints saved by
+             * saveActiveSetForWarmStart() or guessActiveSet() and move to
+             * the minimizer of the objective subject to them, see
+             * restoreDualFeasibility().
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                void warmStart( Eigen::MatrixBase<t_primal>     & primal,
+                                const Eigen::MatrixBase<t_H>    & H,
+                                const Eigen::MatrixBase<t_h>    & h,
+                                const Eigen::MatrixBase<t_lb>   & lb,
+                                const Eigen::MatrixBase<t_ub>   & ub,
+                                const Eigen::MatrixBase<t_A>    & A,
+                                const Eigen::MatrixBase<t_Alb>  & Alb,
+                                const Eigen::MatrixBase<t_Aub>  & Aub,
+                                const SolverParameters          & param)
+            {
+                initializeMachineryLazy(H, param.hessian_type_);
+
+                for (MatrixIndex i = 0; i < num_warm_start_constraints_; ++i)
+                {
+                    const MatrixIndex               ctr_index = warm_start_indices_[i];
+                    const ConstraintStatus::Status  ctr_type = warm_start_types_[i];
+
+                    if (false == active_set_.hasEmptySpace())
+                    {
+                        break;
+                    }
+
+                    if (ConstraintStatus::INACTIVE == constraints_status_[ctr_index])
+                    {
+                        projectInequality(A, ctr_index, ctr_type);
+                        // linearly dependent constraints are skipped
+                        if (factorization_data_.update(active_set_.size_, param.tolerance_))
+                        {
+                            constraints_status_[ctr_index] = ctr_type;
+                            active_set_.addInequality(ctr_index);
+                        }
+                    }
+                }
+
+
+                restoreDualFeasibility(primal, h, lb, ub, Alb, Aub, param);
+            }
+
+
+            /**
+             * @brief Move to the minimizer of the objective subject to the
+             * active constraints.
+             *
+             * Constraints with negative Lagrange multipliers are
+             * deactivated one by one, so that the resulting primal-dual
+             * pair satisfies assumptions of the dual algorithm.
+             */
+            template<   class t_primal,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_Alb,
+                        class t_Aub>
+                void restoreDualFeasibility(Eigen::MatrixBase<t_primal>     & primal,
+                                            const Eigen::MatrixBase<t_h>    & h,
+                                            const Eigen::MatrixBase<t_lb>   & lb,
+                                            const Eigen::MatrixBase<t_ub>   & ub,
+                                            const Eigen::MatrixBase<t_Alb>  & Alb,
+                                            const Eigen::MatrixBase<t_Aub>  & Aub,
+                                            const SolverParameters          & param)
+            {
+                for (;;)
+                {
+                    computeActiveSetOptimum(primal, h, lb, ub, Alb, Aub);
+
+
+                    MatrixIndex negative_dual_index = active_set_.size_;
+                    double      negative_dual = -param.tolerance_;
+                    for (MatrixIndex i = active_set_.num_equalities_; i < active_set_.size_; ++i)
+                    {
+                        if (dual_(i) < negative_dual)
+                        {
+                            negative_dual = dual_(i);
+                            negative_dual_index = i;
+                        }
+                    }
+
+                    if (negative_dual_index == active_set_.size_)
+                    {
+                        break;
+                    }
+
+                    QPMAD_TRACE("||| Deactivate constraint with negative dual " << active_set_.getIndex(negative_dual_index));
+                    QPMAD_TRACE_EVENT(DOWNDATE, active_set_.getIndex(negative_dual_index), negative_dual);
+                    constraints_status_[ active_set_.getIndex(negative_dual_index) ] = ConstraintStatus::INACTIVE;
+                    factorization_data_.downdate(negative_dual_index, active_set_.size_, param.tolerance_);
+                    active_set_.removeInequality(negative_dual_index);
+                }
+
+
+                for (MatrixIndex i = active_set_.num_equalities_; i < active_set_.size_; ++i)
+                {
+                    // small negative values are possible due to rounding
+                    dual_(i) = std::max(0.0, dual_(i));
+                }
+            }
+
+
+            /**
+             * @brief Compute the minimizer of the objective subject to the
+             * active constraints and their Lagrange multipliers, see
+             * FactorizationData::computeActiveSetOptimum(). The minimizer
+             * may be stored in primal_step_direction_.
+             */
+            template<   class t_primal,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_Alb,
+                        class t_Aub>
+                void computeActiveSetOptimum(   Eigen::MatrixBase<t_primal>     & primal,
+                                                const Eigen::MatrixBase<t_h>    & h,
+                                                const Eigen::MatrixBase<t_lb>   & lb,
+                                                const Eigen::MatrixBase<t_ub>   & ub,
+                                                const Eigen::MatrixBase<t_Alb>  & Alb,
+                                                const Eigen::MatrixBase<t_Aub>  & Aub)
+            {
+                for (MatrixIndex i = 0; i < active_set_.size_; ++i)
+                {
+                    const MatrixIndex ctr_index = active_set_.getIndex(i);
+
+                    switch (constraints_status_[ctr_index])
+                    {
+                        case ConstraintStatus::ACTIVE_LOWER_BOUND:
+                            dual_step_direction_(i) = - getLowerBound(lb, Alb, ctr_index);
+                            break;
+                        case ConstraintStatus::ACTIVE_UPPER_BOUND:
+                            dual_step_direction_(i) = getUpperBound(ub, Aub, ctr_index);
+                            break;
+                        default:
+                            dual_step_direction_(i) = getLowerBound(lb, Alb, ctr_index);
+                            break;
+                    }
+                }
+
+                // 'd' is not used between updates of the factorization
+                objective_ = factorization_data_.computeActiveSetOptimum(
+                        primal,
+                        dual_,
+                        factorization_data_.d,
+                        h,
+                        dual_step_direction_,
+                        active_set_.size_);
+            }
+
+
+            /**
+             * @brief Compute Lagrange multipliers of equality constraints,
+             * which are not updated during iterations.
+             *
+             * Given the multipliers of active inequalities, the leading rows
+             * of R * dual = - (R^-T * b + J1^T * h), see
+             * FactorizationData::computeActiveSetOptimum(), are solved for
+             * the multipliers of equalities. Forces of saturated soft
+             * constraints are added to h.
+             */
+            template<   class t_h,
+                        class t_lb,
+                        class t_A,
+                        class t_Alb>
+                void computeEqualityDuals(  const Eigen::MatrixBase<t_h>    & h,
+                                            const Eigen::MatrixBase<t_lb>   & lb,
+                                            const Eigen::MatrixBase<t_A>    & A,
+                                            const Eigen::MatrixBase<t_Alb>  & Alb)
+            {
+                const MatrixIndex num_equalities = active_set_.num_equalities_;
+
+                if (0 == num_equalities)
+                {
+                    return;
+                }
+
+
+                for (MatrixIndex i = 0; i < num_equalities; ++i)
+                {
+                    dual_(i) = getLowerBound(lb, Alb, active_set_.getIndex(i));
+                }
+                factorization_data_.R.topLeftCorner(num_equalities, num_equalities).transpose()
+                    .triangularView<Eigen::Lower>().solveInPlace(dual_.head(num_equalities));
+
+                if (h_size_ > 0)
+                {
+                    dual_.head(num_equalities).noalias() +=
+                        factorization_data_.QLi_aka_J.leftCols(num_equalities).transpose() * h;
+                }
+
+                if (soft_constraints_)
+                {
+                    for (MatrixIndex i = num_simple_bounds_; i < num_constraints_; ++i)
+                    {
+                        const double force = getSaturatedConstraintForce(i);
+                        if (0.0 != force)
+                        {
+                            dual_.head(num_equalities).noalias() +=
+                                force * factorization_data_.QLi_aka_J.leftCols(num_equalities).transpose()
+                                * A.row(i - num_simple_bounds_).transpose();
+                        }
+                    }
+                }
+
+                dual_.head(num_equalities).noalias() +=
+                    factorization_data_.R.block(0, num_equalities, num_equalities, active_set_.num_inequalities_)
+                    * dual_.segment(num_equalities, active_set_.num_inequalities_);
+                dual_.head(num_equalities) = - dual_.head(num_equalities);
+
+                factorization_data_.R.topLeftCorner(num_equalities, num_equalities)
+                    .triangularView<Eigen::Upper>().solveInPlace(dual_.head(num_equalities));
+            }
+
+
+            /**
+             * @brief Multiplier of a saturated soft constraint in the sign
+             * convention of getDual(), zero for other constraints.
+             */
+            double getSaturatedConstraintForce(const MatrixIndex ctr_index) const
+            {
+                switch (constraints_status_[ctr_index])
+                {
+                    case ConstraintStatus::SATURATED_LOWER_BOUND:
+                        return (- soft_constraint_weights_(ctr_index - num_simple_bounds_));
+                    case ConstraintStatus::SATURATED_UPPER_BOUND:
+                        return (soft_constraint_weights_(ctr_index - num_simple_bounds_));
+                    default:
+                        return (0.0);
+                }
+            }
+
+
+            /**
+             * @brief Estimate drift of the factorization if it is due and
+             * recompute the factorization if necessary, see
+             * SolverParameters::drift_check_period_.
+             */
+            template<   class t_H,
+                        class t_A>
+                void checkDrift(const Eigen::MatrixBase<t_H>    & H,
+                                const Eigen::MatrixBase<t_A>    & A,
+                                const SolverParameters          & param)
+            {
+                if ((param.drift_check_period_ > 0)
+                        && (machinery_initialized_)
+                        && (factorization_data_.num_updates_ >= param.drift_check_period_))
+                {
+                    const double drift = estimateDrift(H, A, param.hessian_type_);
+
+                    ++statistics_.num_drift_checks_;
+                    statistics_.max_drift_ = std::max(statistics_.max_drift_, drift);
+                    factorization_data_.num_updates_ = 0;
+
+                    QPMAD_TRACE("||| Drift estimate = " << drift);
+                    if (drift > param.drift_tolerance_)
+                    {
+                        refactorize(H, A, param);
+                        ++statistics_.num_refactorizations_;
+                    }
+                }
+            }
+
+
+            /**
+             * @brief Estimate drift of the factorization.
+             *
+             * Orthogonality: J * J^T = H^-1 is checked for a vector of ones,
+             * i.e., L^T * J * J^T * L * u = u, where H = L * L^T, or
+             * J * J^T * u = J0 * J0^T * u, where J0 is the given inverted
+             * factor. Residual: J^T * N = [R; 0] is checked for the sum of
+             * signed normals of active constraints. Both errors are
+             * relative.
+             */
+            template<   class t_H,
+                        class t_A>
+                double estimateDrift(   const Eigen::MatrixBase<t_H>        & H,
+                                        const Eigen::MatrixBase<t_A>        & A,
+                                        const SolverParameters::HessianType hessian_type)
+            {
+                const MatrixIndex   size = active_set_.size_;
+                double              orthogonality_error;
+                double              residual = 0.0;
+
+
+                dual_step_direction_.setConstant(1.0);
+                if (SolverParameters::HESSIAN_INVERTED_CHOLESKY_FACTOR == hessian_type)
+                {
+                    factorization_data_.d.noalias() = H.transpose() * dual_step_direction_;
+                    primal_step_direction_.noalias() = H * factorization_data_.d;
+                    factorization_data_.d.noalias() = factorization_data_.QLi_aka_J.transpose() * dual_step_direction_;
+                    dual_step_direction_.noalias() = factorization_data_.QLi_aka_J * factorization_data_.d;
+
+                    orthogonality_error =   (dual_step_direction_ - primal_step_direction_).lpNorm<Eigen::Infinity>()
+                                            / primal_step_direction_.lpNorm<Eigen::Infinity>();
+                }
+                else
+                {
+                    // H contains L in the lower triangular part
+                    primal_step_direction_.noalias() = H.template triangularView<Eigen::Lower>() * dual_step_direction_;
+                    factorization_data_.d.noalias() = factorization_data_.QLi_aka_J.transpose() * primal_step_direction_;
+                    primal_step_direction_.noalias() = factorization_data_.QLi_aka_J * factorization_data_.d;
+                    factorization_data_.d.noalias() =
+                        H.transpose().template triangularView<Eigen::Upper>() * primal_step_direction_;
+
+                    orthogonality_error = (factorization_data_.d.array() - 1.0).abs().maxCoeff();
+                }
+
+
+                if (size > 0)
+                {
+                    primal_step_direction_.setZero();
+                    for (MatrixIndex i = 0; i < size; ++i)
+                    {
+                        const MatrixIndex ctr_index = active_set_.getIndex(i);
+                        addConstraintNormal(
+                                primal_step_direction_,
+                                A,
+                                ctr_index,
+                                (ConstraintStatus::ACTIVE_LOWER_BOUND == constraints_status_[ctr_index]) ? -1.0 : 1.0);
+                    }
+                    factorization_data_.d.noalias() = factorization_data_.QLi_aka_J.transpose() * primal_step_direction_;
+
+                    const double scale = factorization_data_.d.lpNorm<Eigen::Infinity>();
+                    for (MatrixIndex i = 0; i < size; ++i)
+                    {
+                        factorization_data_.d.head(i + 1) -= factorization_data_.R.col(i).head(i + 1);
+                    }
+                    if (scale > 0.0)
+                    {
+                        residual = factorization_data_.d.lpNorm<Eigen::Infinity>() / scale;
+                    }
+                }
+
+                return (std::max(orthogonality_error, residual));
+            }
+
+
+            /**
+             * @brief Recompute J and R from H and the active set, the order
+             * of active constraints, their multipliers and the primal
+             * vector are preserved.
+             */
+            template<   class t_H,
+                        class t_A>
+                void refactorize(   const Eigen::MatrixBase<t_H>    & H,
+                                    const Eigen::MatrixBase<t_A>    & A,
+                                    const SolverParameters          & param)
+            {
+                QPMAD_TRACE("||| REFACTORIZATION");
+                factorization_data_.initialize(H, param.hessian_type_);
+
+                for (MatrixIndex i = 0; i < active_set_.size_; ++i)
+                {
+                    const MatrixIndex ctr_index = active_set_.getIndex(i);
+
+                    // normals of equalities are not negated
+                    projectInequality(A, ctr_index, constraints_status_[ctr_index]);
+                    // linear independence was checked on activation
+                    factorization_data_.update(i, param.tolerance_);
+                }
+                factorization_data_.num_updates_ = 0;
+            }
+
+
+            /**
+             * @brief Activate several violated constraints at once.
+             *
+             * Must be called when the primal-dual pair is the minimizer of
+             * the objective subject to the active constraints, and
+             * constraints are checked by chooseConstraint(). The most
+             * violated constraints are added to the factorization by a
+             * single block update, then the primal-dual pair is moved to
+             * the minimizer subject to the extended active set. Added
+             * constraints with negative multipliers are dropped one by one,
+             * the objective increases in any case since they are violated.
+             * If all of them are dropped or the multipliers of the
+             * previously active constraints become negative, the previous
+             * state is restored: the added constraints correspond to the
+             * trailing columns of J and R, which can be simply discarded.
+             *
+             * @return true if at least one constraint is activated.
+             */
+            template<   class t_primal,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                bool activateBlock( Eigen::MatrixBase<t_primal>     & primal,
+                                    const Eigen::MatrixBase<t_h>    & h,
+                                    const Eigen::MatrixBase<t_lb>   & lb,
+                                    const Eigen::MatrixBase<t_ub>   & ub,
+                                    const Eigen::MatrixBase<t_A>    & A,
+                                    const Eigen::MatrixBase<t_Alb>  & Alb,
+                                    const Eigen::MatrixBase<t_Aub>  & Aub,
+                                    const SolverParameters          & param)
+            {
+                const MatrixIndex prev_size = active_set_.size_;
+                MatrixIndex block_size = std::min(  static_cast<MatrixIndex>(param.max_block_size_),
+                                                    active_set_.max_size_ - prev_size);
+                if (block_size < 2)
+                {
+                    return (false);
+                }
+
+
+                // the most violated constraints are kept in a heap, its top
+                // is the least violated of them
+                MatrixIndex num_candidates = 0;
+                for (MatrixIndex i = 0; i < num_constraints_; ++i)
+                {
+                    if (ConstraintStatus::VIOLATED == constraints_status_[i])
+                    {
+                        const double ctr_i_dot_primal = (i < num_simple_bounds_)
+                                                        ? primal(i)
+                                                        : general_ctr_dot_primal_(i - num_simple_bounds_);
+                        const double lb_i = getLowerBound(lb, Alb, i);
+
+                        BlockCandidate candidate;
+                        candidate.index_ = i;
+                        if (ctr_i_dot_primal < lb_i)
+                        {
+                            candidate.violation_ = ctr_i_dot_primal - lb_i;
+                            candidate.type_ = ConstraintStatus::ACTIVE_LOWER_BOUND;
+                        }
+                        else
+                        {
+                            candidate.violation_ = ctr_i_dot_primal - getUpperBound(ub, Aub, i);
+                            candidate.type_ = ConstraintStatus::ACTIVE_UPPER_BOUND;
+                        }
+
+                        if (num_candidates < block_size)
+                        {
+                            block_candidates_[num_candidates] = candidate;
+                            ++num_candidates;
+                            std::push_heap( block_candidates_,
+                                            block_candidates_ + num_candidates,
+                                            &BlockCandidate::compareViolations);
+                        }
+                        else if (BlockCandidate::compareViolations(candidate, block_candidates_[0]))
+                        {
+                            std::pop_heap(  block_candidates_,
+                                            block_candidates_ + num_candidates,
+                                            &BlockCandidate::compareViolations);
+                            block_candidates_[num_candidates - 1] = candidate;
+                            std::push_heap( block_candidates_,
+                                            block_candidates_ + num_candidates,
+                                            &BlockCandidate::compareViolations);
+                        }
+                    }
+                }
+
+                block_size = num_candidates;
+                if (block_size < 2)
+                {
+                    return (false);
+                }
+
+                // simple bounds first: their projections are rows of J,
+                // projections of general constraints are computed at once
+                std::sort(  block_candidates_,
+                            block_candidates_ + block_size,
+                            &BlockCandidate::compareIndices);
+
+                MatrixIndex num_simple_bounds = 0;
+                for (MatrixIndex i = 0; i < block_size; ++i)
+                {
+                    const BlockCandidate & candidate = block_candidates_[i];
+                    const double sign = (ConstraintStatus::ACTIVE_LOWER_BOUND == candidate.type_) ? -1.0 : 1.0;
+
+                    if (candidate.index_ < num_simple_bounds_)
+                    {
+                        block_projections_.col(i) = sign * factorization_data_.QLi_aka_J.row(candidate.index_).transpose();
+                        ++num_simple_bounds;
+                    }
+                    else
+                    {
+                        block_normals_.col(i - num_simple_bounds) = sign * A.row(candidate.index_ - num_simple_bounds_).transpose();
+                    }
+                }
+                if (block_size > num_simple_bounds)
+                {
+                    block_projections_.middleCols(num_simple_bounds, block_size - num_simple_bounds).noalias() =
+                        factorization_data_.QLi_aka_J.transpose() * block_normals_.leftCols(block_size - num_simple_bounds);
+                }
+
+
+                block_primal_ = primal;
+                block_dual_.head(prev_size) = dual_.head(prev_size);
+                const double block_objective = objective_;
+
+                const MatrixIndex num_added = factorization_data_.updateBlock(
+                        block_projections_, prev_size, block_size, param.tolerance_);
+                for (MatrixIndex i = 0; i < num_added; ++i)
+                {
+                    constraints_status_[block_candidates_[i].index_] = block_candidates_[i].type_;
+                    active_set_.addInequality(block_candidates_[i].index_);
+                }
+                QPMAD_TRACE("||| BLOCK ACTIVATION: " << num_added << " constraints");
+
+
+                bool accepted = (num_added > 0);
+                while (accepted)
+                {
+                    computeActiveSetOptimum(primal, h, lb, ub, Alb, Aub);
+
+                    MatrixIndex negative_dual_index = active_set_.size_;
+                    double      negative_dual = -param.tolerance_;
+                    for (MatrixIndex i = prev_size; i < active_set_.size_; ++i)
+                    {
+                        if (dual_(i) < negative_dual)
+                        {
+                            negative_dual = dual_(i);
+                            negative_dual_index = i;
+                        }
+                    }
+
+                    if (negative_dual_index == active_set_.size_)
+                    {
+                        for (MatrixIndex i = active_set_.num_equalities_; (i < prev_size) && accepted; ++i)
+                        {
+                            accepted = (dual_(i) >= -param.tolerance_);
+                        }
+                        break;
+                    }
+
+                    constraints_status_[ active_set_.getIndex(negative_dual_index) ] = ConstraintStatus::VIOLATED;
+                    factorization_data_.downdate(negative_dual_index, active_set_.size_, param.tolerance_);
+                    active_set_.removeInequality(negative_dual_index);
+
+                    accepted = (active_set_.size_ > prev_size);
+                }
+
+
+                if (accepted)
+                {
+                    QPMAD_TRACE("||| BLOCK ACTIVATION ACCEPTED: " << active_set_.size_ - prev_size << " constraints");
+                    for (MatrixIndex i = active_set_.num_equalities_; i < active_set_.size_; ++i)
+                    {
+                        // small negative values are possible due to rounding
+                        dual_(i) = std::max(0.0, dual_(i));
+                    }
+                }
+                else
+                {
+                    QPMAD_TRACE("||| BLOCK ACTIVATION REJECTED");
+                    for (MatrixIndex i = prev_size; i < active_set_.size_; ++i)
+                    {
+                        constraints_status_[ active_set_.getIndex(i) ] = ConstraintStatus::VIOLATED;
+                    }
+                    active_set_.truncate(prev_size);
+
+                    primal = block_primal_;
+                    dual_.head(prev_size) = block_dual_.head(prev_size);
+                    objective_ = block_objective;
+                }
+
+                return (accepted);
+            }
+
+
+            /**
+             * @brief Try the active sets stored in the cache: the entry of
+             * the active set selected by warm start or crash procedure and
+             * SolverParameters::max_cache_candidates_ most recently used
+             * entries.
+             *
+             * Constraint statuses are set in the same way as by the
+             * equality constraints check in solve(). 'primal' is
+             * overwritten even if no entry is accepted.
+             *
+             * @return true if the problem is solved.
+             */
+            template<   class t_primal,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                bool restoreFromFactorizationCache( Eigen::MatrixBase<t_primal>     & primal,
+                                                    const Eigen::MatrixBase<t_h>    & h,
+                                                    const Eigen::MatrixBase<t_lb>   & lb,
+                                                    const Eigen::MatrixBase<t_ub>   & ub,
+                                                    const Eigen::MatrixBase<t_A>    & A,
+                                                    const Eigen::MatrixBase<t_Alb>  & Alb,
+                                                    const Eigen::MatrixBase<t_Aub>  & Aub,
+                                                    const SolverParameters          & param)
+            {
+                factorization_cache_key_.clear();
+
+                for (MatrixIndex i = 0; i < num_constraints_; ++i)
+                {
+                    const double lb_i = getLowerBound(lb, Alb, i);
+                    const double ub_i = getUpperBound(ub, Aub, i);
+
+                    if (lb_i - param.tolerance_ > ub_i)
+                    {
+                        // reported by solve()
+                        return (false);
+                    }
+
+                    if (std::abs(lb_i - ub_i) > param.tolerance_)
+                    {
+                        constraints_status_[i] = ConstraintStatus::INACTIVE;
+                    }
+                    else
+                    {
+                        constraints_status_[i] = ConstraintStatus::EQUALITY;
+                        if (num_warm_start_constraints_ > 0)
+                        {
+                            factorization_cache_key_.push_back(
+                                    FactorizationCache::ConstraintKey(i, ConstraintStatus::EQUALITY));
+                        }
+                    }
+                }
+
+
+                FactorizationCache::iterator selected = factorization_cache_->end();
+                if (num_warm_start_constraints_ > 0)
                 {
-                    if (Alb(i) - param.tolerance_ > Aub(i))
+                    for (MatrixIndex i = 0; i < num_warm_start_constraints_; ++i)
                     {
-                        general_constraints_status_[i] = ConstraintStatus::INCONSISTENT;
-                        QPMAD_THROW("Inconsistent bounds of general constraints!");
+                        factorization_cache_key_.push_back(
+                                FactorizationCache::ConstraintKey(warm_start_indices_[i], warm_start_types_[i]));
                     }
 
-                    if (std::abs(Alb(i) - Aub(i)) > param.tolerance_)
+                    selected = factorization_cache_->find(factorization_cache_key_);
+                    if (    (selected != factorization_cache_->end())
+                            && (tryFactorizationCacheEntry(selected, primal, h, lb, ub, A, Alb, Aub, param)) )
                     {
-                        general_constraints_status_[i] = ConstraintStatus::INACTIVE;
+                        return (true);
                     }
-                    else
+                }
+
+
+                FactorizationCache::iterator entry = factorization_cache_->begin();
+                for (MatrixIndex i = 0;
+                     (i < param.max_cache_candidates_) && (entry != factorization_cache_->end());
+                     ++i, ++entry)
+                {
+                    if (    (entry != selected)
+                            && (tryFactorizationCacheEntry(entry, primal, h, lb, ub, A, Alb, Aub, param)) )
                     {
-                        general_constraints_status_[i] = ConstraintStatus::EQUALITY;
-                        ++num_general_equalities;
+                        return (true);
+                    }
+                }
 
+                factorization_cache_->miss();
+                return (false);
+            }
 
-                        double violation = Alb(i) - A.row(i) * primal;
 
-                        initializeMachineryLazy(H);
+            /**
+             * @brief Accept a cache entry if the minimizer of the objective
+             * subject to its active set is primal feasible and the Lagrange
+             * multipliers of inequalities are nonnegative.
+             *
+             * The minimizer is computed with the factorization stored in
+             * the entry, which is copied to the solver only if the entry
+             * is accepted.
+             */
+            template<   class t_primal,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                bool tryFactorizationCacheEntry(const FactorizationCache::iterator  & entry,
+                                                Eigen::MatrixBase<t_primal>         & primal,
+                                                const Eigen::MatrixBase<t_h>        & h,
+                                                const Eigen::MatrixBase<t_lb>       & lb,
+                                                const Eigen::MatrixBase<t_ub>       & ub,
+                                                const Eigen::MatrixBase<t_A>        & A,
+                                                const Eigen::MatrixBase<t_Alb>      & Alb,
+                                                const Eigen::MatrixBase<t_Aub>      & Aub,
+                                                const SolverParameters              & param)
+            {
+                const MatrixIndex size = entry->getActiveSetSize();
 
-                        // if 'primal_size_' constraints are already activated
-                        // all other constraints are linearly dependent
-                        if (active_set_.hasEmptySpace())
-                        {
-                            factorization_data_.computeEqualityPrimalStep(
-                                    primal_step_direction_, A.row(i), active_set_.size_);
+                if ((entry->getPrimalSize() != primal_size_) || (size > active_set_.max_size_))
+                {
+                    return (false);
+                }
 
-                            double ctr_i_dot_primal_step_direction = A.row(i) * primal_step_direction_;
-                            // if step direction is a zero vector, constraint is
-                            // linearly dependent with previously added constraints
-                            if (ctr_i_dot_primal_step_direction < -param.tolerance_)
-                            {
-                                double primal_step_length_ = violation / ctr_i_dot_primal_step_direction;
+                for (MatrixIndex i = 0; i < size; ++i)
+                {
+                    const MatrixIndex ctr_index = entry->indices_[i];
 
-                                primal.noalias() += primal_step_length_ * primal_step_direction_;
+                    if (    (ctr_index >= num_constraints_)
+                            || ((i < entry->num_equalities_)
+                                != (ConstraintStatus::EQUALITY == constraints_status_[ctr_index])) )
+                    {
+                        return (false);
+                    }
 
-                                if (false == factorization_data_.update(active_set_.size_, param.tolerance_))
-                                {
-                                    QPMAD_THROW("Failed to add an equality constraint -- is this possible?");
-                                }
-                                active_set_.addEquality(i);
+                    switch (entry->types_[i])
+                    {
+                        case ConstraintStatus::ACTIVE_LOWER_BOUND:
+                            dual_step_direction_(i) = - getLowerBound(lb, Alb, ctr_index);
+                            break;
+                        case ConstraintStatus::ACTIVE_UPPER_BOUND:
+                            dual_step_direction_(i) = getUpperBound(ub, Aub, ctr_index);
+                            break;
+                        default:
+                            dual_step_direction_(i) = getLowerBound(lb, Alb, ctr_index);
+                            break;
+                    }
+                }
 
-                                continue;
-                            }
-                            // otherwise -- linear dependence
-                        }
 
-                        // this point is reached if constraint is linearly dependent
+                const double objective = entry->computeActiveSetOptimum(
+                        primal,
+                        dual_,
+                        primal_step_direction_,
+                        h,
+                        dual_step_direction_);
 
-                        // check if this constraint is actually satisfied
-                        if (std::abs(violation) > param.tolerance_)
+                for (MatrixIndex i = entry->num_equalities_; i < size; ++i)
+                {
+                    if (dual_(i) < -param.tolerance_)
+                    {
+                        return (false);
+                    }
+                }
+
+                for (MatrixIndex i = 0; i < num_simple_bounds_; ++i)
+                {
+                    if ((primal(i) < lb(i) - param.tolerance_) || (primal(i) > ub(i) + param.tolerance_))
+                    {
+                        return (false);
+                    }
+                }
+
+                if (num_general_constraints_ > 0)
+                {
+                    general_ctr_dot_primal_.noalias() = A * primal;
+                    for (MatrixIndex i = 0; i < num_general_constraints_; ++i)
+                    {
+                        if (    (general_ctr_dot_primal_(i) < Alb(i) - param.tolerance_)
+                                || (general_ctr_dot_primal_(i) > Aub(i) + param.tolerance_) )
                         {
-                            // nope it is not
-                            return (INFEASIBLE_EQUALITY);
+                            return (false);
                         }
-                        // otherwise keep going
                     }
                 }
 
 
-                if ((num_general_equalities == num_general_constraints_) && (0 == num_simple_bounds_))
+                for (MatrixIndex i = 0; i < size; ++i)
                 {
-                    // exit early -- avoid unnecessary memory allocations
-                    return (OK);
+                    active_set_.active_constraints_indices_[i] = entry->indices_[i];
+                    constraints_status_[entry->indices_[i]] = entry->types_[i];
+                }
+                active_set_.size_ = size;
+                active_set_.num_equalities_ = entry->num_equalities_;
+                active_set_.num_inequalities_ = size - entry->num_equalities_;
+
+                for (MatrixIndex i = entry->num_equalities_; i < size; ++i)
+                {
+                    dual_(i) = std::max(0.0, dual_(i));
                 }
 
+                factorization_data_.QLi_aka_J = entry->J_;
+                factorization_data_.setR(entry->R_);
+                machinery_initialized_ = true;
+                objective_ = objective;
+
+                factorization_cache_->hit(entry);
+                return (true);
+            }
+
 
-                dual_.resize(primal_size_);
-                dual_step_direction_.resize(primal_size_);
+            void updateFactorizationCache()
+            {
+                if ((NULL != factorization_cache_) && (NULL == oracle_) && (false == soft_constraints_) && (machinery_initialized_))
+                {
+                    factorization_cache_->insert(active_set_, constraints_status_, factorization_data_);
+                }
+            }
 
 
+            /**
+             * @brief Main loop of the dual algorithm.
+             */
+            template<   class t_primal,
+                        class t_H,
+                        class t_h,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ReturnStatus    iterate(Eigen::MatrixBase<t_primal>     & primal,
+                                        const Eigen::MatrixBase<t_H>    & H,
+                                        const Eigen::MatrixBase<t_h>    & h,
+                                        const Eigen::MatrixBase<t_lb>   & lb,
+                                        const Eigen::MatrixBase<t_ub>   & ub,
+                                        const Eigen::MatrixBase<t_A>    & A,
+                                        const Eigen::MatrixBase<t_Alb>  & Alb,
+                                        const Eigen::MatrixBase<t_Aub>  & Aub,
+                                        const SolverParameters          & param)
+            {
                 ChosenConstraint chosen_ctr;
-                chosen_ctr = chooseConstraint(primal, A, Alb, Aub, param.tolerance_);
+                chosen_ctr = chooseConstraint(primal, lb, ub, A, Alb, Aub, param);
+                QPMAD_TRACE_EVENT(CONSTRAINT_CHOSEN, chosen_ctr.index_, chosen_ctr.violation_);
+                // block activation is useful when many constraints are
+                // violated, e.g., after a cold start, and is stopped after
+                // the first rejected block
+                bool use_block_activation = (param.max_block_size_ > 1) && (NULL == oracle_) && (false == soft_constraints_);
+                // the current point is the minimizer of the objective
+                // subject to the active constraints, i.e., no partial steps
+                // have been made towards the chosen constraint
+                bool activate_block = use_block_activation;
                 ReturnStatus return_status = MAXIMAL_NUMBER_OF_ITERATIONS;
                 for(int iter = 0;
                     (iter < param.max_iter_) || (param.max_iter_ < 0);
                     ++iter)
                 {
                     QPMAD_TRACE(">>>>>>>>>"  << iter << "<<<<<<<<<");
+                    QPMAD_TRACE_EVENT(ITERATION_START, iter, chosen_ctr.violation_);
 #ifdef QPMAD_ENABLE_TRACING
-                    testing::computeObjective(H, h, primal);
+                    testing::computeObjective(testing::computeHessian(H, param.hessian_type_), h, primal);
 #endif
                     QPMAD_TRACE("||| Chosen ctr index = " << chosen_ctr.index_);
                     QPMAD_TRACE("||| Chosen ctr dual = " << chosen_ctr.dual_);
                     QPMAD_TRACE("||| Chosen ctr violation = " << chosen_ctr.violation_);
 
 
+                    QPMAD_CHECK(    ConstraintStatus::INCONSISTENT != chosen_ctr.type_,
+                                    INCONSISTENT_CONSTRAINTS, "Inconsistent constraints!");
+                    QPMAD_CHECK(    (NULL == oracle_) || (chosen_ctr.index_ < num_constraints_),
+                                    MAXIMAL_ACTIVE_SET_SIZE, "No free slots for oracle constraints.");
+
                     if (std::abs(chosen_ctr.violation_) < param.tolerance_)
                     {
                         // all constraints are satisfied
                         return_status = OK;
+                        if (machinery_initialized_)
+                        {
+                            computeEqualityDuals(h, lb, A, Alb);
+                        }
                         break;
                     }
 
 
-                    initializeMachineryLazy(H);
+                    initializeMachineryLazy(H, param.hessian_type_);
+                    checkDrift(H, A, param);
+
+                    if (isActiveSetSizeLimitReached())
+                    {
+                        return_status = MAXIMAL_ACTIVE_SET_SIZE;
+                        break;
+                    }
+
+                    if (activate_block)
+                    {
+                        activate_block = false;
+                        if (activateBlock(primal, h, lb, ub, A, Alb, Aub, param))
+                        {
+                            chosen_ctr = chooseConstraint(primal, lb, ub, A, Alb, Aub, param);
+                            QPMAD_TRACE_EVENT(CONSTRAINT_CHOSEN, chosen_ctr.index_, chosen_ctr.violation_);
+                            activate_block = true;
+                            continue;
+                        }
+                        use_block_activation = false;
+                    }
 
                     if (active_set_.hasEmptySpace())
                     {
                         // compute step direction in primal & dual space
-                        factorization_data_.computeInequalitySteps(
-                                primal_step_direction_,
-                                dual_step_direction_,
-                                A.row(chosen_ctr.index_),
-                                chosen_ctr.type_,
-                                active_set_);
+                        computeInequalitySteps(A, chosen_ctr);
                     }
                     else
                     {
                         // compute step direction in dual space only
                         // primal vector cannot change until we deactive something
-                        factorization_data_.computeInequalityDualStep(
-                                dual_step_direction_,
-                                A.row(chosen_ctr.index_),
-                                chosen_ctr.type_,
-                                active_set_);
+                        computeInequalityDualStep(A, chosen_ctr);
                     }
 
 
+                    // multipliers of inequalities must stay nonnegative and
+                    // must not exceed weights of soft constraints
                     MatrixIndex dual_blocking_index = primal_size_;
+                    bool        dual_blocking_saturated = false;
                     double dual_step_length = std::numeric_limits<double>::infinity();
                     for (MatrixIndex i = active_set_.num_equalities_; i < active_set_.size_; ++i)
                     {
@@ -237,22 +3217,41 @@ namespace qpmad
                             {
                                 dual_step_length = dual_step_length_i;
                                 dual_blocking_index = i;
+                                dual_blocking_saturated = false;
+                            }
+                        }
+                        else
+                        {
+                            if ((soft_constraints_) && (dual_step_direction_(i) > param.tolerance_))
+                            {
+                                double dual_step_length_i =
+                                    (getConstraintWeight(active_set_.getIndex(i)) - dual_(i)) / dual_step_direction_(i);
+                                if (dual_step_length_i < dual_step_length)
+                                {
+                                    dual_step_length = dual_step_length_i;
+                                    dual_blocking_index = i;
+                                    dual_blocking_saturated = true;
+                                }
                             }
                         }
                     }
 
+                    // infinite for hard constraints
+                    const double chosen_ctr_dual_step_length = getConstraintWeight(chosen_ctr.index_) - chosen_ctr.dual_;
+
 
 #ifdef QPMAD_ENABLE_TRACING
                     testing::checkLagrangeMultipliers(
-                            H, h, primal, A,
+                            testing::computeHessian(H, param.hessian_type_), h, primal, A,
                             active_set_,
-                            general_constraints_status_,
+                            num_simple_bounds_,
+                            constraints_status_,
                             dual_,
                             dual_step_direction_);
 #endif
 
 
-                    double chosen_ctr_dot_primal_step_direction = A.row(chosen_ctr.index_) * primal_step_direction_;
+                    double chosen_ctr_dot_primal_step_direction = getConstraintDotVector(A, chosen_ctr.index_, primal_step_direction_);
                     if ( active_set_.hasEmptySpace()
                         // if step direction is a zero vector, constraint is
                         // linearly dependent with previously added constraints
@@ -267,17 +3266,29 @@ namespace qpmad
 
 
                         bool partial_step = false;
-                        QPMAD_ASSERT(   (step_length >= 0.0)
+                        bool saturation_step = false;
+                        QPMAD_CHECK(    (step_length >= 0.0)
                                         && (dual_step_length >= 0.0),
-                                        "Non-negative step lengths expected.");
+                                        NUMERICAL_FAILURE, "Non-negative step lengths expected.");
                         if (dual_step_length <= step_length)
                         {
                             step_length = dual_step_length;
                             partial_step = true;
                         }
+                        if (chosen_ctr_dual_step_length < step_length)
+                        {
+                            step_length = chosen_ctr_dual_step_length;
+                            partial_step = false;
+                            saturation_step = true;
+                        }
 
 
                         primal.noalias() += step_length * primal_step_direction_;
+                        // the squared norm of the null space projection of
+                        // the constraint normal equals the absolute value
+                        // of its product with the step direction
+                        objective_ +=   step_length * std::abs(chosen_ctr_dot_primal_step_direction)
+                                        * (chosen_ctr.dual_ + 0.5 * step_length);
 
                         dual_.segment(active_set_.num_equalities_, active_set_.num_inequalities_).noalias()
                             += step_length
@@ -285,66 +3296,105 @@ namespace qpmad
                         chosen_ctr.dual_ += step_length;
                         chosen_ctr.violation_ += step_length * chosen_ctr_dot_primal_step_direction;
 
+                        if (chosen_ctr.saturated_)
+                        {
+                            // the constraint is activated with its original
+                            // orientation
+                            factorization_data_.d = - factorization_data_.d;
+                        }
                         if (false == factorization_data_.update(active_set_.size_, param.tolerance_))
                         {
-                            QPMAD_THROW("Failed to add an inequality constraint -- is this possible?");
+                            QPMAD_FAIL(NUMERICAL_FAILURE, "Failed to add an inequality constraint -- is this possible?");
                         }
 
                         QPMAD_TRACE("||| Chosen ctr dual = " << chosen_ctr.dual_);
                         QPMAD_TRACE("||| Chosen ctr violation = " << chosen_ctr.violation_);
 
 
-                        if ((partial_step)
-                            // if violation is almost zero -- assume that a full step is made
+                        if ((saturation_step)
                             && (std::abs(chosen_ctr.violation_) > param.tolerance_) )
                         {
-                            QPMAD_TRACE("||| PARTIAL STEP");
-                            // deactivate blocking constraint
-                            general_constraints_status_[ active_set_.getIndex(dual_blocking_index) ] = ConstraintStatus::INACTIVE;
-
-                            dropElementWithoutResize(dual_, dual_blocking_index, active_set_.size_);
-
-                            factorization_data_.downdate(dual_blocking_index, active_set_.size_, param.tolerance_);
+                            QPMAD_TRACE("||| SATURATION STEP");
+                            QPMAD_TRACE_EVENT(PARTIAL_STEP, chosen_ctr.index_, step_length);
+                            saturateConstraint(chosen_ctr);
 
-                            active_set_.removeInequality(dual_blocking_index);
+                            chosen_ctr = chooseConstraint(primal, lb, ub, A, Alb, Aub, param);
+                            QPMAD_TRACE_EVENT(CONSTRAINT_CHOSEN, chosen_ctr.index_, chosen_ctr.violation_);
                         }
                         else
                         {
-                            QPMAD_TRACE("||| FULL STEP");
-                            // activate constraint
-                            general_constraints_status_[chosen_ctr.index_] = chosen_ctr.type_;
-                            dual_(active_set_.size_) = chosen_ctr.dual_;
-                            active_set_.addInequality(chosen_ctr.index_);
+                            if ((partial_step)
+                                // if violation is almost zero -- assume that a full step is made
+                                && (std::abs(chosen_ctr.violation_) > param.tolerance_) )
+                            {
+                                QPMAD_TRACE("||| PARTIAL STEP");
+                                QPMAD_TRACE_EVENT(PARTIAL_STEP, chosen_ctr.index_, step_length);
+                                deactivateConstraint(dual_blocking_index, dual_blocking_saturated, param.tolerance_);
+                            }
+                            else
+                            {
+                                QPMAD_TRACE("||| FULL STEP");
+                                QPMAD_TRACE_EVENT(FULL_STEP, chosen_ctr.index_, step_length);
+                                // activate constraint
+                                if (chosen_ctr.saturated_)
+                                {
+                                    // the force of the saturated constraint
+                                    // is partially compensated
+                                    constraints_status_[chosen_ctr.index_] =
+                                        (ConstraintStatus::ACTIVE_LOWER_BOUND == chosen_ctr.type_)
+                                        ? ConstraintStatus::ACTIVE_UPPER_BOUND
+                                        : ConstraintStatus::ACTIVE_LOWER_BOUND;
+                                    dual_(active_set_.size_) = getConstraintWeight(chosen_ctr.index_) - chosen_ctr.dual_;
+                                }
+                                else
+                                {
+                                    constraints_status_[chosen_ctr.index_] = chosen_ctr.type_;
+                                    dual_(active_set_.size_) = chosen_ctr.dual_;
+                                }
+                                active_set_.addInequality(chosen_ctr.index_);
 
-                            chosen_ctr = chooseConstraint(primal, A, Alb, Aub, param.tolerance_);
+                                chosen_ctr = chooseConstraint(primal, lb, ub, A, Alb, Aub, param);
+                                QPMAD_TRACE_EVENT(CONSTRAINT_CHOSEN, chosen_ctr.index_, chosen_ctr.violation_);
+                                activate_block = use_block_activation;
+                            }
                         }
                     }
                     else
                     {
-                        if (dual_blocking_index == primal_size_)
-                        {
-                            return_status = INFEASIBLE_INEQUALITY;
-                            break;
-                        }
-                        else
+                        if (chosen_ctr_dual_step_length < dual_step_length)
                         {
-                            QPMAD_TRACE("======================");
-                            QPMAD_TRACE("||| Dual step length = " << dual_step_length);
-                            QPMAD_TRACE("======================");
-
-                            // otherwise -- deactivate
+                            QPMAD_TRACE("||| SATURATION STEP");
+                            QPMAD_TRACE_EVENT(PARTIAL_STEP, chosen_ctr.index_, chosen_ctr_dual_step_length);
                             dual_.segment(active_set_.num_equalities_, active_set_.num_inequalities_).noalias()
-                                += dual_step_length
+                                += chosen_ctr_dual_step_length
                                     * dual_step_direction_.segment(active_set_.num_equalities_, active_set_.num_inequalities_);
-                            chosen_ctr.dual_ += dual_step_length;
-
-                            general_constraints_status_[ active_set_.getIndex(dual_blocking_index) ] = ConstraintStatus::INACTIVE;
-
-                            dropElementWithoutResize(dual_, dual_blocking_index, active_set_.size_);
+                            saturateConstraint(chosen_ctr);
 
-                            factorization_data_.downdate(dual_blocking_index, active_set_.size_, param.tolerance_);
-
-                            active_set_.removeInequality(dual_blocking_index);
+                            chosen_ctr = chooseConstraint(primal, lb, ub, A, Alb, Aub, param);
+                            QPMAD_TRACE_EVENT(CONSTRAINT_CHOSEN, chosen_ctr.index_, chosen_ctr.violation_);
+                        }
+                        else
+                        {
+                            if (dual_blocking_index == primal_size_)
+                            {
+                                return_status = INFEASIBLE_INEQUALITY;
+                                break;
+                            }
+                            else
+                            {
+                                QPMAD_TRACE("======================");
+                                QPMAD_TRACE("||| Dual step length = " << dual_step_length);
+                                QPMAD_TRACE("======================");
+
+                                // otherwise -- deactivate
+                                QPMAD_TRACE_EVENT(PARTIAL_STEP, chosen_ctr.index_, dual_step_length);
+                                dual_.segment(active_set_.num_equalities_, active_set_.num_inequalities_).noalias()
+                                    += dual_step_length
+                                        * dual_step_direction_.segment(active_set_.num_equalities_, active_set_.num_inequalities_);
+                                chosen_ctr.dual_ += dual_step_length;
+
+                                deactivateConstraint(dual_blocking_index, dual_blocking_saturated, param.tolerance_);
+                            }
                         }
                     }
                 }
@@ -352,12 +3402,13 @@ namespace qpmad
 #ifdef QPMAD_ENABLE_TRACING
                 if (machinery_initialized_)
                 {
-                    testing::printActiveSet(active_set_, general_constraints_status_, dual_);
+                    testing::printActiveSet(active_set_, constraints_status_, dual_);
 
                     testing::checkLagrangeMultipliers(
-                            H, h, primal, A,
+                            testing::computeHessian(H, param.hessian_type_), h, primal, A,
                             active_set_,
-                            general_constraints_status_,
+                            num_simple_bounds_,
+                            constraints_status_,
                             dual_);
                 }
                 else
@@ -369,103 +3420,345 @@ namespace qpmad
             }
 
 
-        private:
-            class ChosenConstraint
+            /**
+             * @brief Remove an inequality from the active set: its
+             * multiplier is either zero or, if 'saturate' is set, equal to
+             * the weight of the soft constraint, which is kept constant.
+             */
+            void deactivateConstraint(  const MatrixIndex   index,
+                                        const bool          saturate,
+                                        const double        tolerance)
             {
-                public:
-                    double                      violation_;
-                    double                      dual_;
-                    MatrixIndex                 index_;
-                    ConstraintStatus::Status    type_;
+                const MatrixIndex ctr_index = active_set_.getIndex(index);
 
-                public:
-                    ChosenConstraint()
-                    {
-                        dual_ = 0.0;
-                        violation_ = 0.0;
-                        index_ = 0;
-                        type_ = ConstraintStatus::UNDEFINED;
-                    }
-            };
+                QPMAD_TRACE_EVENT(DOWNDATE, ctr_index, dual_(index));
+                if (saturate)
+                {
+                    constraints_status_[ctr_index] =    (ConstraintStatus::ACTIVE_LOWER_BOUND == constraints_status_[ctr_index])
+                                                        ? ConstraintStatus::SATURATED_LOWER_BOUND
+                                                        : ConstraintStatus::SATURATED_UPPER_BOUND;
+                }
+                else
+                {
+                    constraints_status_[ctr_index] = ConstraintStatus::INACTIVE;
+                }
 
+                dropElementWithoutResize(dual_, index, active_set_.size_);
 
-        private:
-            bool        machinery_initialized_;
+                factorization_data_.downdate(index, active_set_.size_, tolerance);
+
+                active_set_.removeInequality(index);
+            }
 
-            ActiveSet           active_set_;
-            FactorizationData   factorization_data_;
 
-            QPVector    dual_;
+            /**
+             * @brief The multiplier of the chosen soft constraint has
+             * reached its weight before the violation is eliminated.
+             */
+            void saturateConstraint(const ChosenConstraint & chosen_ctr)
+            {
+                if (chosen_ctr.saturated_)
+                {
+                    // the force of the saturated constraint is compensated
+                    constraints_status_[chosen_ctr.index_] = ConstraintStatus::INACTIVE;
+                }
+                else
+                {
+                    constraints_status_[chosen_ctr.index_] =    (ConstraintStatus::ACTIVE_LOWER_BOUND == chosen_ctr.type_)
+                                                                ? ConstraintStatus::SATURATED_LOWER_BOUND
+                                                                : ConstraintStatus::SATURATED_UPPER_BOUND;
+                }
+            }
 
-            QPVector    primal_step_direction_;
-            QPVector    dual_step_direction_;
 
-            std::vector<ConstraintStatus::Status>   general_constraints_status_;
+            /// Weight of a soft constraint, infinity for hard constraints
+            double getConstraintWeight(const MatrixIndex ctr_index) const
+            {
+                if ((soft_constraints_) && (ctr_index >= num_simple_bounds_))
+                {
+                    return (soft_constraint_weights_(ctr_index - num_simple_bounds_));
+                }
+                return (std::numeric_limits<double>::infinity());
+            }
 
 
-        private:
-            template <class t_MatrixType>
-                void initializeMachineryLazy(const t_MatrixType &H)
+            /**
+             * @brief A saturated soft constraint, which is not violated
+             * anymore, is chosen in the same way as a violated constraint
+             * with the opposite orientation: its multiplier is decreased
+             * by a dual step.
+             */
+            void checkSaturatedConstraint(  ChosenConstraint        & chosen_ctr,
+                                            const MatrixIndex       ctr_index,
+                                            const double            lb_i,
+                                            const double            ub_i,
+                                            const double            ctr_i_dot_primal,
+                                            const double            tolerance)
             {
-                if (false == machinery_initialized_)
+                double ctr_violation_i;
+
+                if (ConstraintStatus::SATURATED_LOWER_BOUND == constraints_status_[ctr_index])
+                {
+                    ctr_violation_i = ctr_i_dot_primal - lb_i;
+                    if ((ctr_violation_i > tolerance) && (std::abs(ctr_violation_i) > std::abs(chosen_ctr.violation_)))
+                    {
+                        chosen_ctr.type_ = ConstraintStatus::ACTIVE_UPPER_BOUND;
+                        chosen_ctr.violation_ = ctr_violation_i;
+                        chosen_ctr.index_ = ctr_index;
+                        chosen_ctr.saturated_ = true;
+                    }
+                }
+                else
                 {
-                    active_set_.initialize(primal_size_);
-                    factorization_data_.initialize(H, primal_size_);
-                    primal_step_direction_.resize(primal_size_);
+                    ctr_violation_i = ctr_i_dot_primal - ub_i;
+                    if ((ctr_violation_i < -tolerance) && (std::abs(ctr_violation_i) > std::abs(chosen_ctr.violation_)))
+                    {
+                        chosen_ctr.type_ = ConstraintStatus::ACTIVE_LOWER_BOUND;
+                        chosen_ctr.violation_ = ctr_violation_i;
+                        chosen_ctr.index_ = ctr_index;
+                        chosen_ctr.saturated_ = true;
+                    }
+                }
+            }
 
-                    machinery_initialized_ = true;
+
+            void checkConstraintViolation(  ChosenConstraint        & chosen_ctr,
+                                            const MatrixIndex       ctr_index,
+                                            const double            lb_i,
+                                            const double            ub_i,
+                                            const double            ctr_i_dot_primal,
+                                            const double            tolerance)
+            {
+                double ctr_violation_i;
+
+                if (lb_i - tolerance > ctr_i_dot_primal)
+                {
+                    constraints_status_[ctr_index] = ConstraintStatus::VIOLATED;
+                    ctr_violation_i = ctr_i_dot_primal - lb_i;
+                    if (std::abs(ctr_violation_i) > std::abs(chosen_ctr.violation_))
+                    {
+                        chosen_ctr.type_ = ConstraintStatus::ACTIVE_LOWER_BOUND;
+                        chosen_ctr.violation_ = ctr_violation_i;
+                        chosen_ctr.index_ = ctr_index;
+                        chosen_ctr.saturated_ = false;
+                    }
+                }
+                else
+                {
+                    if (ub_i + tolerance < ctr_i_dot_primal)
+                    {
+                        constraints_status_[ctr_index] = ConstraintStatus::VIOLATED;
+                        ctr_violation_i = ctr_i_dot_primal - ub_i;
+                        if (std::abs(ctr_violation_i) > std::abs(chosen_ctr.violation_))
+                        {
+                            chosen_ctr.type_ = ConstraintStatus::ACTIVE_UPPER_BOUND;
+                            chosen_ctr.violation_ = ctr_violation_i;
+                            chosen_ctr.index_ = ctr_index;
+                            chosen_ctr.saturated_ = false;
+                        }
+                    }
+                    else
+                    {
+                        constraints_status_[ctr_index] = ConstraintStatus::INACTIVE;
+                    }
                 }
             }
 
 
-            ChosenConstraint chooseConstraint(
-                    const QPVector & primal,
-                    const QPMatrix & A,
-                    const QPVector & Alb,
-                    const QPVector & Aub,
-                    const double tolerance)
+            template<   class t_primal,
+                        class t_lb,
+                        class t_ub,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                ChosenConstraint chooseConstraint(
+                        const Eigen::MatrixBase<t_primal>   & primal,
+                        const Eigen::MatrixBase<t_lb>       & lb,
+                        const Eigen::MatrixBase<t_ub>       & ub,
+                        const Eigen::MatrixBase<t_A>        & A,
+                        const Eigen::MatrixBase<t_Alb>      & Alb,
+                        const Eigen::MatrixBase<t_Aub>      & Aub,
+                        const SolverParameters              & param)
             {
                 ChosenConstraint chosen_ctr;
 
-                for(MatrixIndex i = 0; i < num_general_constraints_; ++i)
+                for(MatrixIndex i = 0; i < num_simple_bounds_; ++i)
+                {
+                    if ( (ConstraintStatus::INACTIVE == constraints_status_[i])
+                        || (ConstraintStatus::VIOLATED == constraints_status_[i]) )
+                    {
+                        checkConstraintViolation(chosen_ctr, i, lb(i), ub(i), primal(i), param.tolerance_);
+                    }
+                }
+
+                if (NULL != oracle_)
+                {
+                    chooseOracleConstraint(chosen_ctr, primal, param.tolerance_);
+                    return (chosen_ctr);
+                }
+
+
+#ifdef QPMAD_USE_OPENMP
+                if (param.num_threads_ > 1)
                 {
-                    if ( (ConstraintStatus::INACTIVE == general_constraints_status_[i])
-                        || (ConstraintStatus::VIOLATED == general_constraints_status_[i]) )
+                    int num_used_threads = 1;
+
+                    #pragma omp parallel num_threads(param.num_threads_)
                     {
-                        double ctr_violation_i = A.row(i) * primal;
+                        const int thread_index = omp_get_thread_num();
+                        const int num_threads = omp_get_num_threads();
 
-                        if (Alb(i) - tolerance > ctr_violation_i)
+                        if (0 == thread_index)
                         {
-                            general_constraints_status_[i] = ConstraintStatus::VIOLATED;
-                            ctr_violation_i -= Alb(i);
-                            if (std::abs(ctr_violation_i) > std::abs(chosen_ctr.violation_))
-                            {
-                                chosen_ctr.type_ = ConstraintStatus::ACTIVE_LOWER_BOUND;
-                                chosen_ctr.violation_ = ctr_violation_i;
-                                chosen_ctr.index_ = i;
-                            }
+                            num_used_threads = num_threads;
                         }
-                        else
+
+                        // results are stored once to avoid false sharing
+                        ChosenConstraint thread_chosen_ctr;
+                        chooseGeneralConstraint(thread_chosen_ctr,
+                                                primal,
+                                                A,
+                                                Alb,
+                                                Aub,
+                                                (num_general_constraints_ * thread_index) / num_threads,
+                                                (num_general_constraints_ * (thread_index + 1)) / num_threads,
+                                                param.tolerance_);
+                        thread_chosen_ctr_[thread_index] = thread_chosen_ctr;
+                    }
+
+                    // Threads process contiguous ranges of rows, merging them
+                    // in the order of threads with the same strict comparison
+                    // yields the constraint chosen by the serial version.
+                    for (int i = 0; i < num_used_threads; ++i)
+                    {
+                        if (std::abs(thread_chosen_ctr_[i].violation_) > std::abs(chosen_ctr.violation_))
                         {
-                            if (Aub(i) + tolerance < ctr_violation_i)
-                            {
-                                general_constraints_status_[i] = ConstraintStatus::VIOLATED;
-                                ctr_violation_i -= Aub(i);
-                                if (std::abs(ctr_violation_i) > std::abs(chosen_ctr.violation_))
-                                {
-                                    chosen_ctr.type_ = ConstraintStatus::ACTIVE_UPPER_BOUND;
-                                    chosen_ctr.violation_ = ctr_violation_i;
-                                    chosen_ctr.index_ = i;
-                                }
-                            }
-                            else
-                            {
-                                general_constraints_status_[i] = ConstraintStatus::INACTIVE;
-                            }
+                            chosen_ctr = thread_chosen_ctr_[i];
                         }
                     }
+
+                    return (chosen_ctr);
                 }
+#endif
+
+                chooseGeneralConstraint(chosen_ctr, primal, A, Alb, Aub, 0, num_general_constraints_, param.tolerance_);
+
                 return (chosen_ctr);
             }
+
+
+            /**
+             * @brief Query the oracle for the most violated general
+             * constraint and store it in a free slot, it replaces
+             * 'chosen_ctr' if its violation is strictly larger. The index
+             * of 'chosen_ctr' is set to num_constraints_ if there are no
+             * free slots.
+             */
+            template<class t_primal>
+                void chooseOracleConstraint(ChosenConstraint                    & chosen_ctr,
+                                            const Eigen::MatrixBase<t_primal>   & primal,
+                                            const double                        tolerance)
+            {
+                // constraints are chosen after full steps only, so all
+                // inactive slots are free
+                MatrixIndex slot = 0;
+                for (; slot < num_general_constraints_; ++slot)
+                {
+                    const ConstraintStatus::Status status = constraints_status_[num_simple_bounds_ + slot];
+                    if ( (ConstraintStatus::INACTIVE == status)
+                        || (ConstraintStatus::VIOLATED == status) )
+                    {
+                        break;
+                    }
+                }
+                if (slot == num_general_constraints_)
+                {
+                    // reported by iterate()
+                    chosen_ctr.index_ = num_constraints_;
+                    return;
+                }
+
+
+                double lb_i = -std::numeric_limits<double>::infinity();
+                double ub_i = std::numeric_limits<double>::infinity();
+                if (oracle_->getMostViolatedConstraint(primal, tolerance, oracle_constraints_.col(slot), lb_i, ub_i))
+                {
+                    if (lb_i - tolerance > ub_i)
+                    {
+                        // reported by iterate()
+                        chosen_ctr.index_ = num_simple_bounds_ + slot;
+                        chosen_ctr.type_ = ConstraintStatus::INCONSISTENT;
+                        return;
+                    }
+
+                    oracle_lb_(slot) = lb_i;
+                    oracle_ub_(slot) = ub_i;
+                    checkConstraintViolation(   chosen_ctr,
+                                                num_simple_bounds_ + slot,
+                                                lb_i,
+                                                ub_i,
+                                                oracle_constraints_.col(slot).dot(primal),
+                                                tolerance);
+                }
+            }
+
+
+            /**
+             * @brief Check general constraints [begin, end), the most
+             * violated constraint replaces 'chosen_ctr' if its violation is
+             * strictly larger, i.e., the lowest index wins on ties.
+             */
+            template<   class t_primal,
+                        class t_A,
+                        class t_Alb,
+                        class t_Aub>
+                void chooseGeneralConstraint(
+                        ChosenConstraint                    & chosen_ctr,
+                        const Eigen::MatrixBase<t_primal>   & primal,
+                        const Eigen::MatrixBase<t_A>        & A,
+                        const Eigen::MatrixBase<t_Alb>      & Alb,
+                        const Eigen::MatrixBase<t_Aub>      & Aub,
+                        const MatrixIndex                   begin,
+                        const MatrixIndex                   end,
+                        const double                        tolerance)
+            {
+                if (end > begin)
+                {
+                    // a single matrix-vector product is cheaper than a dot
+                    // product per row for column-major A
+                    general_ctr_dot_primal_.segment(begin, end - begin).noalias() = A.middleRows(begin, end - begin) * primal;
+                }
+
+                for(MatrixIndex i = begin; i < end; ++i)
+                {
+                    const MatrixIndex ctr_index = num_simple_bounds_ + i;
+
+                    switch (constraints_status_[ctr_index])
+                    {
+                        case ConstraintStatus::INACTIVE:
+                        case ConstraintStatus::VIOLATED:
+                            checkConstraintViolation(   chosen_ctr,
+                                                        ctr_index,
+                                                        Alb(i),
+                                                        Aub(i),
+                                                        general_ctr_dot_primal_(i),
+                                                        tolerance);
+                            break;
+
+                        case ConstraintStatus::SATURATED_LOWER_BOUND:
+                        case ConstraintStatus::SATURATED_UPPER_BOUND:
+                            checkSaturatedConstraint(   chosen_ctr,
+                                                        ctr_index,
+                                                        Alb(i),
+                                                        Aub(i),
+                                                        general_ctr_dot_primal_(i),
+                                                        tolerance);
+                            break;
+
+                        default:
+                            break;
+                    }
+                }
+            }
     };
 }
@@ -19,27 +19,129 @@ namespace qpmad
             {
                 UNDEFINED                   = 0,
                 HESSIAN_LOWER_TRIANGULAR    = 1,
-                HESSIAN_CHOLESKY_FACTOR     = 2
+                HESSIAN_CHOLESKY_FACTOR     = 2,
+                /// J, such that J * J^T = H^-1, e.g., L^-T or a factor
+                /// updated with HessianUpdate.
+                HESSIAN_INVERTED_CHOLESKY_FACTOR = 3
                 //HESSIAN_DIAGONAL         = 1,
             };
 
 
+            enum Method
+            {
+                /// Goldfarb-Idnani dual active set method
+                METHOD_DUAL     = 0,
+                /// Primal active set method started from a feasible point
+                METHOD_PRIMAL   = 1
+            };
+
+
         public:
             HessianType     hessian_type_;
 
+            /// The primal method requires a feasible starting point given
+            /// in the 'primal' argument of solve(), all iterates are
+            /// feasible, i.e., the solution is feasible even if the
+            /// iteration limit is reached. The initial active set consists
+            /// of equality constraints and constraints selected by
+            /// warm_start_ or crash_. The dual method is used if the
+            /// starting point is missing or infeasible, in the
+            /// cutting-plane mode, with soft constraints and by resume().
+            Method          method_;
+
             double          tolerance_;
 
             int             max_iter_;
 
+            /// Start from the active set of the previous call to solve(),
+            /// which is useful when a sequence of similar problems is solved.
+            bool            warm_start_;
+
+            /// Guess the initial active set from an approximate solution
+            /// given in the 'primal' argument of solve() (crash procedure):
+            /// constraints, which are violated or whose slack is below
+            /// crash_tolerance_ at this point, are activated before
+            /// iterations and those with negative Lagrange multipliers are
+            /// dropped. Takes precedence over warm_start_, ignored if the
+            /// size of 'primal' does not match the problem.
+            bool            crash_;
+            double          crash_tolerance_;
+
+            /// Maximal number of active constraints, negative value means
+            /// the number of variables. Memory used by the factorization is
+            /// reduced from 2*n^2 to n^2 + k^2, solve() returns
+            /// MAXIMAL_ACTIVE_SET_SIZE if more constraints must be active.
+            int             max_active_set_size_;
+
+            /// Number of threads used to check general constraints, which
+            /// pays off only for a large number of constraints. Requires
+            /// QPMAD_USE_OPENMP, ignored otherwise. The result does not
+            /// depend on the number of threads. Each thread needs a few
+            /// bytes in the workspace, see Solver::getWorkspaceSize().
+            int             num_threads_;
+
+            /// Maximal number of violated constraints, which are activated
+            /// at once when the solver is at the minimizer of the objective
+            /// subject to the active constraints, e.g., after a cold start.
+            /// The default value 1 disables block activation, which
+            /// requires additional memory in the workspace, see
+            /// Solver::getWorkspaceSize(), and is not supported in the
+            /// cutting-plane mode.
+            int             max_block_size_;
+
+            /// Drift of the factorization, which accumulates over many
+            /// updates, e.g., in a long sequence of calls to
+            /// Solver::resume(), is estimated after every
+            /// drift_check_period_ updates and downdates, nonpositive
+            /// value disables the checks. The estimate is the larger of
+            /// the orthogonality error of J with respect to H and the
+            /// residual of J^T * N = [R; 0] for the sum of active normals,
+            /// both are computed with a few matrix-vector products. J and
+            /// R are recomputed from the active set if the estimate
+            /// exceeds drift_tolerance_.
+            int             drift_check_period_;
+            double          drift_tolerance_;
+
+            /// Check sizes of the input and weights of soft constraints.
+            /// Callers, which validate problems once and solve them
+            /// repeatedly, e.g., in a real-time loop, may skip the checks,
+            /// invalid input leads to undefined behavior in this case.
+            /// Consistency of bounds is always checked.
+            bool            check_input_;
+            /// Number of the most recently used entries of the
+            /// factorization cache, which are tried by Solver::solve() in
+            /// addition to the active set selected by warm_start_ or
+            /// crash_, see FactorizationCache for the cost of a miss.
+            int             max_cache_candidates_;
+
 
         public:
             SolverParameters()
             {
                 hessian_type_ = HESSIAN_LOWER_TRIANGULAR;
 
+                method_ = METHOD_DUAL;
+
                 tolerance_ = 1e-12;
 
                 max_iter_ = -1;
+
+                warm_start_ = false;
+
+                crash_ = false;
+                crash_tolerance_ = 1e-6;
+
+                max_active_set_size_ = -1;
+
+                num_threads_ = 1;
+
+                max_block_size_ = 1;
+
+                drift_check_period_ = 0;
+                drift_tolerance_ = 1e-10;
+
+                check_input_ = true;
+                max_cache_candidates_ = 4;
             }
     };
 }
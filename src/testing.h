@@ -18,13 +18,34 @@ namespace qpmad
 {
     namespace testing
     {
-        double computeObjective(const Eigen::MatrixXd   &H,
-                                const Eigen::VectorXd   &h,
-                                const Eigen::VectorXd   &primal)
+        /**
+         * @brief Restore the Hessian from its factor, which is passed to
+         * the solver.
+         */
+        template<class t_H>
+            Eigen::MatrixXd computeHessian( const Eigen::MatrixBase<t_H>        &H,
+                                            const SolverParameters::HessianType hessian_type)
         {
-            Eigen::MatrixXd     L = H.triangularView<Eigen::Lower>();
+            if (SolverParameters::HESSIAN_INVERTED_CHOLESKY_FACTOR == hessian_type)
+            {
+                return ((H * H.transpose()).inverse());
+            }
+            else
+            {
+                Eigen::MatrixXd     L = H.template triangularView<Eigen::Lower>();
+                return (L * L.transpose());
+            }
+        }
+
 
-            double result = 0.5 * primal.transpose() * L * L.transpose() * primal;
+        template<   class t_H,
+                    class t_h,
+                    class t_primal>
+            double computeObjective(const Eigen::MatrixBase<t_H>        &H,
+                                    const Eigen::MatrixBase<t_h>        &h,
+                                    const Eigen::MatrixBase<t_primal>   &primal)
+        {
+            double result = 0.5 * primal.transpose() * H * primal;
 
             if (h.rows() > 0)
             {
@@ -37,17 +58,21 @@ namespace qpmad
         }
 
 
-        void checkLagrangeMultipliers(  const Eigen::MatrixXd   &H,
-                                        const Eigen::VectorXd   &h,
-                                        const Eigen::VectorXd   &primal,
-                                        const Eigen::MatrixXd   &A,
-                                        const ActiveSet         &active_set,
-                                        const std::vector<ConstraintStatus::Status> & general_constraints_status,
-                                        const Eigen::VectorXd                       & dual,
-                                        const Eigen::VectorXd                       & dual_direction = Eigen::VectorXd())
+        template<   class t_H,
+                    class t_h,
+                    class t_primal,
+                    class t_A>
+            void checkLagrangeMultipliers(  const Eigen::MatrixBase<t_H>        &H,
+                                            const Eigen::MatrixBase<t_h>        &h,
+                                            const Eigen::MatrixBase<t_primal>   &primal,
+                                            const Eigen::MatrixBase<t_A>        &A,
+                                            const ActiveSet         &active_set,
+                                            const MatrixIndex       num_simple_bounds,
+                                            const ConstraintStatus::Status  *constraints_status,
+                                            const Eigen::VectorXd   &dual,
+                                            const Eigen::VectorXd   &dual_direction = Eigen::VectorXd())
         {
-            Eigen::MatrixXd     L = H.triangularView<Eigen::Lower>();
-            Eigen::VectorXd     v = L * L.transpose() * primal;
+            Eigen::VectorXd     v = H * primal;
             Eigen::MatrixXd     M;
 
             if (h.rows() > 0)
@@ -61,14 +86,23 @@ namespace qpmad
             {
                 MatrixIndex ctr_index = active_set.getIndex(i);
 
-                switch(general_constraints_status[ctr_index])
+                if (ctr_index < num_simple_bounds)
+                {
+                    M.col(i).setZero();
+                    M(ctr_index, i) = 1.0;
+                }
+                else
+                {
+                    M.col(i) = A.row(ctr_index - num_simple_bounds).transpose();
+                }
+
+                switch(constraints_status[ctr_index])
                 {
                     case ConstraintStatus::ACTIVE_LOWER_BOUND:
-                        M.col(i) = -A.row(ctr_index).transpose();
+                        M.col(i) = -M.col(i);
                         break;
                     case ConstraintStatus::ACTIVE_UPPER_BOUND:
                     case ConstraintStatus::EQUALITY:
-                        M.col(i) = A.row(ctr_index).transpose();
                         break;
                     default:
                         break;
@@ -85,7 +119,7 @@ namespace qpmad
                 {
                     MatrixIndex ctr_index = active_set.getIndex(i);
                     std::cout   << " " << i;
-                    switch(general_constraints_status[ctr_index])
+                    switch(constraints_status[ctr_index])
                     {
                         case ConstraintStatus::ACTIVE_LOWER_BOUND:
                             std::cout   << "L ";
@@ -104,7 +138,7 @@ namespace qpmad
                                 << "ref " << dual_check(i) << " | ";
 
 
-                    switch(general_constraints_status[ctr_index])
+                    switch(constraints_status[ctr_index])
                     {
                         case ConstraintStatus::ACTIVE_LOWER_BOUND:
                         case ConstraintStatus::ACTIVE_UPPER_BOUND:
@@ -139,9 +173,9 @@ namespace qpmad
         }
 
 
-        void printActiveSet(const ActiveSet                             & active_set,
-                            const std::vector<ConstraintStatus::Status> & general_constraints_status,
-                            const Eigen::VectorXd                       & dual)
+        inline void printActiveSet( const ActiveSet                             & active_set,
+                                    const ConstraintStatus::Status              * constraints_status,
+                                    const Eigen::VectorXd                       & dual)
         {
             std::cout << "====================================[Active set]================================" << std::endl;
             for (MatrixIndex i = active_set.num_equalities_; i < active_set.size_; ++i)
@@ -150,7 +184,7 @@ namespace qpmad
 
                 std::cout   << " ## " << i
                             << " ## | Index = " << active_ctr_index
-                            << " | Type = " << general_constraints_status[active_ctr_index]
+                            << " | Type = " << constraints_status[active_ctr_index]
                             << " | Dual = " << dual(i)
                             << std::endl;
             }
@@ -0,0 +1,147 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace qpmad
+{
+    /**
+     * @brief Memory block used by the solver for its internal data.
+     *
+     * The block is either owned and grown on demand, or provided by the
+     * user, in which case it is never reallocated. Chunks of the block
+     * are handed out sequentially by allocate(), all chunks are aligned to
+     * QPMAD_WORKSPACE_ALIGNMENT bytes.
+     */
+    class Workspace
+    {
+        public:
+            Workspace()
+            {
+                owned_data_ = NULL;
+                data_ = NULL;
+                size_ = 0;
+                offset_ = 0;
+                is_external_ = false;
+            }
+
+
+            ~Workspace()
+            {
+                std::free(owned_data_);
+            }
+
+
+            /**
+             * @brief Use an external memory block, which must be aligned
+             * to QPMAD_WORKSPACE_ALIGNMENT bytes and outlive the workspace.
+             *
+             * @return false if the block is not aligned.
+             */
+            bool setExternal(void *data, const std::size_t size)
+            {
+                if (0 != reinterpret_cast<std::size_t>(data) % QPMAD_WORKSPACE_ALIGNMENT)
+                {
+                    return (false);
+                }
+
+                std::free(owned_data_);
+                owned_data_ = NULL;
+
+                data_ = static_cast<char *>(data);
+                size_ = size;
+                offset_ = 0;
+                is_external_ = true;
+
+                return (true);
+            }
+
+
+            /**
+             * @brief Make sure that at least 'size' bytes are available and
+             * restart allocation from the beginning of the block.
+             *
+             * Owned memory is reallocated only if it is too small, the
+             * content is preserved in both cases.
+             *
+             * @return false if an external block is too small.
+             */
+            bool reserve(const std::size_t size)
+            {
+                offset_ = 0;
+
+                if (size <= size_)
+                {
+                    return (true);
+                }
+
+                if (is_external_)
+                {
+                    return (false);
+                }
+
+                char *new_owned_data = static_cast<char *>(std::malloc(size + QPMAD_WORKSPACE_ALIGNMENT));
+                if (NULL == new_owned_data)
+                {
+                    return (false);
+                }
+
+                char *new_data =    new_owned_data
+                                    + (QPMAD_WORKSPACE_ALIGNMENT
+                                        - reinterpret_cast<std::size_t>(new_owned_data) % QPMAD_WORKSPACE_ALIGNMENT);
+                if (size_ > 0)
+                {
+                    std::memcpy(new_data, data_, size_);
+                }
+
+                std::free(owned_data_);
+                owned_data_ = new_owned_data;
+                data_ = new_data;
+                size_ = size;
+
+                return (true);
+            }
+
+
+            template<class t_Type>
+                t_Type * allocate(const std::size_t num_elements)
+            {
+                t_Type * chunk = reinterpret_cast<t_Type *>(data_ + offset_);
+                offset_ += getChunkSize<t_Type>(num_elements);
+                return (chunk);
+            }
+
+
+            /// Size of a chunk including alignment padding
+            template<class t_Type>
+                static std::size_t getChunkSize(const std::size_t num_elements)
+            {
+                const std::size_t size = num_elements * sizeof(t_Type);
+                return (size + (QPMAD_WORKSPACE_ALIGNMENT - size % QPMAD_WORKSPACE_ALIGNMENT) % QPMAD_WORKSPACE_ALIGNMENT);
+            }
+
+
+        private:
+            char            *owned_data_;
+            char            *data_;
+            std::size_t     size_;
+            std::size_t     offset_;
+            bool            is_external_;
+
+
+        private:
+            Workspace(const Workspace &);
+            Workspace & operator=(const Workspace &);
+    };
+}
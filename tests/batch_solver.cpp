@@ -0,0 +1,229 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#include "utf_common.h"
+#include "qp_generator.h"
+
+
+#include "../src/solver.h"
+#include "../src/batch_solver.h"
+
+
+class BatchSolverFixture
+{
+    public:
+        std::vector<Eigen::MatrixXd>    H;
+        std::vector<Eigen::VectorXd>    h;
+        std::vector<Eigen::MatrixXd>    A;
+        std::vector<Eigen::VectorXd>    Alb;
+        std::vector<Eigen::VectorXd>    Aub;
+
+        Eigen::VectorXd                 x;
+        Eigen::VectorXd                 x_ref;
+        Eigen::MatrixXd                 H_copy;
+
+        qpmad::Solver                   solver;
+        qpmad::Solver::ReturnStatus     status;
+
+
+    public:
+        void generateProblems(  const qpmad::MatrixIndex num_problems,
+                                const qpmad::MatrixIndex size,
+                                const qpmad::MatrixIndex num_ctr)
+        {
+            H.resize(num_problems);
+            h.resize(num_problems);
+            A.resize(num_problems);
+            Alb.resize(num_problems);
+            Aub.resize(num_problems);
+
+            for (qpmad::MatrixIndex i = 0; i < num_problems; ++i)
+            {
+                getRandomPositiveDefinititeMatrix(H[i], size);
+                h[i].setRandom(size);
+                A[i].setRandom(num_ctr, size);
+                Alb[i].setConstant(num_ctr, -0.1);
+                Aub[i].setConstant(num_ctr, 0.1);
+            }
+        }
+
+
+        template<int t_num_lanes>
+            void checkBatch(qpmad::BatchSolver<t_num_lanes> & batch_solver)
+        {
+            const qpmad::MatrixIndex num_problems = H.size();
+
+            batch_solver.initialize(num_problems, H[0].rows(), A[0].rows());
+            for (qpmad::MatrixIndex i = 0; i < num_problems; ++i)
+            {
+                batch_solver.setProblem(i, H[i], h[i], A[i], Alb[i], Aub[i]);
+            }
+            batch_solver.solve();
+
+            for (qpmad::MatrixIndex i = 0; i < num_problems; ++i)
+            {
+                H_copy = H[i];
+                status = solver.solve(x_ref, H_copy, h[i], A[i], Alb[i], Aub[i]);
+
+                BOOST_CHECK_EQUAL(batch_solver.getStatus(i), status);
+                if (qpmad::Solver::OK == status)
+                {
+                    batch_solver.getPrimal(i, x);
+                    BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+                }
+            }
+        }
+
+
+        /// Compare time of batch and sequential solution of generated
+        /// problems with known solutions, the number of active
+        /// constraints is increased by up to num_active_spread.
+        template<int t_num_lanes>
+            void compareTimeWithSolver( const QPGeneratorParameters     & generator_param,
+                                        const qpmad::MatrixIndex        num_problems,
+                                        const qpmad::MatrixIndex        num_active_spread = 0)
+        {
+            QPGeneratorParameters       problem_param = generator_param;
+            QPGenerator                 generator;
+            std::vector<Eigen::MatrixXd> H_copies(num_problems);
+            std::vector<Eigen::VectorXd> primal(num_problems);
+
+            H.resize(num_problems);
+            h.resize(num_problems);
+            A.resize(num_problems);
+            Alb.resize(num_problems);
+            Aub.resize(num_problems);
+            for (qpmad::MatrixIndex i = 0; i < num_problems; ++i)
+            {
+                problem_param.num_active_general_ = generator_param.num_active_general_ + i % (num_active_spread + 1);
+                generator.generate(problem_param, i);
+                H[i] = H_copies[i] = generator.H_;
+                h[i] = generator.h_;
+                A[i] = generator.A_;
+                Alb[i] = generator.Alb_;
+                Aub[i] = generator.Aub_;
+                primal[i] = generator.primal_;
+            }
+
+
+            boost::timer::cpu_timer     solver_timer;
+            boost::timer::cpu_timer     batch_timer;
+
+            solver_timer.start();
+            for (qpmad::MatrixIndex i = 0; i < num_problems; ++i)
+            {
+                solver.solve(x, H_copies[i], h[i], A[i], Alb[i], Aub[i]);
+            }
+            solver_timer.stop();
+
+
+            qpmad::BatchSolver<t_num_lanes> batch_solver;
+            batch_solver.initialize(num_problems, H[0].rows(), A[0].rows());
+            for (qpmad::MatrixIndex i = 0; i < num_problems; ++i)
+            {
+                batch_solver.setProblem(i, H[i], h[i], A[i], Alb[i], Aub[i]);
+            }
+
+            batch_timer.start();
+            batch_solver.solve();
+            batch_timer.stop();
+
+
+            for (qpmad::MatrixIndex i = 0; i < num_problems; ++i)
+            {
+                BOOST_CHECK_EQUAL(batch_solver.getStatus(i), qpmad::Solver::OK);
+                batch_solver.getPrimal(i, x);
+                BOOST_CHECK(x.isApprox(primal[i], 1e-7));
+            }
+
+
+            BOOST_TEST_MESSAGE( "Problem size " + boost::lexical_cast<std::string>(generator_param.primal_size_)
+                                + "x" + boost::lexical_cast<std::string>(generator_param.num_general_constraints_)
+                                + " ||| Active : " + boost::lexical_cast<std::string>(generator_param.num_active_general_)
+                                + "-" + boost::lexical_cast<std::string>(generator_param.num_active_general_ + num_active_spread)
+                                + " ||| Lanes : " + boost::lexical_cast<std::string>(t_num_lanes)
+                                + " ||| Solver time : " + boost::lexical_cast<std::string>(solver_timer.elapsed().wall)
+                                + " ||| Batch time : " + boost::lexical_cast<std::string>(batch_timer.elapsed().wall));
+            BOOST_WARN(batch_timer.elapsed().wall < solver_timer.elapsed().wall);
+        }
+};
+
+
+BOOST_FIXTURE_TEST_CASE( batch00, BatchSolverFixture )
+{
+    generateProblems(37, 10, 20);
+
+    qpmad::BatchSolver<> batch_solver;
+    checkBatch(batch_solver);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( batch01, BatchSolverFixture )
+{
+    generateProblems(21, 8, 40);
+
+    // equality constraints
+    for (std::size_t i = 0; i < H.size(); i += 3)
+    {
+        Alb[i](0) = Aub[i](0) = 0.05;
+    }
+
+    // infeasible problem
+    A[5].topRows(2).setZero();
+    A[5](0, 0) = A[5](1, 0) = 1.0;
+    Alb[5](0) = 1.0;
+    Aub[5](0) = 2.0;
+    Alb[5](1) = -1.0;
+    Aub[5](1) = 0.0;
+
+    qpmad::BatchSolver<4> batch_solver;
+    checkBatch(batch_solver);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( batch_time00, BatchSolverFixture )
+{
+    QPGeneratorParameters generator_param;
+    generator_param.primal_size_ = 10;
+    generator_param.num_general_constraints_ = 20;
+    generator_param.simple_bounds_ = false;
+    generator_param.num_active_general_ = 4;
+    generator_param.condition_number_ = 10.0;
+
+    compareTimeWithSolver<4>(generator_param, 512);
+    compareTimeWithSolver<8>(generator_param, 512);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( batch_time01, BatchSolverFixture )
+{
+    QPGeneratorParameters generator_param;
+    generator_param.primal_size_ = 20;
+    generator_param.num_general_constraints_ = 40;
+    generator_param.simple_bounds_ = false;
+    generator_param.num_active_general_ = 10;
+    generator_param.condition_number_ = 10.0;
+
+    compareTimeWithSolver<8>(generator_param, 256);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( batch_time02, BatchSolverFixture )
+{
+    QPGeneratorParameters generator_param;
+    generator_param.primal_size_ = 20;
+    generator_param.num_general_constraints_ = 40;
+    generator_param.simple_bounds_ = false;
+    generator_param.num_active_general_ = 0;
+    generator_param.condition_number_ = 10.0;
+
+    // lanes finish at different times
+    compareTimeWithSolver<8>(generator_param, 256, 15);
+}
@@ -0,0 +1,221 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+// detect allocations in the solver, see c_api00
+#define EIGEN_RUNTIME_NO_MALLOC
+
+#include "utf_common.h"
+
+
+#include "../src/solver.h"
+// compiled with the test to enable the checks of Eigen
+#include "../src/qpmad_c.cpp"
+
+
+class CAPIFixture
+{
+    public:
+        Eigen::VectorXd         x;
+        Eigen::VectorXd         x_ref;
+        Eigen::MatrixXd         H;
+        Eigen::MatrixXd         H_copy;
+        Eigen::VectorXd         h;
+        Eigen::VectorXd         lb;
+        Eigen::VectorXd         ub;
+        Eigen::MatrixXd         A;
+        Eigen::VectorXd         Alb;
+        Eigen::VectorXd         Aub;
+
+        std::vector<char>       buffer;
+        void                    *workspace;
+        std::size_t             workspace_size;
+
+
+    public:
+        CAPIFixture()
+        {
+            workspace = NULL;
+        }
+
+
+        ~CAPIFixture()
+        {
+            qpmad_destroy(workspace);
+        }
+
+
+        void initializeWorkspace(const int primal_size, const int num_general_constraints)
+        {
+            workspace_size = qpmad_get_workspace_size(primal_size, num_general_constraints, -1);
+            BOOST_REQUIRE(workspace_size > 0);
+
+            buffer.resize(workspace_size + QPMAD_C_WORKSPACE_ALIGNMENT);
+            workspace = &buffer[0]
+                        + (QPMAD_C_WORKSPACE_ALIGNMENT
+                            - reinterpret_cast<std::size_t>(&buffer[0]) % QPMAD_C_WORKSPACE_ALIGNMENT);
+
+            BOOST_REQUIRE_EQUAL(qpmad_init(workspace, workspace_size, primal_size, num_general_constraints, -1), QPMAD_OK);
+        }
+
+
+        void generateProblem(const int size, const int num_ctr)
+        {
+            getRandomPositiveDefinititeMatrix(H_copy, size);
+            h.setRandom(size);
+            lb.setConstant(size, -0.1);
+            ub.setConstant(size, 0.1);
+            A.setRandom(num_ctr, size);
+            Alb.setConstant(num_ctr, -0.2);
+            Aub.setConstant(num_ctr, 0.2);
+            x.resize(size);
+        }
+};
+
+
+BOOST_FIXTURE_TEST_CASE( c_api00, CAPIFixture )
+{
+    const int size = 30;
+    const int num_ctr = 40;
+
+    generateProblem(size, num_ctr);
+    initializeWorkspace(size, num_ctr);
+
+    qpmad_parameters    param;
+    qpmad_get_default_parameters(&param);
+    param.warm_start = 1;
+
+    qpmad::Solver       solver;
+
+    for (std::size_t i = 0; i < 10; ++i)
+    {
+        h += 0.2 * Eigen::VectorXd::Random(size);
+
+        H = H_copy;
+#ifndef QPMAD_ENABLE_TRACING
+        // tracing code allocates temporary matrices
+        Eigen::internal::set_is_malloc_allowed(false);
+#endif
+        const int c_status = qpmad_solve(   workspace, size, num_ctr,
+                                            x.data(), H.data(), h.data(),
+                                            lb.data(), ub.data(),
+                                            A.data(), Alb.data(), Aub.data(),
+                                            &param);
+        Eigen::internal::set_is_malloc_allowed(true);
+        BOOST_CHECK_EQUAL(c_status, QPMAD_OK);
+
+        H = H_copy;
+        BOOST_CHECK_EQUAL(solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub), qpmad::Solver::OK);
+
+        BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE( c_api01, CAPIFixture )
+{
+    const int size = 20;
+    const int num_ctr = 10;
+
+    generateProblem(size, num_ctr);
+    initializeWorkspace(size, num_ctr);
+
+    qpmad::Solver       solver;
+
+    // smaller problem without simple bounds and default parameters
+    const int smaller_num_ctr = 5;
+    Eigen::MatrixXd     A_top = A.topRows(smaller_num_ctr);
+
+    H = H_copy;
+    BOOST_CHECK_EQUAL(  qpmad_solve(workspace, size, smaller_num_ctr,
+                                    x.data(), H.data(), h.data(),
+                                    NULL, NULL,
+                                    A_top.data(), Alb.data(), Aub.data(),
+                                    NULL),
+                        QPMAD_OK);
+
+    H = H_copy;
+    BOOST_CHECK_EQUAL(  solver.solve(x_ref, H, h, A_top, Alb.head(smaller_num_ctr), Aub.head(smaller_num_ctr)),
+                        qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+
+
+    // errors
+    H = H_copy;
+    BOOST_CHECK_EQUAL(  qpmad_solve(workspace, size, num_ctr + 1,
+                                    x.data(), H.data(), h.data(),
+                                    NULL, NULL,
+                                    A.data(), Alb.data(), Aub.data(),
+                                    NULL),
+                        QPMAD_ERROR_INVALID_ARGUMENT);
+    BOOST_CHECK_EQUAL(  qpmad_solve(workspace, size, num_ctr,
+                                    x.data(), H.data(), h.data(),
+                                    lb.data(), NULL,
+                                    NULL, NULL, NULL,
+                                    NULL),
+                        QPMAD_ERROR_INVALID_ARGUMENT);
+
+    qpmad_parameters    param;
+    qpmad_get_default_parameters(&param);
+    param.hessian_type = 0;
+    BOOST_CHECK_EQUAL(  qpmad_solve(workspace, size, 0,
+                                    x.data(), H.data(), h.data(),
+                                    lb.data(), ub.data(),
+                                    NULL, NULL, NULL,
+                                    &param),
+                        QPMAD_ERROR_INVALID_ARGUMENT);
+
+    // inconsistent bounds: exception is not propagated
+    lb(0) = 1.0;
+    BOOST_CHECK_EQUAL(  qpmad_solve(workspace, size, 0,
+                                    x.data(), H.data(), h.data(),
+                                    lb.data(), ub.data(),
+                                    NULL, NULL, NULL,
+                                    NULL),
+                        QPMAD_ERROR_FAILURE);
+
+    BOOST_CHECK_EQUAL(  qpmad_init(workspace, workspace_size - 1, size, num_ctr, -1),
+                        QPMAD_ERROR_WORKSPACE);
+
+
+    // reinitialization
+    lb(0) = -0.1;
+    qpmad_destroy(workspace);
+    BOOST_CHECK_EQUAL(qpmad_init(workspace, workspace_size, size, num_ctr, -1), QPMAD_OK);
+    H = H_copy;
+    BOOST_CHECK_EQUAL(  qpmad_solve(workspace, size, num_ctr,
+                                    x.data(), H.data(), h.data(),
+                                    lb.data(), ub.data(),
+                                    A.data(), Alb.data(), Aub.data(),
+                                    NULL),
+                        QPMAD_OK);
+
+    qpmad_destroy(workspace);
+    H = H_copy;
+    BOOST_CHECK_EQUAL(  qpmad_solve(workspace, size, num_ctr,
+                                    x.data(), H.data(), h.data(),
+                                    lb.data(), ub.data(),
+                                    A.data(), Alb.data(), Aub.data(),
+                                    NULL),
+                        QPMAD_ERROR_INVALID_ARGUMENT);
+
+
+    // the block is not read by initialization: a stale header with garbage
+    // is overwritten
+    std::fill(buffer.begin(), buffer.end(), static_cast<char>(0x5a));
+    *static_cast<std::size_t *>(workspace) = CWorkspaceHeader::MAGIC;
+    BOOST_CHECK_EQUAL(qpmad_init(workspace, workspace_size, size, num_ctr, -1), QPMAD_OK);
+    H = H_copy;
+    BOOST_CHECK_EQUAL(  qpmad_solve(workspace, size, num_ctr,
+                                    x.data(), H.data(), h.data(),
+                                    lb.data(), ub.data(),
+                                    A.data(), Alb.data(), Aub.data(),
+                                    NULL),
+                        QPMAD_OK);
+}
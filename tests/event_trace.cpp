@@ -0,0 +1,123 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#include "utf_common.h"
+
+#include <sstream>
+
+#include "../src/solver.h"
+#include "../src/event_trace.h"
+
+
+class EventTraceFixture
+{
+    public:
+        EventTraceFixture()
+        {
+            qpmad::EventTrace::setCapacity(1024);
+            qpmad::EventTrace::clear();
+        }
+};
+
+
+
+BOOST_FIXTURE_TEST_CASE( event_trace00, EventTraceFixture )
+{
+    qpmad::EventTrace::record(qpmad::EventTrace::SOLVE_BEGIN, 2, 1);
+    qpmad::EventTrace::record(qpmad::EventTrace::CONSTRAINT_CHOSEN, 1, 0.5);
+    qpmad::EventTrace::record(qpmad::EventTrace::FULL_STEP, 1, std::numeric_limits<double>::infinity());
+    qpmad::EventTrace::record(qpmad::EventTrace::STATUS, 0, qpmad::Solver::OK);
+
+    BOOST_CHECK_EQUAL(qpmad::EventTrace::getNumEvents(), 4u);
+
+
+    std::stringstream binary;
+    qpmad::EventTrace::writeBinary(binary);
+
+    std::stringstream json;
+    BOOST_CHECK(qpmad::EventTrace::convertToChromeTrace(binary, json));
+
+    const std::string trace = json.str();
+    BOOST_CHECK(std::string::npos != trace.find("\"traceEvents\""));
+    BOOST_CHECK(std::string::npos != trace.find("\"ph\":\"B\""));
+    BOOST_CHECK(std::string::npos != trace.find("\"ph\":\"E\""));
+    BOOST_CHECK(std::string::npos != trace.find("\"constraint chosen\""));
+    BOOST_CHECK(std::string::npos != trace.find("\"inf\""));
+
+
+    std::stringstream malformed("QPMADXXX");
+    std::stringstream output;
+    BOOST_CHECK(false == qpmad::EventTrace::convertToChromeTrace(malformed, output));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( event_trace01, EventTraceFixture )
+{
+    // the existing buffer of this thread is resized by clear()
+    qpmad::EventTrace::setCapacity(3);
+    for (int i = 0; i < 10; ++i)
+    {
+        qpmad::EventTrace::record(qpmad::EventTrace::ITERATION_START, i, 0);
+    }
+    BOOST_CHECK_EQUAL(qpmad::EventTrace::getNumEvents(), 10u);
+    qpmad::EventTrace::clear();
+
+    // only the newest events are kept
+    for (int i = 0; i < 10; ++i)
+    {
+        qpmad::EventTrace::record(qpmad::EventTrace::ITERATION_START, i, 0);
+    }
+    BOOST_CHECK_EQUAL(qpmad::EventTrace::getNumEvents(), 3u);
+
+    std::stringstream json;
+    qpmad::EventTrace::writeChromeTrace(json);
+
+    const std::string trace = json.str();
+    BOOST_CHECK(std::string::npos == trace.find("\"index\":6,"));
+    BOOST_CHECK(std::string::npos != trace.find("\"index\":7,"));
+    BOOST_CHECK(std::string::npos != trace.find("\"index\":9,"));
+    BOOST_CHECK(trace.find("\"index\":7,") < trace.find("\"index\":9,"));
+
+    qpmad::EventTrace::clear();
+    BOOST_CHECK_EQUAL(qpmad::EventTrace::getNumEvents(), 0u);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( event_trace02, EventTraceFixture )
+{
+    qpmad::Solver solver;
+
+    Eigen::VectorXd x;
+    Eigen::MatrixXd H = Eigen::MatrixXd::Identity(2, 2);
+    Eigen::VectorXd h = Eigen::VectorXd::Zero(2);
+    Eigen::MatrixXd A(1, 2);
+    Eigen::VectorXd Alb(1);
+    Eigen::VectorXd Aub(1);
+
+    A << 1, 1;
+    Alb << 1;
+    Aub << 2;
+
+    BOOST_CHECK_EQUAL(solver.solve(x, H, h, A, Alb, Aub), qpmad::Solver::OK);
+
+#ifdef QPMAD_ENABLE_EVENT_TRACE
+    BOOST_CHECK(qpmad::EventTrace::getNumEvents() > 0);
+
+    std::stringstream json;
+    qpmad::EventTrace::writeChromeTrace(json);
+
+    const std::string trace = json.str();
+    BOOST_CHECK(std::string::npos != trace.find("\"ph\":\"B\""));
+    BOOST_CHECK(std::string::npos != trace.find("\"ph\":\"E\""));
+    BOOST_CHECK(std::string::npos != trace.find("\"full step\""));
+#else
+    BOOST_CHECK_EQUAL(qpmad::EventTrace::getNumEvents(), 0u);
+#endif
+}
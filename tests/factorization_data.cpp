@@ -0,0 +1,215 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#include "utf_common.h"
+
+
+#include "../src/solver.h"
+
+
+template<int t_size>
+    class PrimalStepFixture
+{
+    public:
+        qpmad::Workspace            workspace;
+        qpmad::FactorizationData    factorization_data;
+
+        Eigen::VectorXd             ctr;
+        Eigen::VectorXd             step_direction;
+
+        Eigen::VectorXd             ref_d;
+        Eigen::VectorXd             ref_step_direction;
+
+
+    public:
+        PrimalStepFixture()
+        {
+            BOOST_REQUIRE(workspace.reserve(qpmad::FactorizationData::getWorkspaceSize(t_size, t_size)));
+            factorization_data.mapWorkspace(workspace, t_size, t_size);
+
+            factorization_data.QLi_aka_J.setRandom();
+            ctr.setRandom(t_size);
+            step_direction.resize(t_size);
+        }
+
+
+        /// two separate products
+        void computeReference(const double sign, const qpmad::MatrixIndex active_set_size)
+        {
+            const qpmad::MatrixIndex tail_size = t_size - active_set_size;
+
+            ref_d.noalias() = sign * (factorization_data.QLi_aka_J.transpose() * ctr);
+            ref_step_direction.noalias() = - factorization_data.QLi_aka_J.rightCols(tail_size) * ref_d.tail(tail_size);
+        }
+
+
+        void compareWithReference()
+        {
+            for (qpmad::MatrixIndex active_set_size = 0; active_set_size < t_size; active_set_size += 1 + t_size / 3)
+            {
+                computeReference(-1.0, active_set_size);
+                factorization_data.computeProjectionAndPrimalStep(step_direction, ctr.transpose(), -1.0, active_set_size);
+
+                BOOST_CHECK((factorization_data.d - ref_d).norm() < g_default_tolerance * t_size);
+                BOOST_CHECK((step_direction - ref_step_direction).norm() < g_default_tolerance * t_size);
+            }
+        }
+
+
+        void compareTimeWithReference()
+        {
+            const std::size_t num_repetitions = std::max(5, 20000000 / (t_size * t_size));
+
+            boost::timer::cpu_timer     fused_timer;
+            boost::timer::cpu_timer     reference_timer;
+
+
+            reference_timer.start();
+            for (std::size_t i = 0; i < num_repetitions; ++i)
+            {
+                computeReference(1.0, 0);
+            }
+            reference_timer.stop();
+
+
+            fused_timer.start();
+            for (std::size_t i = 0; i < num_repetitions; ++i)
+            {
+                factorization_data.computeProjectionAndPrimalStep(step_direction, ctr.transpose(), 1.0, 0);
+            }
+            fused_timer.stop();
+
+
+            BOOST_TEST_MESSAGE( "Matrix size " + boost::lexical_cast<std::string>(t_size)
+                                + " ||| fused time : " + boost::lexical_cast<std::string>(fused_timer.elapsed().wall)
+                                + " ||| two products time : " + boost::lexical_cast<std::string>(reference_timer.elapsed().wall));
+            BOOST_WARN(fused_timer.elapsed().wall < reference_timer.elapsed().wall);
+
+            BOOST_CHECK((step_direction - ref_step_direction).norm() < g_default_tolerance * t_size);
+        }
+};
+
+
+
+class DowndateFixture
+{
+    public:
+        qpmad::Workspace            workspace;
+        qpmad::FactorizationData    factorization_data;
+
+        Eigen::MatrixXd             normals;
+
+
+    public:
+        /// J^T * N = [R; 0]
+        void checkFactorization(const qpmad::MatrixIndex size)
+        {
+            Eigen::MatrixXd R;
+            factorization_data.getR(R, size);
+
+            const Eigen::MatrixXd projections = factorization_data.QLi_aka_J.transpose() * normals.leftCols(size);
+
+            BOOST_CHECK((projections.topRows(size) - R.triangularView<Eigen::Upper>().toDenseMatrix()).norm()
+                        < g_default_tolerance * 100);
+            BOOST_CHECK(projections.bottomRows(normals.rows() - size).norm() < g_default_tolerance * 100);
+        }
+};
+
+
+
+BOOST_FIXTURE_TEST_CASE( downdate00, DowndateFixture )
+{
+    const qpmad::MatrixIndex size = 20;
+    const qpmad::MatrixIndex num_ctr = 15;
+
+    Eigen::MatrixXd H;
+    getRandomPositiveDefinititeMatrix(H, size);
+    qpmad::CholeskyFactorization::compute(H);
+
+    BOOST_REQUIRE(workspace.reserve(qpmad::FactorizationData::getWorkspaceSize(size, size)));
+    factorization_data.mapWorkspace(workspace, size, size);
+    factorization_data.initialize(H, qpmad::SolverParameters::HESSIAN_CHOLESKY_FACTOR);
+
+    normals.setRandom(size, num_ctr);
+    for (qpmad::MatrixIndex i = 0; i < num_ctr; ++i)
+    {
+        factorization_data.d.noalias() = factorization_data.QLi_aka_J.transpose() * normals.col(i);
+        BOOST_REQUIRE(factorization_data.update(i, g_default_tolerance));
+    }
+    checkFactorization(num_ctr);
+
+
+    // several downdates in a row
+    const qpmad::MatrixIndex removed[] = {3, 0, 9, 11};
+    qpmad::MatrixIndex num_active = num_ctr;
+    for (std::size_t i = 0; i < sizeof(removed) / sizeof(removed[0]); ++i)
+    {
+        factorization_data.downdate(removed[i], num_active, g_default_tolerance);
+        --num_active;
+
+        normals.block(0, removed[i], size, num_active - removed[i]) =
+            normals.block(0, removed[i] + 1, size, num_active - removed[i]).eval();
+        checkFactorization(num_active);
+    }
+
+
+    // constraints are added after removal
+    normals.rightCols(num_ctr - num_active).setRandom();
+    for (qpmad::MatrixIndex i = num_active; i < num_ctr; ++i)
+    {
+        factorization_data.d.noalias() = factorization_data.QLi_aka_J.transpose() * normals.col(i);
+        BOOST_REQUIRE(factorization_data.update(i, g_default_tolerance));
+    }
+    checkFactorization(num_ctr);
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE( primal_step00, PrimalStepFixture<1> )
+{
+    compareWithReference();
+}
+
+BOOST_FIXTURE_TEST_CASE( primal_step01, PrimalStepFixture<7> )
+{
+    compareWithReference();
+}
+
+BOOST_FIXTURE_TEST_CASE( primal_step02, PrimalStepFixture<301> )
+{
+    compareWithReference();
+}
+
+
+
+BOOST_FIXTURE_TEST_CASE( primal_step_time00, PrimalStepFixture<100> )
+{
+    compareTimeWithReference();
+}
+
+BOOST_FIXTURE_TEST_CASE( primal_step_time01, PrimalStepFixture<200> )
+{
+    compareTimeWithReference();
+}
+
+BOOST_FIXTURE_TEST_CASE( primal_step_time02, PrimalStepFixture<500> )
+{
+    compareTimeWithReference();
+}
+
+BOOST_FIXTURE_TEST_CASE( primal_step_time03, PrimalStepFixture<1000> )
+{
+    compareTimeWithReference();
+}
+
+BOOST_FIXTURE_TEST_CASE( primal_step_time04, PrimalStepFixture<2000> )
+{
+    compareTimeWithReference();
+}
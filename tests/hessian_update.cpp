@@ -0,0 +1,146 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#include "utf_common.h"
+
+
+#include "../src/solver.h"
+#include "../src/hessian_update.h"
+
+
+class HessianUpdateFixture
+{
+    public:
+        Eigen::MatrixXd         H;
+        Eigen::MatrixXd         L;
+        Eigen::MatrixXd         J;
+        Eigen::MatrixXd         V;
+        Eigen::VectorXd         sigma;
+
+        qpmad::HessianUpdate    hessian_update;
+
+
+    public:
+        HessianUpdateFixture()
+        {
+            const std::size_t size = 20;
+
+            getRandomPositiveDefinititeMatrix(H, size);
+
+            L = H;
+            qpmad::CholeskyFactorization::compute(L);
+            L.triangularView<Eigen::StrictlyUpper>().setZero();
+
+            J.setZero(size, size);
+            qpmad::TriangularInversion::compute(J, L);
+        }
+
+
+        void checkFactors(const Eigen::MatrixXd & H_updated)
+        {
+            Eigen::MatrixXd L_lower = L.triangularView<Eigen::Lower>();
+
+            BOOST_CHECK((L_lower * L_lower.transpose()).isApprox(H_updated, g_default_tolerance));
+            BOOST_CHECK((J * J.transpose() * H_updated).isApprox(Eigen::MatrixXd::Identity(H.rows(), H.rows()), 1e-9));
+            BOOST_CHECK(L.diagonal().minCoeff() > 0.0);
+        }
+};
+
+
+BOOST_FIXTURE_TEST_CASE( rank1_update, HessianUpdateFixture )
+{
+    Eigen::VectorXd v = Eigen::VectorXd::Random(H.rows());
+
+    BOOST_CHECK(hessian_update.updateCholeskyFactor(L, v, 0.7));
+    BOOST_CHECK(hessian_update.updateInverseFactor(J, v, 0.7));
+
+    checkFactors(H + 0.7 * v * v.transpose());
+}
+
+
+BOOST_FIXTURE_TEST_CASE( rank1_downdate, HessianUpdateFixture )
+{
+    Eigen::VectorXd v = Eigen::VectorXd::Random(H.rows());
+    // H >= I, see getRandomPositiveDefinititeMatrix()
+    const double    sigma = -0.5 / v.squaredNorm();
+
+    BOOST_CHECK(hessian_update.updateCholeskyFactor(L, v, sigma));
+    BOOST_CHECK(hessian_update.updateInverseFactor(J, v, sigma));
+
+    checkFactors(H + sigma * v * v.transpose());
+
+
+    // indefinite result
+    Eigen::MatrixXd L_copy = L;
+    Eigen::MatrixXd J_copy = J;
+    v = L.triangularView<Eigen::Lower>() * Eigen::VectorXd::Unit(H.rows(), 0);
+
+    BOOST_CHECK(false == hessian_update.updateCholeskyFactor(L, v, -1.5));
+    BOOST_CHECK(false == hessian_update.updateInverseFactor(J, v, -1.5));
+    BOOST_CHECK(L == L_copy);
+    BOOST_CHECK(J == J_copy);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( rank2_downdate, HessianUpdateFixture )
+{
+    const qpmad::MatrixIndex size = H.rows();
+
+    V.resize(size, 2);
+    V.col(0).setRandom();
+    V.col(1) = L.triangularView<Eigen::Lower>() * Eigen::VectorXd::Unit(size, 0);
+    sigma.resize(2);
+    sigma << -0.5 / V.col(0).squaredNorm(), -1.5;
+
+    // the second downdate fails after the first one is applied
+    BOOST_CHECK(false == hessian_update.update(L, J, V, sigma));
+    checkFactors(H + sigma(0) * V.col(0) * V.col(0).transpose());
+}
+
+
+BOOST_FIXTURE_TEST_CASE( bfgs_update, HessianUpdateFixture )
+{
+    const qpmad::MatrixIndex size = H.rows();
+    const qpmad::MatrixIndex num_ctr = 10;
+
+    Eigen::VectorXd s = Eigen::VectorXd::Random(size);
+    Eigen::VectorXd y = H * s + 0.1 * Eigen::VectorXd::Random(size);
+    y += (std::abs(y.dot(s)) + 1.0) / s.squaredNorm() * s;  // curvature condition
+
+    V.resize(size, 2);
+    V << y, H * s;
+    sigma.resize(2);
+    sigma << 1.0 / y.dot(s), -1.0 / s.dot(H * s);
+
+    BOOST_CHECK(hessian_update.update(L, J, V, sigma));
+
+    Eigen::MatrixXd H_updated = H + sigma(0) * y * y.transpose() + sigma(1) * (H * s) * (H * s).transpose();
+    checkFactors(H_updated);
+
+
+    // solution with the updated inverted factor
+    Eigen::VectorXd h = Eigen::VectorXd::Random(size);
+    Eigen::MatrixXd A = Eigen::MatrixXd::Random(num_ctr, size);
+    Eigen::VectorXd Alb = Eigen::VectorXd::Constant(num_ctr, -0.1);
+    Eigen::VectorXd Aub = Eigen::VectorXd::Constant(num_ctr, 0.1);
+    Eigen::VectorXd x;
+    Eigen::VectorXd x_ref;
+
+    qpmad::Solver           solver;
+    qpmad::SolverParameters param;
+
+    param.hessian_type_ = qpmad::SolverParameters::HESSIAN_INVERTED_CHOLESKY_FACTOR;
+    BOOST_CHECK_EQUAL(solver.solve(x, J, h, A, Alb, Aub, param), qpmad::Solver::OK);
+
+    param.hessian_type_ = qpmad::SolverParameters::HESSIAN_LOWER_TRIANGULAR;
+    BOOST_CHECK_EQUAL(solver.solve(x_ref, H_updated, h, A, Alb, Aub, param), qpmad::Solver::OK);
+
+    BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+}
@@ -0,0 +1,187 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#include "utf_common.h"
+
+
+#include "../src/solver.h"
+#include "../src/hierarchical_solver.h"
+
+
+class HierarchicalSolverFixture
+{
+    public:
+        Eigen::MatrixXd                 H;
+        Eigen::VectorXd                 lb;
+        Eigen::VectorXd                 ub;
+
+        std::vector<Eigen::VectorXd>    h;
+        std::vector<Eigen::MatrixXd>    A;
+        std::vector<Eigen::VectorXd>    Alb;
+        std::vector<Eigen::VectorXd>    Aub;
+
+        Eigen::VectorXd                 x;
+        Eigen::VectorXd                 x_ref;
+        Eigen::VectorXd                 dual;
+
+        qpmad::HierarchicalSolver       hierarchical_solver;
+        qpmad::SolverParameters         param;
+        qpmad::Solver::ReturnStatus     status;
+
+
+    public:
+        HierarchicalSolverFixture()
+        {
+            const qpmad::MatrixIndex size = 20;
+            const qpmad::MatrixIndex num_levels = 3;
+            const qpmad::MatrixIndex num_ctr = 6;
+
+            getRandomPositiveDefinititeMatrix(H, size);
+            lb.setConstant(size, -1.0);
+            ub.setConstant(size, 1.0);
+
+            h.resize(num_levels);
+            A.resize(num_levels);
+            Alb.resize(num_levels);
+            Aub.resize(num_levels);
+            for (qpmad::MatrixIndex i = 0; i < num_levels; ++i)
+            {
+                h[i].setRandom(size);
+                h[i] *= 10.0;
+                A[i].setRandom(num_ctr, size);
+                Alb[i].setConstant(num_ctr, -0.5);
+                Aub[i].setConstant(num_ctr, 0.5);
+            }
+            // equalities
+            Alb[1](0) = Aub[1](0) = 0.1;
+            Alb[2](3) = Aub[2](3) = -0.2;
+        }
+
+
+        /// Solve levels from scratch fixing active constraints of the
+        /// previous levels, compare with the hierarchical solver.
+        void checkLevels()
+        {
+            qpmad::Solver       solver;
+            Eigen::MatrixXd     H_copy;
+            Eigen::VectorXd     ref_lb = lb;
+            Eigen::VectorXd     ref_ub = ub;
+            Eigen::MatrixXd     ref_A(0, H.rows());
+            Eigen::VectorXd     ref_Alb;
+            Eigen::VectorXd     ref_Aub;
+            Eigen::VectorXd     ref_dual;
+
+            for (std::size_t level = 0; level < h.size(); ++level)
+            {
+                const qpmad::MatrixIndex num_simple_bounds = lb.rows();
+                const qpmad::MatrixIndex num_prev_ctr = ref_A.rows();
+
+                // fix active constraints
+                for (qpmad::MatrixIndex i = 0; i < ref_dual.rows(); ++i)
+                {
+                    double & ctr_lb = (i < num_simple_bounds) ? ref_lb(i) : ref_Alb(i - num_simple_bounds);
+                    double & ctr_ub = (i < num_simple_bounds) ? ref_ub(i) : ref_Aub(i - num_simple_bounds);
+
+                    if (ref_dual(i) < 0.0)
+                    {
+                        ctr_ub = ctr_lb;
+                    }
+                    if (ref_dual(i) > 0.0)
+                    {
+                        ctr_lb = ctr_ub;
+                    }
+                }
+
+                ref_A.conservativeResize(num_prev_ctr + A[level].rows(), Eigen::NoChange);
+                ref_A.bottomRows(A[level].rows()) = A[level];
+                ref_Alb.conservativeResize(num_prev_ctr + A[level].rows());
+                ref_Alb.tail(A[level].rows()) = Alb[level];
+                ref_Aub.conservativeResize(num_prev_ctr + A[level].rows());
+                ref_Aub.tail(A[level].rows()) = Aub[level];
+
+                H_copy = H;
+                status = solver.solve(x_ref, H_copy, h[level], ref_lb, ref_ub, ref_A, ref_Alb, ref_Aub, param);
+                BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+                solver.getDual(ref_dual);
+
+
+                if (0 == level)
+                {
+                    status = hierarchical_solver.solve(x, H, h[level], lb, ub, A[level], Alb[level], Aub[level], param);
+                }
+                else
+                {
+                    status = hierarchical_solver.solveNextLevel(x, h[level], A[level], Alb[level], Aub[level], param);
+                }
+                BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+                BOOST_CHECK_EQUAL(hierarchical_solver.getNumLevels(), static_cast<qpmad::MatrixIndex>(level + 1));
+
+                BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+                BOOST_CHECK_CLOSE(hierarchical_solver.getObjective(), solver.getObjective(), 1e-6);
+
+                hierarchical_solver.getDual(dual);
+                BOOST_CHECK((dual - ref_dual).lpNorm<Eigen::Infinity>() < 1e-9);
+            }
+        }
+};
+
+
+
+BOOST_FIXTURE_TEST_CASE( hierarchy00, HierarchicalSolverFixture )
+{
+    checkLevels();
+
+    // the hierarchy is restarted
+    checkLevels();
+}
+
+
+BOOST_FIXTURE_TEST_CASE( hierarchy01, HierarchicalSolverFixture )
+{
+    // the first level does not activate constraints
+    h[0].setZero();
+    h.resize(2);
+    checkLevels();
+}
+
+
+BOOST_FIXTURE_TEST_CASE( hierarchy_infeasible00, HierarchicalSolverFixture )
+{
+    status = hierarchical_solver.solve(x, H, h[0], lb, ub, A[0], Alb[0], Aub[0], param);
+    BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+    x_ref = x;
+
+    hierarchical_solver.getDual(dual);
+    qpmad::MatrixIndex active_index = 0;
+    dual.cwiseAbs().maxCoeff(&active_index);
+    BOOST_REQUIRE(dual(active_index) != 0.0);
+
+
+    // an equality, which is parallel to a fixed constraint
+    Eigen::MatrixXd     level_A = Eigen::MatrixXd::Zero(1, H.rows());
+    Eigen::VectorXd     level_bounds(1);
+
+    if (active_index < lb.rows())
+    {
+        level_A(0, active_index) = 2.0;
+        level_bounds(0) = 2.0 * x(active_index) + 0.1;
+    }
+    else
+    {
+        level_A = 2.0 * A[0].row(active_index - lb.rows());
+        level_bounds = level_A * x;
+        level_bounds(0) += 0.1;
+    }
+
+    status = hierarchical_solver.solveNextLevel(x, h[1], level_A, level_bounds, level_bounds, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INFEASIBLE_EQUALITY);
+    BOOST_CHECK_EQUAL(hierarchical_solver.getNumLevels(), 1);
+    BOOST_CHECK(x == x_ref);
+}
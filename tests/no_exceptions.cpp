@@ -0,0 +1,231 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+// failures are reported with return codes, see QPMAD_NO_EXCEPTIONS
+#ifndef QPMAD_NO_EXCEPTIONS
+#define QPMAD_NO_EXCEPTIONS
+#endif
+
+#include "utf_common.h"
+
+
+#include "../src/solver.h"
+#include "../src/batch_solver.h"
+#include "../src/hessian_update.h"
+
+
+class NoExceptionsFixture
+{
+    public:
+        Eigen::VectorXd         x;
+        Eigen::MatrixXd         H;
+        Eigen::MatrixXd         H_copy;
+        Eigen::VectorXd         h;
+        Eigen::VectorXd         lb;
+        Eigen::VectorXd         ub;
+        Eigen::MatrixXd         A;
+        Eigen::VectorXd         Alb;
+        Eigen::VectorXd         Aub;
+
+        qpmad::Solver               solver;
+        qpmad::SolverParameters     param;
+
+        qpmad::Solver::ReturnStatus status;
+
+
+    public:
+        NoExceptionsFixture()
+        {
+            const qpmad::MatrixIndex size = 20;
+            const qpmad::MatrixIndex num_ctr = 10;
+
+            getRandomPositiveDefinititeMatrix(H_copy, size);
+            h.setRandom(size);
+            lb.setConstant(size, -0.5);
+            ub.setConstant(size, 0.5);
+            A.setRandom(num_ctr, size);
+            Alb.setConstant(num_ctr, -1.0);
+            Aub.setConstant(num_ctr, 1.0);
+        }
+};
+
+
+/// violates all constraints with inconsistent bounds
+class InconsistentConstraintOracle : public qpmad::ConstraintOracle
+{
+    public:
+        bool getMostViolatedConstraint( const Eigen::Ref<const qpmad::QPVector>    & /*primal*/,
+                                        const double                                /*tolerance*/,
+                                        Eigen::Ref<qpmad::QPVector>                 row,
+                                        double                                      & lb,
+                                        double                                      & ub)
+        {
+            row.setZero();
+            row(0) = 1.0;
+            lb = 1.0;
+            ub = -1.0;
+            return (true);
+        }
+};
+
+
+
+BOOST_FIXTURE_TEST_CASE( status_codes00, NoExceptionsFixture )
+{
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+
+    // wrong sizes
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb.head(5), Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INVALID_INPUT);
+
+    H = H_copy;
+    status = solver.solve(x, H, h.head(5), lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INVALID_INPUT);
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, Eigen::VectorXd::Constant(3, 1.0), param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INVALID_INPUT);
+
+
+    // malformed parameters
+    qpmad::SolverParameters malformed_param = param;
+    malformed_param.hessian_type_ = qpmad::SolverParameters::UNDEFINED;
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, malformed_param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INVALID_INPUT);
+
+
+    // inconsistent bounds
+    Eigen::VectorXd inconsistent_Alb = Alb;
+    inconsistent_Alb(3) = 2.0;
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, inconsistent_Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INCONSISTENT_CONSTRAINTS);
+
+    qpmad::SolverParameters primal_param = param;
+    primal_param.method_ = qpmad::SolverParameters::METHOD_PRIMAL;
+    x.setZero(H_copy.rows());
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, inconsistent_Alb, Aub, primal_param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INCONSISTENT_CONSTRAINTS);
+
+    InconsistentConstraintOracle oracle;
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, oracle, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INCONSISTENT_CONSTRAINTS);
+
+
+    // the solver is usable after failures
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+
+    // external workspace is too small
+    std::vector<char> buffer(qpmad::Solver::getWorkspaceSize(H_copy.rows(), H_copy.rows() + A.rows())
+                                + QPMAD_WORKSPACE_ALIGNMENT);
+    char *workspace = &buffer[0]
+                        + (QPMAD_WORKSPACE_ALIGNMENT
+                            - reinterpret_cast<std::size_t>(&buffer[0]) % QPMAD_WORKSPACE_ALIGNMENT);
+    BOOST_REQUIRE(solver.setWorkspace(workspace, buffer.size() - QPMAD_WORKSPACE_ALIGNMENT - 1));
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::WORKSPACE_TOO_SMALL);
+
+
+    for (int i = qpmad::Solver::OK; i <= qpmad::Solver::NUMERICAL_FAILURE; ++i)
+    {
+        BOOST_CHECK(NULL != qpmad::Solver::getStatusMessage(static_cast<qpmad::Solver::ReturnStatus>(i)));
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE( skip_input_check00, NoExceptionsFixture )
+{
+    Eigen::VectorXd x_ref;
+
+    H = H_copy;
+    status = solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+
+
+    qpmad::SolverParameters unchecked_param = param;
+    unchecked_param.check_input_ = false;
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, unchecked_param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+
+
+    // consistency of bounds is checked anyway
+    Eigen::VectorXd inconsistent_ub = ub;
+    inconsistent_ub(0) = -1.0;
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, inconsistent_ub, A, Alb, Aub, unchecked_param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INCONSISTENT_CONSTRAINTS);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( batch_status_codes00, NoExceptionsFixture )
+{
+    qpmad::BatchSolver<4>   batch_solver;
+
+    BOOST_CHECK_EQUAL(batch_solver.initialize(3, 0, A.rows()), qpmad::Solver::INVALID_INPUT);
+    BOOST_REQUIRE_EQUAL(batch_solver.initialize(3, H_copy.rows(), A.rows()), qpmad::Solver::OK);
+
+    BOOST_CHECK_EQUAL(batch_solver.setProblem(3, H_copy, h, A, Alb, Aub), qpmad::Solver::INVALID_INPUT);
+    BOOST_CHECK_EQUAL(batch_solver.setProblem(0, H_copy, h.head(5), A, Alb, Aub), qpmad::Solver::INVALID_INPUT);
+    BOOST_CHECK_EQUAL(batch_solver.setProblem(0, H_copy, h, A, Alb.head(5), Aub), qpmad::Solver::INVALID_INPUT);
+    for (qpmad::MatrixIndex i = 0; i < 3; ++i)
+    {
+        BOOST_CHECK_EQUAL(batch_solver.setProblem(i, H_copy, h, A, Alb, Aub), qpmad::Solver::OK);
+    }
+
+    BOOST_CHECK_EQUAL(batch_solver.solve(param), qpmad::Solver::OK);
+    qpmad::SolverParameters unsupported_param = param;
+    unsupported_param.hessian_type_ = qpmad::SolverParameters::HESSIAN_CHOLESKY_FACTOR;
+    BOOST_CHECK_EQUAL(batch_solver.solve(unsupported_param), qpmad::Solver::INVALID_INPUT);
+
+    BOOST_CHECK_EQUAL(batch_solver.getStatus(-1), qpmad::Solver::INVALID_INPUT);
+    BOOST_CHECK_EQUAL(batch_solver.getStatus(3), qpmad::Solver::INVALID_INPUT);
+    BOOST_CHECK_EQUAL(batch_solver.getPrimal(3, x), qpmad::Solver::INVALID_INPUT);
+    BOOST_CHECK_EQUAL(batch_solver.getPrimal(0, x), qpmad::Solver::OK);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( hessian_update_status00, NoExceptionsFixture )
+{
+    qpmad::HessianUpdate    hessian_update;
+    Eigen::MatrixXd         L = H_copy;
+    Eigen::MatrixXd         J;
+
+    qpmad::CholeskyFactorization::compute(L);
+    L.triangularView<Eigen::StrictlyUpper>().setZero();
+    J.setZero(L.rows(), L.rows());
+    qpmad::TriangularInversion::compute(J, L);
+
+    const Eigen::MatrixXd   L_copy = L;
+    const Eigen::MatrixXd   J_copy = J;
+
+    // wrong sizes: the factors are not modified
+    BOOST_CHECK(false == hessian_update.update(L, J, Eigen::MatrixXd::Random(5, 1), Eigen::VectorXd::Ones(1)));
+    BOOST_CHECK(false == hessian_update.update(L, J, Eigen::MatrixXd::Random(L.rows(), 2), Eigen::VectorXd::Ones(1)));
+    BOOST_CHECK(false == hessian_update.updateCholeskyFactor(L, Eigen::VectorXd::Random(5), 1.0));
+    BOOST_CHECK(false == hessian_update.updateInverseFactor(J, Eigen::VectorXd::Random(5), 1.0));
+    BOOST_CHECK(L == L_copy);
+    BOOST_CHECK(J == J_copy);
+
+    BOOST_CHECK(hessian_update.update(L, J, Eigen::MatrixXd::Random(L.rows(), 1), Eigen::VectorXd::Ones(1)));
+}
@@ -0,0 +1,184 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#include "utf_common.h"
+
+
+#include "../src/solver.h"
+#include "../src/presolver.h"
+
+
+class PresolverFixture
+{
+    public:
+        Eigen::VectorXd         x;
+        Eigen::VectorXd         x_ref;
+        Eigen::MatrixXd         H;
+        Eigen::MatrixXd         H_copy;
+        Eigen::VectorXd         h;
+        Eigen::VectorXd         lb;
+        Eigen::VectorXd         ub;
+        Eigen::MatrixXd         A;
+        Eigen::VectorXd         Alb;
+        Eigen::VectorXd         Aub;
+
+        qpmad::Solver               solver;
+        qpmad::Presolver            presolver;
+        qpmad::SolverParameters     param;
+
+        qpmad::Solver::ReturnStatus status;
+
+
+    public:
+        PresolverFixture()
+        {
+            const qpmad::MatrixIndex size = 20;
+            const qpmad::MatrixIndex num_ctr = 12;
+
+            getRandomPositiveDefinititeMatrix(H, size);
+            h.setRandom(size);
+            h *= 5.0;
+            lb.setConstant(size, -0.5);
+            ub.setConstant(size, 0.5);
+            A.setRandom(num_ctr, size);
+            Alb.setConstant(num_ctr, -1.0);
+            Aub.setConstant(num_ctr, 1.0);
+
+            // fixed variables
+            lb(2) = ub(2) = 0.3;
+            lb(7) = ub(7) = -0.1;
+            lb(19) = ub(19) = 0.0;
+
+            // equality
+            Alb(0) = Aub(0) = 0.2;
+
+            // parallel rows with different bounds
+            A.row(4) = A.row(3);
+            Alb(4) = -0.5;
+            Aub(4) = 2.0;
+            A.row(5) = -2.0 * A.row(3);
+            Alb(5) = -1.5;
+            Aub(5) = 0.5;
+
+            // implied by simple bounds
+            A.row(6) *= 0.01;
+            // differs from row 6 only in a fixed variable
+            A.row(8) = A.row(6);
+            A(8, 2) = 10.0;
+            Alb(8) = -10.0;
+            Aub(8) = 10.0;
+        }
+
+
+        void checkSolution()
+        {
+            H_copy = H;
+            status = solver.solve(x_ref, H_copy, h, lb, ub, A, Alb, Aub, param);
+            BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+            const double objective_ref = solver.getObjective();
+
+            status = presolver.solve(solver, x, H, h, lb, ub, A, Alb, Aub, param);
+            BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+
+            BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+            BOOST_CHECK(std::abs(presolver.getObjective(solver) - objective_ref) < g_default_tolerance);
+
+
+            // multipliers of parallel rows are not unique, check optimality
+            Eigen::VectorXd dual;
+            presolver.getDual(dual, solver, x, H, h, A);
+            BOOST_REQUIRE_EQUAL(dual.rows(), lb.rows() + A.rows());
+
+            Eigen::VectorXd stationarity = H * x + h + A.transpose() * dual.tail(A.rows());
+            if (lb.rows() > 0)
+            {
+                stationarity += dual.head(lb.rows());
+            }
+            BOOST_CHECK(stationarity.norm() < g_default_tolerance);
+
+            const Eigen::VectorXd Ax = A * x;
+            for (qpmad::MatrixIndex i = 0; i < lb.rows(); ++i)
+            {
+                BOOST_CHECK((dual(i) >= 0.0) || (std::abs(x(i) - lb(i)) < g_default_tolerance));
+                BOOST_CHECK((dual(i) <= 0.0) || (std::abs(x(i) - ub(i)) < g_default_tolerance));
+            }
+            for (qpmad::MatrixIndex i = 0; i < A.rows(); ++i)
+            {
+                const double dual_i = dual(lb.rows() + i);
+                BOOST_CHECK((dual_i >= 0.0) || (std::abs(Ax(i) - Alb(i)) < g_default_tolerance));
+                BOOST_CHECK((dual_i <= 0.0) || (std::abs(Ax(i) - Aub(i)) < g_default_tolerance));
+            }
+        }
+};
+
+
+
+BOOST_FIXTURE_TEST_CASE( presolve00, PresolverFixture )
+{
+    checkSolution();
+
+    BOOST_CHECK_EQUAL(presolver.getNumFixedVariables(), 3);
+    // two parallel rows and two implied rows
+    BOOST_CHECK_EQUAL(presolver.getNumRemovedConstraints(), 4);
+
+
+    // factors of the Hessian are not reduced
+    Eigen::MatrixXd L = H;
+    qpmad::CholeskyFactorization::compute(L);
+
+    qpmad::SolverParameters factor_param = param;
+    factor_param.hessian_type_ = qpmad::SolverParameters::HESSIAN_CHOLESKY_FACTOR;
+
+    status = presolver.solve(solver, x, L, h, lb, ub, A, Alb, Aub, factor_param);
+    BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK_EQUAL(presolver.getNumFixedVariables(), 0);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( presolve01, PresolverFixture )
+{
+    // without simple bounds only parallel rows are merged
+    lb.resize(0);
+    ub.resize(0);
+    checkSolution();
+    BOOST_CHECK_EQUAL(presolver.getNumFixedVariables(), 0);
+    BOOST_CHECK_EQUAL(presolver.getNumRemovedConstraints(), 2);
+
+
+    // all variables are fixed
+    lb.setConstant(H.rows(), 0.01);
+    ub = lb;
+    Alb(0) = Aub(0) = A.row(0).sum() * 0.01;
+    checkSolution();
+    BOOST_CHECK_EQUAL(presolver.getNumFixedVariables(), H.rows());
+    BOOST_CHECK_EQUAL(presolver.getNumRemovedConstraints(), A.rows());
+}
+
+
+BOOST_FIXTURE_TEST_CASE( presolve_infeasible00, PresolverFixture )
+{
+    Eigen::VectorXd infeasible_Alb = Alb;
+
+    // the range of the constraint given simple bounds is exceeded
+    infeasible_Alb(1) = Aub(1) = A.row(1).cwiseAbs().sum();
+    infeasible_Alb(1) += 0.1;
+    Aub(1) += 0.1;
+    status = presolver.solve(solver, x, H, h, lb, ub, A, infeasible_Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INFEASIBLE_EQUALITY);
+
+
+    // bounds of parallel rows do not intersect
+    infeasible_Alb = Alb;
+    infeasible_Alb(4) = 1.5;
+    Aub(4) = 2.0;
+    status = presolver.solve(solver, x, H, h, lb, ub, A, infeasible_Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::INFEASIBLE_INEQUALITY);
+}
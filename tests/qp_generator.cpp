@@ -0,0 +1,151 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#include "utf_common.h"
+#include "qp_generator.h"
+
+
+#include "../src/solver.h"
+
+
+class QPGeneratorFixture
+{
+    public:
+        Eigen::VectorXd         x;
+        Eigen::VectorXd         dual;
+        Eigen::MatrixXd         H;
+
+        QPGenerator             generator;
+        QPGeneratorParameters   generator_param;
+
+        qpmad::Solver           solver;
+        qpmad::SolverParameters param;
+
+        qpmad::Solver::ReturnStatus status;
+
+
+    public:
+        /// Solve the generated problem and compare with the known
+        /// solution, the tolerance is scaled by the condition number.
+        void checkSolution(const bool unique_dual)
+        {
+            H = generator.H_;
+            status = solver.solve(  x, H, generator.h_,
+                                    generator.lb_, generator.ub_,
+                                    generator.A_, generator.Alb_, generator.Aub_,
+                                    param);
+            BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+
+            const double tolerance = 1e-11 * generator_param.condition_number_;
+
+            // nearly dependent active constraints determine the primal
+            // solution less accurately than the value of the objective
+            const double primal_tolerance = unique_dual ? tolerance : std::sqrt(tolerance);
+            BOOST_CHECK((x - generator.primal_).lpNorm<Eigen::Infinity>() < primal_tolerance);
+            BOOST_CHECK(std::abs(solver.getObjective() - generator.getObjective()) < tolerance * (1.0 + std::abs(generator.getObjective())));
+
+            solver.getDual(dual);
+            if (unique_dual)
+            {
+                BOOST_CHECK((dual - generator.dual_).lpNorm<Eigen::Infinity>() < tolerance);
+            }
+
+            // constraints with nonzero multipliers are active
+            const qpmad::MatrixIndex num_bounds = generator.lb_.rows();
+            const Eigen::VectorXd Ax = generator.A_ * x;
+            for (qpmad::MatrixIndex i = 0; i < dual.rows(); ++i)
+            {
+                if (0.0 != dual(i))
+                {
+                    BOOST_CHECK(generator.active_[i]);
+                }
+                if (generator.active_[i])
+                {
+                    const double value = (i < num_bounds) ? x(i) : Ax(i - num_bounds);
+                    const double lb = (i < num_bounds) ? generator.lb_(i) : generator.Alb_(i - num_bounds);
+                    const double ub = (i < num_bounds) ? generator.ub_(i) : generator.Aub_(i - num_bounds);
+
+                    BOOST_CHECK(std::min(std::abs(value - lb), std::abs(value - ub)) < tolerance);
+                }
+            }
+        }
+};
+
+
+
+BOOST_FIXTURE_TEST_CASE( generator00, QPGeneratorFixture )
+{
+    generator_param.primal_size_ = 30;
+    generator_param.num_general_constraints_ = 40;
+    generator_param.num_active_bounds_ = 5;
+    generator_param.num_active_general_ = 15;
+    generator_param.num_equalities_ = 3;
+
+    const double condition_numbers[] = {1.0, 1e3, 1e6};
+    for (std::size_t i = 0; i < sizeof(condition_numbers) / sizeof(condition_numbers[0]); ++i)
+    {
+        generator_param.condition_number_ = condition_numbers[i];
+        generator.generate(generator_param, i);
+
+        BOOST_CHECK_EQUAL(generator.getNumActive(), 20);
+
+        const Eigen::VectorXd eigenvalues = Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd>(generator.H_).eigenvalues();
+        BOOST_CHECK_CLOSE(eigenvalues.maxCoeff() / eigenvalues.minCoeff(), condition_numbers[i], 1e-6);
+
+        checkSolution(true);
+    }
+
+
+    // all constraints with nonzero multipliers are equalities
+    generator_param.simple_bounds_ = false;
+    generator_param.num_active_bounds_ = 0;
+    generator_param.num_active_general_ = generator_param.num_equalities_ = generator_param.primal_size_;
+    generator.generate(generator_param);
+    checkSolution(true);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( generator01, QPGeneratorFixture )
+{
+    // MPC-like problem
+    generator_param.primal_size_ = 60;
+    generator_param.stage_size_ = 6;
+    generator_param.num_general_constraints_ = 50;
+    generator_param.num_active_bounds_ = 4;
+    generator_param.num_active_general_ = 10;
+    generator_param.num_equalities_ = 2;
+    generator_param.condition_number_ = 1e4;
+
+    generator.generate(generator_param, 1);
+    BOOST_CHECK(generator.H_.block(0, 6, 6, 54).isZero());
+    BOOST_CHECK(generator.A_.row(0).tail(48).isZero());
+    checkSolution(true);
+
+
+    // degenerate and nearly dependent constraints
+    generator_param.num_degenerate_ = 5;
+    generator_param.num_nearly_dependent_ = 5;
+
+    generator.generate(generator_param, 2);
+    BOOST_CHECK_EQUAL(generator.getNumActive(), 24);
+    checkSolution(false);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( generator_invalid00, QPGeneratorFixture )
+{
+    generator_param.num_active_general_ = 5;
+    generator_param.num_equalities_ = 6;
+    BOOST_CHECK_THROW(generator.generate(generator_param), std::invalid_argument);
+
+    generator_param.num_equalities_ = 0;
+    generator_param.num_active_bounds_ = 16;
+    BOOST_CHECK_THROW(generator.generate(generator_param), std::invalid_argument);
+}
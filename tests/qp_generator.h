@@ -0,0 +1,422 @@
+/**
+    @file
+    @author  Alexander Sherikov
+
+    @copyright 2017 Alexander Sherikov. Licensed under the Apache License,
+    Version 2.0. (see LICENSE or http://www.apache.org/licenses/LICENSE-2.0)
+
+    @brief
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "../src/common.h"
+
+
+/**
+ * @brief Parameters of synthetic problems generated by QPGenerator.
+ */
+class QPGeneratorParameters
+{
+    public:
+        /// Number of variables.
+        qpmad::MatrixIndex  primal_size_;
+        /// Number of general constraints.
+        qpmad::MatrixIndex  num_general_constraints_;
+
+        /// Add simple bounds.
+        bool                simple_bounds_;
+        /// Number of simple bounds active at the solution.
+        qpmad::MatrixIndex  num_active_bounds_;
+
+        /// Number of general constraints active at the solution with
+        /// nonzero multipliers, the first 'num_equalities_' of them are
+        /// equalities.
+        qpmad::MatrixIndex  num_active_general_;
+        qpmad::MatrixIndex  num_equalities_;
+
+        /// Number of general constraints active at the solution with zero
+        /// multipliers (degenerate solution).
+        qpmad::MatrixIndex  num_degenerate_;
+        /// Number of general constraints obtained by perturbation of
+        /// active constraints with 'dependency_perturbation_', they are
+        /// active with zero multipliers.
+        qpmad::MatrixIndex  num_nearly_dependent_;
+        double              dependency_perturbation_;
+
+        /// Ratio of the largest and the smallest eigenvalues of the Hessian.
+        double              condition_number_;
+
+        /**
+         * MPC-like sparsity: if nonzero, variables are split into stages of
+         * this size, the Hessian is block diagonal with a block per stage,
+         * each general constraint couples a pair of consecutive stages.
+         * Dense problems are generated otherwise.
+         */
+        qpmad::MatrixIndex  stage_size_;
+
+
+    public:
+        QPGeneratorParameters()
+        {
+            primal_size_ = 20;
+            num_general_constraints_ = 10;
+
+            simple_bounds_ = true;
+            num_active_bounds_ = 0;
+
+            num_active_general_ = 0;
+            num_equalities_ = 0;
+
+            num_degenerate_ = 0;
+            num_nearly_dependent_ = 0;
+            dependency_perturbation_ = 1e-6;
+
+            condition_number_ = 1.0;
+
+            stage_size_ = 0;
+        }
+};
+
+
+/**
+ * @brief Generator of problems with a known solution.
+ *
+ * The solution, the active set and the multipliers are chosen first, the
+ * linear term of the objective is then computed from the stationarity
+ * condition
+ * H * primal + h + sum_i dual_i * a_i = 0,
+ * where multipliers follow the convention of Solver::getDual(). The
+ * Hessian is positive definite, so the primal solution is unique.
+ */
+class QPGenerator
+{
+    public:
+        Eigen::MatrixXd     H_;
+        Eigen::VectorXd     h_;
+        Eigen::VectorXd     lb_;
+        Eigen::VectorXd     ub_;
+        Eigen::MatrixXd     A_;
+        Eigen::VectorXd     Alb_;
+        Eigen::VectorXd     Aub_;
+
+        /// Solution.
+        Eigen::VectorXd     primal_;
+        /// Multipliers of the solution indexed as in Solver::getDual().
+        Eigen::VectorXd     dual_;
+        /// Constraints active at the solution indexed as multipliers.
+        std::vector<bool>   active_;
+
+
+    public:
+        /**
+         * @brief Generate a problem.
+         *
+         * @param[in] param parameters
+         * @param[in] seed  seed of std::rand(), which is used by Eigen
+         *
+         * @throw std::invalid_argument if the numbers of constraints are
+         * inconsistent or the constraints active with nonzero multipliers
+         * are linearly dependent.
+         */
+        void generate(  const QPGeneratorParameters     & param,
+                        const unsigned int              seed = 0)
+        {
+            checkParameters(param);
+
+            std::srand(seed);
+
+            const qpmad::MatrixIndex size = param.primal_size_;
+            const qpmad::MatrixIndex num_ctr = param.num_general_constraints_;
+            const qpmad::MatrixIndex num_bounds = param.simple_bounds_ ? size : 0;
+
+
+            generateHessian(param);
+
+            // strictly inside of the default simple bounds
+            primal_ = 0.5 * Eigen::VectorXd::Random(size);
+
+            dual_.setZero(num_bounds + num_ctr);
+            active_.assign(num_bounds + num_ctr, false);
+
+
+            // simple bounds
+            lb_.setConstant(num_bounds, -1.0);
+            ub_.setConstant(num_bounds, 1.0);
+
+            const std::vector<qpmad::MatrixIndex> variables = getPermutation(num_bounds);
+            for (qpmad::MatrixIndex i = 0; i < param.num_active_bounds_; ++i)
+            {
+                const qpmad::MatrixIndex index = variables[i];
+
+                active_[index] = true;
+                dual_(index) = getMultiplier();
+                if (dual_(index) > 0.0)
+                {
+                    ub_(index) = primal_(index);
+                }
+                else
+                {
+                    lb_(index) = primal_(index);
+                }
+            }
+
+
+            // general constraints
+            A_.resize(num_ctr, size);
+            for (qpmad::MatrixIndex i = 0; i < num_ctr; ++i)
+            {
+                generateRow(param, i);
+            }
+
+            Alb_.resize(num_ctr);
+            Aub_.resize(num_ctr);
+
+            const std::vector<qpmad::MatrixIndex> constraints = getPermutation(num_ctr);
+            const qpmad::MatrixIndex num_random_active = param.num_active_general_ + param.num_degenerate_;
+            const qpmad::MatrixIndex num_active = num_random_active + param.num_nearly_dependent_;
+
+            for (qpmad::MatrixIndex i = 0; i < num_ctr; ++i)
+            {
+                const qpmad::MatrixIndex index = constraints[i];
+                const qpmad::MatrixIndex dual_index = num_bounds + index;
+
+                if (i >= num_random_active && i < num_active)
+                {
+                    // perturbed copy of a constraint with nonzero multiplier
+                    const qpmad::MatrixIndex source = constraints[std::rand() % param.num_active_general_];
+                    const Eigen::VectorXd perturbation = param.dependency_perturbation_ * Eigen::VectorXd::Random(size);
+
+                    for (qpmad::MatrixIndex j = 0; j < size; ++j)
+                    {
+                        if (0.0 != A_(source, j))
+                        {
+                            A_(index, j) = A_(source, j) + perturbation(j);
+                        }
+                        else
+                        {
+                            A_(index, j) = 0.0;
+                        }
+                    }
+                }
+
+                const double value = A_.row(index).dot(primal_.transpose());
+
+                if (i < num_active)
+                {
+                    active_[dual_index] = true;
+
+                    double side = 0.0;
+                    if (i < param.num_active_general_)
+                    {
+                        dual_(dual_index) = getMultiplier();
+                        side = dual_(dual_index);
+                    }
+                    else
+                    {
+                        side = getMultiplier();
+                    }
+
+                    if (i < param.num_equalities_)
+                    {
+                        Alb_(index) = Aub_(index) = value;
+                    }
+                    else
+                    {
+                        if (side > 0.0)
+                        {
+                            Alb_(index) = value - getMargin();
+                            Aub_(index) = value;
+                        }
+                        else
+                        {
+                            Alb_(index) = value;
+                            Aub_(index) = value + getMargin();
+                        }
+                    }
+                }
+                else
+                {
+                    Alb_(index) = value - getMargin();
+                    Aub_(index) = value + getMargin();
+                }
+            }
+
+
+            checkActiveConstraints();
+
+
+            h_ = - H_ * primal_ - A_.transpose() * dual_.tail(num_ctr);
+            if (num_bounds > 0)
+            {
+                h_ -= dual_.head(num_bounds);
+            }
+        }
+
+
+        /// Value of the objective at the solution, see Solver::getObjective().
+        double getObjective() const
+        {
+            return (0.5 * primal_.dot(H_ * primal_) + h_.dot(primal_));
+        }
+
+
+        /// Number of constraints active at the solution.
+        qpmad::MatrixIndex getNumActive() const
+        {
+            return (std::count(active_.begin(), active_.end(), true));
+        }
+
+
+    private:
+        void checkParameters(const QPGeneratorParameters & param) const
+        {
+            if (    (param.primal_size_ <= 0)
+                    || (param.num_general_constraints_ < 0)
+                    || (param.num_active_bounds_ < 0)
+                    || (param.num_active_general_ < 0)
+                    || (param.num_equalities_ < 0)
+                    || (param.num_degenerate_ < 0)
+                    || (param.num_nearly_dependent_ < 0)
+                    || (param.stage_size_ < 0)
+                    || (param.stage_size_ > param.primal_size_)
+                    || (param.condition_number_ < 1.0))
+            {
+                throw std::invalid_argument("Wrong parameters of the generator.");
+            }
+
+            if (    ((!param.simple_bounds_) && (param.num_active_bounds_ > 0))
+                    || (param.num_active_bounds_ + param.num_active_general_ > param.primal_size_)
+                    || (param.num_equalities_ > param.num_active_general_)
+                    || ((param.num_nearly_dependent_ > 0) && (0 == param.num_active_general_))
+                    || (    param.num_active_general_ + param.num_degenerate_ + param.num_nearly_dependent_
+                            > param.num_general_constraints_))
+            {
+                throw std::invalid_argument("Inconsistent numbers of constraints.");
+            }
+        }
+
+
+        /// Eigenvalues are spaced logarithmically between 1 and the
+        /// condition number and are shuffled between stages.
+        void generateHessian(const QPGeneratorParameters & param)
+        {
+            const qpmad::MatrixIndex size = param.primal_size_;
+            const qpmad::MatrixIndex stage_size = (0 == param.stage_size_) ? size : param.stage_size_;
+
+            Eigen::VectorXd eigenvalues(size);
+            const std::vector<qpmad::MatrixIndex> order = getPermutation(size);
+            for (qpmad::MatrixIndex i = 0; i < size; ++i)
+            {
+                const double exponent = (size > 1) ? static_cast<double>(order[i]) / (size - 1) : 0.0;
+                eigenvalues(i) = std::pow(param.condition_number_, exponent);
+            }
+
+            H_.setZero(size, size);
+            for (qpmad::MatrixIndex begin = 0; begin < size; begin += stage_size)
+            {
+                const qpmad::MatrixIndex length = std::min(stage_size, size - begin);
+
+                const Eigen::MatrixXd random = Eigen::MatrixXd::Random(length, length);
+                const Eigen::MatrixXd Q = Eigen::HouseholderQR<Eigen::MatrixXd>(random).householderQ();
+
+                H_.block(begin, begin, length, length) =
+                    Q * eigenvalues.segment(begin, length).asDiagonal() * Q.transpose();
+            }
+            // exactly symmetric
+            H_ = 0.5 * (H_ + H_.transpose()).eval();
+        }
+
+
+        void generateRow(   const QPGeneratorParameters     & param,
+                            const qpmad::MatrixIndex        index)
+        {
+            const qpmad::MatrixIndex size = param.primal_size_;
+
+            if (0 == param.stage_size_)
+            {
+                A_.row(index).setRandom();
+            }
+            else
+            {
+                const qpmad::MatrixIndex num_stages = (size + param.stage_size_ - 1) / param.stage_size_;
+                const qpmad::MatrixIndex begin = (index % num_stages) * param.stage_size_;
+                const qpmad::MatrixIndex length = std::min(2 * param.stage_size_, size - begin);
+
+                A_.row(index).setZero();
+                A_.row(index).segment(begin, length).setRandom();
+            }
+        }
+
+
+        /// Constraints with nonzero multipliers must be linearly
+        /// independent, otherwise the multipliers are not unique.
+        void checkActiveConstraints() const
+        {
+            const qpmad::MatrixIndex size = primal_.rows();
+            const qpmad::MatrixIndex num_bounds = lb_.rows();
+
+            Eigen::MatrixXd active_rows(size, dual_.rows());
+            qpmad::MatrixIndex num_active_rows = 0;
+            for (qpmad::MatrixIndex i = 0; i < dual_.rows(); ++i)
+            {
+                if (0.0 != dual_(i))
+                {
+                    if (i < num_bounds)
+                    {
+                        active_rows.col(num_active_rows) = Eigen::VectorXd::Unit(size, i);
+                    }
+                    else
+                    {
+                        active_rows.col(num_active_rows) = A_.row(i - num_bounds).transpose();
+                    }
+                    ++num_active_rows;
+                }
+            }
+
+            if (    (num_active_rows > 0)
+                    && (Eigen::FullPivLU<Eigen::MatrixXd>(active_rows.leftCols(num_active_rows)).rank() < num_active_rows))
+            {
+                throw std::invalid_argument("Active constraints are linearly dependent, reduce their number.");
+            }
+        }
+
+
+        /// Random permutation of indices, which depends on the seed only.
+        static std::vector<qpmad::MatrixIndex> getPermutation(const qpmad::MatrixIndex size)
+        {
+            std::vector<qpmad::MatrixIndex> permutation(size);
+            for (qpmad::MatrixIndex i = 0; i < size; ++i)
+            {
+                permutation[i] = i;
+            }
+            for (qpmad::MatrixIndex i = size - 1; i > 0; --i)
+            {
+                std::swap(permutation[i], permutation[std::rand() % (i + 1)]);
+            }
+            return (permutation);
+        }
+
+
+        /// Multiplier of random sign, its magnitude is in [0.1, 1.1].
+        static double getMultiplier()
+        {
+            const double magnitude = 0.1 + static_cast<double>(std::rand()) / RAND_MAX;
+            return ((std::rand() % 2 == 0) ? magnitude : -magnitude);
+        }
+
+
+        /// Distance from the solution to inactive bounds, at least 0.1.
+        static double getMargin()
+        {
+            return (0.1 + static_cast<double>(std::rand()) / RAND_MAX);
+        }
+};
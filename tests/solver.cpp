@@ -8,6 +8,9 @@
     @brief
 */
 
+// detect allocations in the solver, see external_workspace00
+#define EIGEN_RUNTIME_NO_MALLOC
+
 #include "utf_common.h"
 
 
@@ -408,3 +411,1522 @@ BOOST_FIXTURE_TEST_CASE( general_inequalities21, SolverGeneralInequalitiesFixtur
             -0.71875, -0.71875;
     checkGeneralInequalities();
 }
+
+
+
+class SolverMappedInputFixture : public SolverGeneralInequalitiesFixture
+{
+    public:
+        Eigen::MatrixXd         H_ref;
+
+    public:
+        void initialize(const qpmad::MatrixIndex size, const qpmad::MatrixIndex num_ctr)
+        {
+            getRandomPositiveDefinititeMatrix(H, size);
+            H_ref = H;
+            h.setRandom(size);
+
+            A.setRandom(num_ctr, size);
+            Alb.setConstant(num_ctr, -1.0);
+            Aub.setConstant(num_ctr, 1.0);
+
+            status = solver.solve(x_ref, H_ref, h, A, Alb, Aub);
+            BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+        }
+};
+
+
+BOOST_FIXTURE_TEST_CASE( mapped_input00, SolverMappedInputFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    initialize(size, num_ctr);
+
+
+    std::vector<double> x_buffer(size, 0.0);
+    std::vector<double> H_buffer(H.data(), H.data() + size*size);
+
+    Eigen::Map<Eigen::VectorXd>         x_map(&x_buffer[0], size);
+    Eigen::Map<Eigen::MatrixXd>         H_map(&H_buffer[0], size, size);
+    Eigen::Map<const Eigen::VectorXd>   h_map(h.data(), size);
+    Eigen::Map<const Eigen::MatrixXd>   A_map(A.data(), num_ctr, size);
+    Eigen::Map<const Eigen::VectorXd>   Alb_map(Alb.data(), num_ctr);
+    Eigen::Map<const Eigen::VectorXd>   Aub_map(Aub.data(), num_ctr);
+
+    status = solver.solve(x_map, H_map, h_map, A_map, Alb_map, Aub_map);
+
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x_map.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( mapped_input01, SolverMappedInputFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    initialize(size, num_ctr);
+
+
+    // row-major constraints and strided bounds
+    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>  A_row_major = A;
+    Eigen::MatrixXd     bounds(2, num_ctr);
+    bounds.row(0) = Alb.transpose();
+    bounds.row(1) = Aub.transpose();
+
+    Eigen::Map<const Eigen::VectorXd, 0, Eigen::InnerStride<> >  Alb_map(bounds.data(), num_ctr, Eigen::InnerStride<>(2));
+    Eigen::Map<const Eigen::VectorXd, 0, Eigen::InnerStride<> >  Aub_map(bounds.data() + 1, num_ctr, Eigen::InnerStride<>(2));
+
+
+    // Hessian is a block of a larger matrix
+    Eigen::MatrixXd                 H_storage(size + 3, size);
+    H_storage.topRows(size) = H;
+    Eigen::Ref<Eigen::MatrixXd>     H_ref_block = H_storage.topRows(size);
+
+    Eigen::VectorXd                 x_storage(size);
+    Eigen::Ref<Eigen::VectorXd>     x_ref_vector = x_storage;
+
+    status = solver.solve(x_ref_vector, H_ref_block, h, A_row_major, Alb_map, Aub_map);
+
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x_storage.isApprox(x_ref, g_default_tolerance));
+}
+
+
+
+class SolverSimpleBoundsFixture : public SolverGeneralInequalitiesFixture
+{
+    public:
+        Eigen::VectorXd     lb;
+        Eigen::VectorXd     ub;
+
+    public:
+        void checkSimpleBounds()
+        {
+            status = solver.solve(x, H, h, lb, ub, A, Alb, Aub);
+
+            BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+            BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+        }
+};
+
+
+BOOST_FIXTURE_TEST_CASE( simple_bounds00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+
+    H.setIdentity(size, size);
+    h.setOnes(size);
+
+    lb.resize(size);
+    ub.resize(size);
+    lb << 1, 2, 3, 4, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5;
+    ub << 1, 2, 3, 4, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5;
+
+    x_ref.resize(size);
+    x_ref << 1.0, 2.0, 3.0, 4.0, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5;
+
+    checkSimpleBounds();
+}
+
+
+BOOST_FIXTURE_TEST_CASE( simple_bounds01, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 1;
+
+    H.setIdentity(size, size);
+    h.setOnes(size);
+
+    lb.resize(size);
+    ub.resize(size);
+    lb << 1, 2, 3, 4, -5, -5, -5, -5, -5, -5, -5, -5, -5, -5, -5, -5, -5, -5, -5, -5;
+    ub << 1, 2, 3, 4, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5;
+
+    A.setOnes(num_ctr, size);
+    Alb.resize(num_ctr);
+    Aub.resize(num_ctr);
+    Alb << -1.5;
+    Aub << 1.5;
+
+    x_ref.resize(size);
+    x_ref << 1.0, 2.0, 3.0, 4.0, -0.71875, -0.71875,
+            -0.71875, -0.71875, -0.71875, -0.71875,
+            -0.71875, -0.71875, -0.71875, -0.71875,
+            -0.71875, -0.71875, -0.71875, -0.71875,
+            -0.71875, -0.71875;
+
+    checkSimpleBounds();
+}
+
+
+BOOST_FIXTURE_TEST_CASE( warm_start00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 30;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    lb.setConstant(size, -0.1);
+    ub.setConstant(size, 0.1);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.2);
+    Aub.setConstant(num_ctr, 0.2);
+
+    qpmad::SolverParameters     param;
+    param.warm_start_ = true;
+
+    qpmad::Solver               cold_solver;
+
+
+    for (std::size_t i = 0; i < 20; ++i)
+    {
+        // both the objective and the bounds change
+        h += 0.2 * Eigen::VectorXd::Random(size);
+        lb(i) = -1.0;
+
+        H = H_copy;
+        status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        H = H_copy;
+        status = cold_solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE( external_workspace00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 30;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    lb.setConstant(size, -0.1);
+    ub.setConstant(size, 0.1);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.2);
+    Aub.setConstant(num_ctr, 0.2);
+    x.resize(size);
+
+    qpmad::SolverParameters     param;
+    param.warm_start_ = true;
+
+    const std::size_t   workspace_size = qpmad::Solver::getWorkspaceSize(size, size + num_ctr);
+    std::vector<char>   buffer(workspace_size + QPMAD_WORKSPACE_ALIGNMENT);
+    char *              workspace = &buffer[0]
+                                    + (QPMAD_WORKSPACE_ALIGNMENT
+                                        - reinterpret_cast<std::size_t>(&buffer[0]) % QPMAD_WORKSPACE_ALIGNMENT);
+
+    BOOST_CHECK(false == solver.setWorkspace(workspace + 1, workspace_size));
+    BOOST_REQUIRE(solver.setWorkspace(workspace, workspace_size));
+
+    qpmad::Solver               reference_solver;
+
+    for (std::size_t i = 0; i < 5; ++i)
+    {
+        h += 0.2 * Eigen::VectorXd::Random(size);
+
+        H = H_copy;
+#ifndef QPMAD_ENABLE_TRACING
+        // tracing code allocates temporary matrices
+        Eigen::internal::set_is_malloc_allowed(false);
+#endif
+        status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+        Eigen::internal::set_is_malloc_allowed(true);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        H = H_copy;
+        status = reference_solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+    }
+
+    // too small
+    BOOST_REQUIRE(solver.setWorkspace(workspace, workspace_size - 1));
+    H = H_copy;
+#ifdef QPMAD_NO_EXCEPTIONS
+    BOOST_CHECK_EQUAL(solver.solve(x, H, h, lb, ub, A, Alb, Aub, param), qpmad::Solver::WORKSPACE_TOO_SMALL);
+#else
+    BOOST_CHECK_THROW(solver.solve(x, H, h, lb, ub, A, Alb, Aub, param), std::exception);
+#endif
+}
+
+
+BOOST_FIXTURE_TEST_CASE( resume00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 30;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.2);
+    Aub.setConstant(num_ctr, 0.2);
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    qpmad::Solver               reference_solver;
+    qpmad::SolverParameters     param;
+    std::vector<qpmad::MatrixIndex> removed;
+
+    for (std::size_t i = 0; i < 10; ++i)
+    {
+        // remove every third row starting with a varying offset and
+        // append new rows
+        removed.clear();
+        for (qpmad::MatrixIndex j = i % 3; j < A.rows(); j += 3)
+        {
+            removed.push_back(j);
+        }
+        const qpmad::MatrixIndex num_appended = 5 + i;
+        const qpmad::MatrixIndex num_kept = A.rows() - removed.size();
+
+        Eigen::MatrixXd     A_new(num_kept + num_appended, size);
+        Eigen::VectorXd     Alb_new(num_kept + num_appended);
+        Eigen::VectorXd     Aub_new(num_kept + num_appended);
+
+        qpmad::MatrixIndex  row = 0;
+        for (qpmad::MatrixIndex j = 0; j < A.rows(); ++j)
+        {
+            if (false == std::binary_search(removed.begin(), removed.end(), j))
+            {
+                A_new.row(row) = A.row(j);
+                Alb_new(row) = Alb(j);
+                Aub_new(row) = Aub(j);
+                ++row;
+            }
+        }
+        A_new.bottomRows(num_appended).setRandom();
+        Alb_new.tail(num_appended).setConstant(-0.1);
+        Aub_new.tail(num_appended).setConstant(0.1);
+
+        A = A_new;
+        Alb = Alb_new;
+        Aub = Aub_new;
+
+
+        status = solver.resume(x, H, h, lb, ub, A, Alb, Aub, removed, param);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        Eigen::MatrixXd H_ref = H_copy;
+        status = reference_solver.solve(x_ref, H_ref, h, lb, ub, A, Alb, Aub);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE( resume01, SolverGeneralInequalitiesFixture )
+{
+    qpmad::MatrixIndex size = 20;
+
+    H.setIdentity(size, size);
+    h.setOnes(size);
+
+    // the only constraint is active
+    A.setOnes(1, size);
+    Alb.setConstant(1, -1.0);
+    Aub.setConstant(1, 1.0);
+
+    status = solver.solve(x, H, h, A, Alb, Aub);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(Eigen::VectorXd::Constant(size, -1.0 / size), g_default_tolerance));
+
+
+    // remove it -> unconstrained optimum
+    std::vector<qpmad::MatrixIndex> removed(1, 0);
+    A.resize(0, size);
+    Alb.resize(0);
+    Aub.resize(0);
+
+    status = solver.resume(x, H, h, A, Alb, Aub, removed, qpmad::SolverParameters());
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(-h, g_default_tolerance));
+
+
+    // append an equality
+    removed.clear();
+    A.setZero(1, size);
+    A(0, 0) = 1.0;
+    Alb.setConstant(1, 0.5);
+    Aub.setConstant(1, 0.5);
+
+    status = solver.resume(x, H, h, A, Alb, Aub, removed, qpmad::SolverParameters());
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    x_ref = -h;
+    x_ref(0) = 0.5;
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( max_active_set_size00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+
+    H.setIdentity(size, size);
+    h.setOnes(size);
+
+    // 4 equalities and 16 active lower bounds
+    lb.resize(size);
+    ub.resize(size);
+    lb << 1, 2, 3, 4, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5;
+    ub << 1, 2, 3, 4, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5, 0.5;
+
+    x_ref.resize(size);
+    x_ref << 1.0, 2.0, 3.0, 4.0, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5, -0.5;
+
+    qpmad::SolverParameters     param;
+
+    BOOST_CHECK(qpmad::Solver::getWorkspaceSize(size, size, 10) < qpmad::Solver::getWorkspaceSize(size, size));
+
+    // too small
+    param.max_active_set_size_ = 10;
+    H.setIdentity(size, size);
+    status = solver.solve(x, H, h, lb, ub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::MAXIMAL_ACTIVE_SET_SIZE);
+
+    param.max_active_set_size_ = 2;
+    H.setIdentity(size, size);
+    status = solver.solve(x, H, h, lb, ub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::MAXIMAL_ACTIVE_SET_SIZE);
+
+    // sufficient
+    lb.tail(size - 4).setConstant(-2.0);
+    x_ref.tail(size - 4).setConstant(-1.0);
+
+    param.max_active_set_size_ = 4;
+    H.setIdentity(size, size);
+    status = solver.solve(x, H, h, lb, ub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( max_active_set_size01, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 50;
+    qpmad::MatrixIndex num_ctr = 10;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.1);
+    Aub.setConstant(num_ctr, 0.1);
+
+    qpmad::SolverParameters     param;
+    param.max_active_set_size_ = num_ctr;
+
+    H = H_copy;
+    status = solver.solve(x, H, h, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    H = H_copy;
+    qpmad::Solver   reference_solver;
+    status = reference_solver.solve(x_ref, H, h, A, Alb, Aub);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( row_major00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 30;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    lb.setConstant(size, -0.1);
+    ub.setConstant(size, 0.1);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.2);
+    Aub.setConstant(num_ctr, 0.2);
+
+    H = H_copy;
+    status = solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+
+    qpmad::QPRowMajorMatrix     A_row_major = A;
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A_row_major, Alb, Aub);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+
+
+    Eigen::MatrixXd             At = A.transpose();
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, At.transpose(), Alb, Aub);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( parallel_selection00, SolverGeneralInequalitiesFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 5000;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+
+    // duplicate rows produce ties in constraint selection
+    A.resize(2 * num_ctr, size);
+    A.topRows(num_ctr).setRandom();
+    A.bottomRows(num_ctr) = A.topRows(num_ctr);
+    Alb.setConstant(2 * num_ctr, -0.1);
+    Aub.setConstant(2 * num_ctr, 0.1);
+
+    qpmad::SolverParameters     param;
+
+    H = H_copy;
+    status = solver.solve(x_ref, H, h, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    for (int num_threads = 2; num_threads <= 5; ++num_threads)
+    {
+        param.num_threads_ = num_threads;
+
+        H = H_copy;
+        status = solver.solve(x, H, h, A, Alb, Aub, param);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+        BOOST_CHECK(x.isApprox(x_ref, 1e-12));
+    }
+
+
+    // memory of threads is a part of the workspace
+    const std::size_t   workspace_size = qpmad::Solver::getWorkspaceSize(size, A.rows(), param);
+    std::vector<char>   buffer(workspace_size + QPMAD_WORKSPACE_ALIGNMENT);
+    char *              workspace = &buffer[0]
+                                    + (QPMAD_WORKSPACE_ALIGNMENT
+                                        - reinterpret_cast<std::size_t>(&buffer[0]) % QPMAD_WORKSPACE_ALIGNMENT);
+    BOOST_REQUIRE(solver.setWorkspace(workspace, workspace_size));
+
+    H = H_copy;
+#ifndef QPMAD_ENABLE_TRACING
+    Eigen::internal::set_is_malloc_allowed(false);
+#endif
+    status = solver.solve(x, H, h, A, Alb, Aub, param);
+    Eigen::internal::set_is_malloc_allowed(true);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, 1e-12));
+}
+
+
+class DenseConstraintOracle : public qpmad::ConstraintOracle
+{
+    public:
+        Eigen::MatrixXd     A_;
+        Eigen::VectorXd     Alb_;
+        Eigen::VectorXd     Aub_;
+        std::size_t         num_calls_;
+
+    public:
+        DenseConstraintOracle(  const Eigen::MatrixXd &A,
+                                const Eigen::VectorXd &Alb,
+                                const Eigen::VectorXd &Aub)
+            : A_(A), Alb_(Alb), Aub_(Aub)
+        {
+            num_calls_ = 0;
+        }
+
+
+        bool getMostViolatedConstraint( const Eigen::Ref<const qpmad::QPVector>    & primal,
+                                        const double                                tolerance,
+                                        Eigen::Ref<qpmad::QPVector>                 row,
+                                        double                                      & lb,
+                                        double                                      & ub)
+        {
+            ++num_calls_;
+
+            const Eigen::VectorXd dot = A_ * primal;
+            double max_violation = tolerance;
+            qpmad::MatrixIndex max_index = -1;
+
+            for (qpmad::MatrixIndex i = 0; i < A_.rows(); ++i)
+            {
+                const double violation = std::max(Alb_(i) - dot(i), dot(i) - Aub_(i));
+                if (violation > max_violation)
+                {
+                    max_violation = violation;
+                    max_index = i;
+                }
+            }
+
+            if (max_index < 0)
+            {
+                return (false);
+            }
+
+            row = A_.row(max_index).transpose();
+            lb = Alb_(max_index);
+            ub = Aub_(max_index);
+            return (true);
+        }
+};
+
+
+BOOST_FIXTURE_TEST_CASE( oracle00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 2000;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.1);
+    Aub.setConstant(num_ctr, 0.1);
+
+    qpmad::SolverParameters     param;
+
+    H = H_copy;
+    status = solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    DenseConstraintOracle oracle(A, Alb, Aub);
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, oracle, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+    BOOST_CHECK(oracle.num_calls_ > 0);
+
+    // without simple bounds
+    H = H_copy;
+    status = solver.solve(x_ref, H, h, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    H = H_copy;
+    status = solver.solve(x, H, h, oracle, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+class PolygonConstraintOracle : public qpmad::ConstraintOracle
+{
+    public:
+        qpmad::MatrixIndex  num_sides_;
+
+    public:
+        explicit PolygonConstraintOracle(const qpmad::MatrixIndex num_sides)
+        {
+            num_sides_ = num_sides;
+        }
+
+
+        /// Regular polygon inscribed in the unit circle, the side facing
+        /// the point is the most violated.
+        bool getMostViolatedConstraint( const Eigen::Ref<const qpmad::QPVector>    & primal,
+                                        const double                                tolerance,
+                                        Eigen::Ref<qpmad::QPVector>                 row,
+                                        double                                      & lb,
+                                        double                                      & ub)
+        {
+            const double step = 2.0 * M_PI / num_sides_;
+            const double angle = std::atan2(primal(1), primal(0));
+            const double side_angle = step * std::floor(angle / step + 0.5);
+
+            row << std::cos(side_angle), std::sin(side_angle);
+            lb = -std::numeric_limits<double>::infinity();
+            ub = std::cos(step / 2.0);
+
+            return (row.dot(primal) - ub > tolerance);
+        }
+};
+
+
+BOOST_FIXTURE_TEST_CASE( oracle01, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 2;
+    qpmad::MatrixIndex num_sides = 100000;
+
+    const double side_angle = 12345 * 2.0 * M_PI / num_sides;
+    x_ref.resize(size);
+    x_ref << std::cos(side_angle), std::sin(side_angle);
+
+    // the point is projected onto the middle of a side
+    H.setIdentity(size, size);
+    h = -5.0 * x_ref;
+    x_ref *= std::cos(M_PI / num_sides);
+
+    PolygonConstraintOracle oracle(num_sides);
+    status = solver.solve(x, H, h, oracle, qpmad::SolverParameters());
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( oracle02, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 2000;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.01);
+    Aub.setConstant(num_ctr, 0.01);
+
+    DenseConstraintOracle oracle(A, Alb, Aub);
+
+    // generated constraints do not fit into max_active_set_size_ + 1
+    // slots
+    qpmad::SolverParameters     param;
+    param.max_active_set_size_ = 2;
+
+    H = H_copy;
+    status = solver.solve(x, H, h, oracle, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::MAXIMAL_ACTIVE_SET_SIZE);
+    BOOST_CHECK(oracle.num_calls_ >= 3);
+
+    param.max_active_set_size_ = 0;
+    H = H_copy;
+    status = solver.solve(x, H, h, oracle, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::MAXIMAL_ACTIVE_SET_SIZE);
+
+
+    // the solver is usable afterwards
+    param.max_active_set_size_ = -1;
+    H = H_copy;
+    status = solver.solve(x_ref, H, h, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    H = H_copy;
+    status = solver.solve(x, H, h, oracle, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( oracle03, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 2;
+
+    PolygonConstraintOracle oracle(1000);
+
+    H_copy.setIdentity(size, size);
+    lb.setConstant(size, -0.9);
+    ub.setConstant(size, 0.9);
+    x.resize(size);
+
+    qpmad::SolverParameters     param;
+
+    // generated constraints are kept in the external workspace
+    const std::size_t   workspace_size = qpmad::Solver::getOracleWorkspaceSize(size, size, param);
+    std::vector<char>   buffer(workspace_size + QPMAD_WORKSPACE_ALIGNMENT);
+    char *              workspace = &buffer[0]
+                                    + (QPMAD_WORKSPACE_ALIGNMENT
+                                        - reinterpret_cast<std::size_t>(&buffer[0]) % QPMAD_WORKSPACE_ALIGNMENT);
+
+    BOOST_REQUIRE(solver.setWorkspace(workspace, workspace_size));
+
+    qpmad::Solver               reference_solver;
+
+    for (std::size_t i = 0; i < 5; ++i)
+    {
+        h.setRandom(size);
+        h *= 5.0;
+
+        H = H_copy;
+#ifndef QPMAD_ENABLE_TRACING
+        // tracing code allocates temporary matrices
+        Eigen::internal::set_is_malloc_allowed(false);
+#endif
+        status = solver.solve(x, H, h, lb, ub, oracle, param);
+        Eigen::internal::set_is_malloc_allowed(true);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        H = H_copy;
+        status = reference_solver.solve(x_ref, H, h, lb, ub, oracle, param);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+    }
+
+    // too small
+    BOOST_REQUIRE(solver.setWorkspace(workspace, workspace_size - 1));
+    H = H_copy;
+#ifdef QPMAD_NO_EXCEPTIONS
+    BOOST_CHECK_EQUAL(solver.solve(x, H, h, lb, ub, oracle, param), qpmad::Solver::WORKSPACE_TOO_SMALL);
+#else
+    BOOST_CHECK_THROW(solver.solve(x, H, h, lb, ub, oracle, param), std::exception);
+#endif
+}
+
+
+BOOST_FIXTURE_TEST_CASE( factorization_cache00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.1);
+    Aub.setConstant(num_ctr, 0.1);
+    // an equality constraint
+    Alb(0) = Aub(0) = 0.05;
+
+    std::vector<Eigen::VectorXd> h_values(2);
+    h_values[0].setRandom(size);
+    h_values[1] = -h_values[0];
+
+    qpmad::FactorizationCache   cache;
+    qpmad::Solver               cached_solver;
+    cached_solver.setFactorizationCache(&cache);
+
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        h = h_values[i % 2];
+
+        H = H_copy;
+        status = solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        H = H_copy;
+        status = cached_solver.solve(x, H, h, lb, ub, A, Alb, Aub);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+        BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+    }
+
+    // the first occurrence of each active set is a miss
+    BOOST_CHECK_EQUAL(cache.getNumMisses(), 2);
+    BOOST_CHECK_EQUAL(cache.getNumHits(), 4);
+    BOOST_CHECK_EQUAL(cache.getNumEntries(), 2);
+
+
+    // memory bound
+    cache.setMaxSize(cache.getSize() - 1);
+    BOOST_CHECK_EQUAL(cache.getNumEntries(), 1);
+    BOOST_CHECK(cache.getSize() <= cache.getMaxSize());
+
+    cache.clear();
+    BOOST_CHECK_EQUAL(cache.getNumEntries(), 0);
+    BOOST_CHECK_EQUAL(cache.getSize(), 0);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( factorization_cache01, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.1);
+    Aub.setConstant(num_ctr, 0.1);
+    Alb(0) = Aub(0) = 0.05;
+
+    std::vector<Eigen::VectorXd> h_values(2);
+    h_values[0].setRandom(size);
+    h_values[1] = -h_values[0];
+
+    qpmad::FactorizationCache   cache;
+    qpmad::Solver               cached_solver;
+    cached_solver.setFactorizationCache(&cache);
+
+    // only the active set guessed by the crash procedure is looked up
+    qpmad::SolverParameters     param;
+    param.max_cache_candidates_ = 0;
+    param.crash_ = true;
+
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        h = h_values[i % 2];
+
+        H = H_copy;
+        status = solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+        x = x_ref;
+        H = H_copy;
+        status = cached_solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+        BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+    }
+
+    BOOST_CHECK_EQUAL(cache.getNumMisses(), 2);
+    BOOST_CHECK_EQUAL(cache.getNumHits(), 4);
+
+
+    // no candidates without the crash procedure
+    param.crash_ = false;
+    cache.resetCounters();
+    for (std::size_t i = 0; i < 2; ++i)
+    {
+        h = h_values[i % 2];
+        H = H_copy;
+        status = cached_solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    }
+
+    BOOST_CHECK_EQUAL(cache.getNumMisses(), 2);
+    BOOST_CHECK_EQUAL(cache.getNumHits(), 0);
+}
+
+
+class SolverIterationCountFixture : public SolverSimpleBoundsFixture
+{
+    public:
+        /// Find the minimal number of iterations by limiting it.
+        int solveWithMinimalNumberOfIterations( qpmad::SolverParameters & param,
+                                                const Eigen::VectorXd   & x_init = Eigen::VectorXd())
+        {
+            for (param.max_iter_ = 1; ; ++param.max_iter_)
+            {
+                H = H_copy;
+                x = x_init;
+                status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+                if (qpmad::Solver::MAXIMAL_NUMBER_OF_ITERATIONS != status)
+                {
+                    return (param.max_iter_);
+                }
+            }
+        }
+};
+
+
+BOOST_FIXTURE_TEST_CASE( block_activation00, SolverIterationCountFixture )
+{
+    qpmad::MatrixIndex size = 40;
+    qpmad::MatrixIndex num_ctr = 60;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    // many constraints are violated by the unconstrained optimum
+    h.setRandom(size);
+    h *= 10.0;
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -1.0);
+    Aub.setConstant(num_ctr, 1.0);
+    // an equality constraint
+    Alb(0) = Aub(0) = 0.2;
+
+
+    qpmad::SolverParameters     param;
+
+    const int num_iter = solveWithMinimalNumberOfIterations(param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    x_ref = x;
+
+    param.max_block_size_ = size;
+    BOOST_CHECK(solveWithMinimalNumberOfIterations(param) < num_iter);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+
+
+    // small blocks and limited active set
+    param.max_iter_ = -1;
+    param.max_block_size_ = 3;
+    param.max_active_set_size_ = size / 2;
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    if (qpmad::Solver::OK == status)
+    {
+        BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+    }
+    else
+    {
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::MAXIMAL_ACTIVE_SET_SIZE);
+    }
+
+
+    // temporary data of block activation is a part of the workspace
+    param.max_block_size_ = size;
+    param.max_active_set_size_ = -1;
+
+    const std::size_t   workspace_size = qpmad::Solver::getWorkspaceSize(size, size + num_ctr, param);
+    std::vector<char>   buffer(workspace_size + QPMAD_WORKSPACE_ALIGNMENT);
+    char *              workspace = &buffer[0]
+                                    + (QPMAD_WORKSPACE_ALIGNMENT
+                                        - reinterpret_cast<std::size_t>(&buffer[0]) % QPMAD_WORKSPACE_ALIGNMENT);
+    BOOST_REQUIRE(solver.setWorkspace(workspace, workspace_size));
+
+    H = H_copy;
+#ifndef QPMAD_ENABLE_TRACING
+    Eigen::internal::set_is_malloc_allowed(false);
+#endif
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    Eigen::internal::set_is_malloc_allowed(true);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( crash00, SolverIterationCountFixture )
+{
+    qpmad::MatrixIndex size = 30;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    h *= 5.0;
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -1.0);
+    Aub.setConstant(num_ctr, 1.0);
+
+
+    qpmad::SolverParameters     param;
+
+    const int num_iter = solveWithMinimalNumberOfIterations(param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    x_ref = x;
+
+
+    // approximate solution, e.g., of a similar problem
+    Eigen::VectorXd x_hint = x_ref + 1e-5 * Eigen::VectorXd::Random(size);
+
+    param.crash_ = true;
+    param.crash_tolerance_ = 1e-3;
+    BOOST_CHECK(solveWithMinimalNumberOfIterations(param, x_hint) < num_iter);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+
+
+    // wrong guesses are dropped: all bounds are tight at the hint
+    x_hint.setConstant(size, 0.5);
+    param.max_iter_ = -1;
+
+    H = H_copy;
+    x = x_hint;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+
+
+    // hint of a wrong size is ignored
+    x.resize(0);
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( crash01, SolverIterationCountFixture )
+{
+    qpmad::MatrixIndex size = 30;
+    qpmad::MatrixIndex num_eq = 5;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    h *= 5.0;
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    // equalities
+    lb.head(num_eq).setConstant(0.1);
+    ub.head(num_eq).setConstant(0.1);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -1.0);
+    Aub.setConstant(num_ctr, 1.0);
+    // inequalities, which are tight at the solution, but linearly
+    // dependent on the equalities
+    A.topRows(num_eq).setZero();
+    A.topLeftCorner(num_eq, num_eq).setIdentity();
+    Alb.head(num_eq).setConstant(0.1);
+
+
+    qpmad::SolverParameters     param;
+
+    H = H_copy;
+    status = solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+
+    Eigen::VectorXd dual;
+    solver.getDual(dual);
+
+
+    // the active set is guessed exactly, equalities and skipped dependent
+    // inequalities do not reduce the number of guessed constraints
+    param.crash_ = true;
+    param.crash_tolerance_ = 1e-8;
+    param.max_active_set_size_ = (dual.array() != 0.0).count();
+    BOOST_CHECK_EQUAL(solveWithMinimalNumberOfIterations(param, x_ref), 1);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( soft_constraints00, SolverSimpleBoundsFixture )
+{
+    qpmad::SolverParameters     param;
+    Eigen::VectorXd             weights(1);
+
+    // min 0.5*|x|^2 - 2*(x1 + x2) + w*max(0, x1 + x2 - 1)
+    H_copy.setIdentity(2, 2);
+    h.setConstant(2, -2.0);
+    A.setOnes(1, 2);
+    Alb.setConstant(1, -std::numeric_limits<double>::infinity());
+    Aub.setConstant(1, 1.0);
+
+
+    // penalty is too small to enforce the constraint
+    weights(0) = 0.5;
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, weights, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(Eigen::Vector2d(1.5, 1.5), g_default_tolerance));
+
+
+    // exact penalty: same result as with a hard constraint
+    weights(0) = 2.0;
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, weights, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(Eigen::Vector2d(0.5, 0.5), g_default_tolerance));
+
+    weights(0) = std::numeric_limits<double>::infinity();
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, weights, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(Eigen::Vector2d(0.5, 0.5), g_default_tolerance));
+
+
+    // random problem with large weights
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 30;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    h *= 5.0;
+    lb.setConstant(size, -1.0);
+    ub.setConstant(size, 1.0);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.5);
+    Aub.setConstant(num_ctr, 0.5);
+
+    H = H_copy;
+    status = solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    weights.setConstant(num_ctr, 1e6);
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, weights, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+
+
+    // zero weights: only simple bounds are enforced
+    weights.setZero(num_ctr);
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, weights, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    H = H_copy;
+    status = solver.solve(x_ref, H, h, lb, ub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( soft_constraints01, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 30;
+    // regularization of slack variables in the reference problem
+    const double    slack_regularization = 1e-8;
+
+    qpmad::SolverParameters     param;
+    Eigen::VectorXd             weights;
+
+    Eigen::MatrixXd             slack_H;
+    Eigen::VectorXd             slack_h;
+    Eigen::VectorXd             slack_lb;
+    Eigen::VectorXd             slack_ub;
+    Eigen::MatrixXd             slack_A;
+    Eigen::VectorXd             slack_Alb;
+    Eigen::VectorXd             slack_Aub;
+    Eigen::VectorXd             slack_x;
+
+    for (int problem = 0; problem < 20; ++problem)
+    {
+        getRandomPositiveDefinititeMatrix(H_copy, size);
+        h.setRandom(size);
+        h *= 5.0;
+        lb.setConstant(size, -1.0);
+        ub.setConstant(size, 1.0);
+        A.setRandom(num_ctr, size);
+        Alb.setConstant(num_ctr, -0.5);
+        Aub.setConstant(num_ctr, 0.5);
+        // intermediate weights: some constraints are saturated
+        weights = Eigen::VectorXd::Random(num_ctr).array().abs() * 2.0;
+        // one sided constraints
+        Alb.head(5).setConstant(-std::numeric_limits<double>::infinity());
+        Aub.segment(5, 5).setConstant(std::numeric_limits<double>::infinity());
+
+
+        H = H_copy;
+        status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, weights, param);
+        BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+
+
+        // equivalent QP with explicit slack variables s >= 0:
+        // min 0.5 * x^T * H * x + h^T * x + w^T * s
+        // s.t. Alb <= A * x + s, A * x - s <= Aub
+        slack_H.setZero(size + num_ctr, size + num_ctr);
+        slack_H.topLeftCorner(size, size) = H_copy;
+        slack_H.bottomRightCorner(num_ctr, num_ctr).diagonal().setConstant(slack_regularization);
+        slack_h.resize(size + num_ctr);
+        slack_h << h, weights;
+        slack_lb.resize(size + num_ctr);
+        slack_lb << lb, Eigen::VectorXd::Zero(num_ctr);
+        slack_ub.resize(size + num_ctr);
+        slack_ub << ub, Eigen::VectorXd::Constant(num_ctr, std::numeric_limits<double>::infinity());
+
+        slack_A.resize(2 * num_ctr, size + num_ctr);
+        slack_A << A, Eigen::MatrixXd::Identity(num_ctr, num_ctr),
+                   A, -Eigen::MatrixXd::Identity(num_ctr, num_ctr);
+        slack_Alb.resize(2 * num_ctr);
+        slack_Alb << Alb, Eigen::VectorXd::Constant(num_ctr, -std::numeric_limits<double>::infinity());
+        slack_Aub.resize(2 * num_ctr);
+        slack_Aub << Eigen::VectorXd::Constant(num_ctr, std::numeric_limits<double>::infinity()), Aub;
+
+        status = solver.solve(slack_x, slack_H, slack_h, slack_lb, slack_ub, slack_A, slack_Alb, slack_Aub, param);
+        BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+
+
+        BOOST_CHECK(x.isApprox(slack_x.head(size), 1e-6));
+
+        const Eigen::VectorXd   ctr_dot_x = A * x;
+        const Eigen::VectorXd   violation = (Alb - ctr_dot_x).cwiseMax(ctr_dot_x - Aub).cwiseMax(0.0);
+        const double            objective = 0.5 * x.dot(H_copy * x) + h.dot(x) + weights.dot(violation);
+        const double            slack_objective =   0.5 * slack_x.head(size).dot(H_copy * slack_x.head(size))
+                                                    + h.dot(slack_x.head(size))
+                                                    + weights.dot(slack_x.tail(num_ctr));
+        BOOST_CHECK_CLOSE(objective, slack_objective, 1e-4);
+    }
+
+
+    // weights are copied to the workspace
+    const std::size_t   workspace_size = qpmad::Solver::getWorkspaceSize(size, size + num_ctr);
+    std::vector<char>   buffer(workspace_size + QPMAD_WORKSPACE_ALIGNMENT);
+    char *              workspace = &buffer[0]
+                                    + (QPMAD_WORKSPACE_ALIGNMENT
+                                        - reinterpret_cast<std::size_t>(&buffer[0]) % QPMAD_WORKSPACE_ALIGNMENT);
+    qpmad::Solver       workspace_solver;
+    BOOST_REQUIRE(workspace_solver.setWorkspace(workspace, workspace_size));
+
+    x_ref = x;
+    H = H_copy;
+#ifndef QPMAD_ENABLE_TRACING
+    Eigen::internal::set_is_malloc_allowed(false);
+#endif
+    status = workspace_solver.solve(x, H, h, lb, ub, A, Alb, Aub, weights, param);
+    Eigen::internal::set_is_malloc_allowed(true);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, 1e-12));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( primal_method00, SolverIterationCountFixture )
+{
+    qpmad::MatrixIndex size = 30;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    h *= 5.0;
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -1.0);
+    Aub.setConstant(num_ctr, 1.0);
+
+
+    qpmad::SolverParameters     param;
+
+    const int num_iter = solveWithMinimalNumberOfIterations(param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    x_ref = x;
+
+
+    // solution of a similar problem is feasible and its active set is a
+    // good guess
+    Eigen::VectorXd h_ref = h;
+    h += 1e-2 * Eigen::VectorXd::Random(size);
+    param.max_iter_ = -1;
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    const Eigen::VectorXd x_init = x;
+    h = h_ref;
+
+    param.method_ = qpmad::SolverParameters::METHOD_PRIMAL;
+    param.crash_ = true;
+    param.crash_tolerance_ = 1e-9;
+    BOOST_CHECK(solveWithMinimalNumberOfIterations(param, x_init) < num_iter);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+
+
+    // iterates are feasible
+    param.crash_ = false;
+    for (param.max_iter_ = 1; param.max_iter_ < 5; ++param.max_iter_)
+    {
+        H = H_copy;
+        x = x_init;
+        status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+        BOOST_CHECK_EQUAL(status, qpmad::Solver::MAXIMAL_NUMBER_OF_ITERATIONS);
+
+        const Eigen::VectorXd Ax = A * x;
+        BOOST_CHECK((x.array() >= lb.array() - g_default_tolerance).all());
+        BOOST_CHECK((x.array() <= ub.array() + g_default_tolerance).all());
+        BOOST_CHECK((Ax.array() >= Alb.array() - g_default_tolerance).all());
+        BOOST_CHECK((Ax.array() <= Aub.array() + g_default_tolerance).all());
+    }
+
+    param.max_iter_ = -1;
+    H = H_copy;
+    x = x_init;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+
+
+    // the dual method is used if the starting point is infeasible
+    x.setConstant(size, 10.0);
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+}
+
+
+BOOST_FIXTURE_TEST_CASE( certificate00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 30;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    h *= 5.0;
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -1.0);
+    Aub.setConstant(num_ctr, 1.0);
+    // equalities
+    Alb(0) = Aub(0) = 0.1;
+    Alb(1) = Aub(1) = -0.1;
+
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+
+    const double objective = 0.5 * x.transpose() * H_copy * x + h.dot(x);
+    BOOST_CHECK(std::abs(solver.getObjective() - objective) < g_default_tolerance);
+
+
+    Eigen::VectorXd dual;
+    solver.getDual(dual);
+    BOOST_CHECK_EQUAL(dual.rows(), size + num_ctr);
+
+    const Eigen::VectorXd stationarity = H_copy * x + h + dual.head(size) + A.transpose() * dual.tail(num_ctr);
+    BOOST_CHECK(stationarity.norm() < g_default_tolerance);
+
+    const Eigen::VectorXd Ax = A * x;
+    for (qpmad::MatrixIndex i = 0; i < size; ++i)
+    {
+        BOOST_CHECK((dual(i) >= 0.0) || (std::abs(x(i) - lb(i)) < g_default_tolerance));
+        BOOST_CHECK((dual(i) <= 0.0) || (std::abs(x(i) - ub(i)) < g_default_tolerance));
+    }
+    for (qpmad::MatrixIndex i = 2; i < num_ctr; ++i)
+    {
+        BOOST_CHECK((dual(size + i) >= 0.0) || (std::abs(Ax(i) - Alb(i)) < g_default_tolerance));
+        BOOST_CHECK((dual(size + i) <= 0.0) || (std::abs(Ax(i) - Aub(i)) < g_default_tolerance));
+    }
+
+
+    double primal_residual;
+    double dual_residual;
+    solver.computeResiduals(x, h, lb, ub, A, Alb, Aub, primal_residual, dual_residual);
+    BOOST_CHECK(primal_residual < g_default_tolerance);
+    BOOST_CHECK(dual_residual < g_default_tolerance);
+
+    // a perturbed point is detected
+    x(0) += 1.0;
+    solver.computeResiduals(x, h, lb, ub, A, Alb, Aub, primal_residual, dual_residual);
+    BOOST_CHECK(dual_residual > 0.5);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( sensitivity00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 20;
+    qpmad::MatrixIndex num_ctr = 30;
+    qpmad::MatrixIndex num_directions = 3;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    h *= 5.0;
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -1.0);
+    Aub.setConstant(num_ctr, 1.0);
+    // equalities
+    Alb(0) = Aub(0) = 0.1;
+    Alb(1) = Aub(1) = -0.1;
+
+    qpmad::SolverParameters param;
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+
+    Eigen::VectorXd dual;
+    solver.getDual(dual);
+
+
+    Eigen::MatrixXd h_directions = Eigen::MatrixXd::Random(size, num_directions);
+    Eigen::MatrixXd lower_directions = Eigen::MatrixXd::Random(size + num_ctr, num_directions);
+    Eigen::MatrixXd upper_directions = Eigen::MatrixXd::Random(size + num_ctr, num_directions);
+    upper_directions.middleRows(size, 2) = lower_directions.middleRows(size, 2);
+
+    Eigen::MatrixXd primal_sensitivity;
+    Eigen::MatrixXd dual_sensitivity;
+    status = solver.computeSensitivities(   primal_sensitivity, dual_sensitivity,
+                                            H, h_directions, lower_directions, upper_directions, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+
+    // finite differences, the active set is preserved
+    const double step = 1e-6;
+    for (qpmad::MatrixIndex i = 0; i < num_directions; ++i)
+    {
+        qpmad::Solver   fd_solver;
+        Eigen::VectorXd fd_x;
+        Eigen::VectorXd fd_dual;
+
+        H = H_copy;
+        status = fd_solver.solve(   fd_x, H, h + step * h_directions.col(i),
+                                    lb + step * lower_directions.col(i).head(size),
+                                    ub + step * upper_directions.col(i).head(size),
+                                    A,
+                                    Alb + step * lower_directions.col(i).tail(num_ctr),
+                                    Aub + step * upper_directions.col(i).tail(num_ctr),
+                                    param);
+        BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+        fd_solver.getDual(fd_dual);
+
+        BOOST_CHECK(((fd_x - x) / step - primal_sensitivity.col(i)).norm() < 1e-6);
+        BOOST_CHECK(((fd_dual - dual) / step - dual_sensitivity.col(i)).norm() < 1e-5);
+    }
+
+
+    // adjoint sensitivities are consistent with forward sensitivities
+    Eigen::MatrixXd primal_gradients = Eigen::MatrixXd::Random(size, 2);
+    Eigen::MatrixXd h_gradients;
+    Eigen::MatrixXd lower_gradients;
+    Eigen::MatrixXd upper_gradients;
+    status = solver.computeAdjointSensitivities(h_gradients, lower_gradients, upper_gradients,
+                                                H, primal_gradients, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+
+    const Eigen::MatrixXd forward_products = primal_gradients.transpose() * primal_sensitivity;
+    const Eigen::MatrixXd adjoint_products =    h_gradients.transpose() * h_directions
+                                                + lower_gradients.transpose() * lower_directions
+                                                + upper_gradients.transpose() * upper_directions;
+    BOOST_CHECK((forward_products - adjoint_products).norm() < g_default_tolerance);
+
+
+    // no active constraints
+    H = H_copy;
+    status = solver.solve(x, H, h, Eigen::VectorXd(), Eigen::VectorXd(), param);
+    BOOST_REQUIRE_EQUAL(status, qpmad::Solver::OK);
+
+    status = solver.computeSensitivities(   primal_sensitivity, dual_sensitivity,
+                                            H, h_directions, Eigen::MatrixXd(), Eigen::MatrixXd(), param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK((H_copy * primal_sensitivity + h_directions).norm() < g_default_tolerance);
+}
+
+
+BOOST_FIXTURE_TEST_CASE( drift_check00, SolverSimpleBoundsFixture )
+{
+    qpmad::MatrixIndex size = 30;
+    qpmad::MatrixIndex num_ctr = 40;
+
+    getRandomPositiveDefinititeMatrix(H_copy, size);
+    h.setRandom(size);
+    lb.setConstant(size, -0.5);
+    ub.setConstant(size, 0.5);
+    A.setRandom(num_ctr, size);
+    Alb.setConstant(num_ctr, -0.2);
+    Aub.setConstant(num_ctr, 0.2);
+
+
+    qpmad::SolverParameters     param;
+
+    // disabled by default
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK_EQUAL(solver.getStatistics().num_drift_checks_, 0u);
+    x_ref = x;
+
+
+    // the estimate of a fresh factorization is small
+    param.drift_check_period_ = 1;
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(solver.getStatistics().num_drift_checks_ > 0);
+    BOOST_CHECK_EQUAL(solver.getStatistics().num_refactorizations_, 0u);
+    BOOST_CHECK(solver.getStatistics().max_drift_ < 1e-10);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+
+
+    // refactorization on every check does not change the solution
+    solver.resetStatistics();
+    param.drift_tolerance_ = 0.0;
+
+    H = H_copy;
+    status = solver.solve(x, H, h, lb, ub, A, Alb, Aub, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, g_default_tolerance));
+
+    // remove the first row, the factorization is carried over
+    std::vector<qpmad::MatrixIndex> removed(1, 0);
+    A = Eigen::MatrixXd(A.bottomRows(num_ctr - 1));
+    Alb = Eigen::VectorXd(Alb.tail(num_ctr - 1));
+    Aub = Eigen::VectorXd(Aub.tail(num_ctr - 1));
+
+    status = solver.resume(x, H, h, lb, ub, A, Alb, Aub, removed, param);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(solver.getStatistics().num_drift_checks_ > 0);
+    BOOST_CHECK_EQUAL(solver.getStatistics().num_refactorizations_, solver.getStatistics().num_drift_checks_);
+
+    qpmad::Solver reference_solver;
+    H = H_copy;
+    status = reference_solver.solve(x_ref, H, h, lb, ub, A, Alb, Aub);
+    BOOST_CHECK_EQUAL(status, qpmad::Solver::OK);
+    BOOST_CHECK(x.isApprox(x_ref, 1e-9));
+}
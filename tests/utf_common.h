@@ -39,4 +39,4 @@ inline void getRandomPositiveDefinititeMatrix(Eigen::MatrixXd &M, const std::siz
 }
 
 
-BOOST_GLOBAL_FIXTURE( GlobalFixtureConfig )
+BOOST_GLOBAL_FIXTURE( GlobalFixtureConfig );